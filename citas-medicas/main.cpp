@@ -7,6 +7,50 @@
 #include <iomanip>
 #include <queue>
 #include <map> // Para inventario de medicamentos
+#include <deque>
+#include <list>
+#include <tuple>
+#include <set>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <new>
+#include <string_view>
+#include <charconv>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <shared_mutex>
+#include <atomic>
+#include <csignal>
+#include <filesystem>
+#include <cmath>
+#include <limits>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define USAR_SSE2
+#endif
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#endif
 
 using namespace std;
 
@@ -42,1125 +86,10954 @@ struct Cita
     string especialidad;
     int prioridad; // 1 (Alta) a 5 (Baja)
     bool cancelada = false;
+    uint64_t claveOrden = 0; // Clave empaquetada prioridad|fecha|hora|ingesta (ver seccion 3B)
 };
 
-// --- 2. DATOS GLOBALES Y HASHING ---
+const int PRIORIDAD_MAS_ALTA = 1;
+const int PRIORIDAD_MAS_BAJA = 5;
 
-// Tablas Hash (unordered_map) para búsqueda O(1) promedio
-unordered_map<string, Paciente> tablaPacientes; // Clave: DNI
-unordered_map<string, Medico> tablaMedicos;     // Clave: nombreCompleto
+// Las entradas (menu, replay, CSV, journal) rechazan prioridades fuera de 1..5
+inline bool prioridadValida(int prioridad)
+{
+    return prioridad >= PRIORIDAD_MAS_ALTA && prioridad <= PRIORIDAD_MAS_BAJA;
+}
 
-// Vectores para la gestión de citas y lista de espera
-vector<Cita> citasProgramadas;
-vector<Cita> listaEspera;
+// --- 1B. TABLA PLANA DE PACIENTES POR DNI (DIRECCIONAMIENTO ABIERTO) ---
 
-// Tipo de alias para el comparador de ordenamiento
-using CitaComparator = function<bool(const Cita&, const Cita&)>;
+inline int contarCerosFinales(uint64_t x) // x != 0
+{
+#ifdef _MSC_VER
+    unsigned long idx;
+    _BitScanForward64(&idx, x);
+    return static_cast<int>(idx);
+#else
+    return __builtin_ctzll(x);
+#endif
+}
 
-// Comparador Global: Prioridad (menor es más urgente) > Fecha > Hora (RF01.1)
-CitaComparator globalComparator = [](const Cita& a, const Cita& b)
+inline int contarBits(uint64_t x)
+{
+#ifdef _MSC_VER
+    return static_cast<int>(__popcnt64(x));
+#else
+    return __builtin_popcountll(x);
+#endif
+}
+
+/**
+ * Indice de pacientes por DNI al estilo SwissTable:
+ *  - el DNI se convierte a un entero (biyectivo para 1 a 9 digitos, asi "0123"
+ *    y "123" son distintos) y se hashea ese entero, no el string;
+ *  - los slots van en grupos de 16: 16 bytes de control con 7 bits del hash y
+ *    16 posiciones de 4 bytes, contiguos (80 bytes). Los controles se comparan
+ *    de a 16 con SSE2, asi una busqueda toca un grupo y el paciente encontrado;
+ *  - los pacientes viven en un vector denso, en orden de alta.
+ * Los DNI no numericos (documentos extranjeros) usan el hash del string.
+ */
+class TablaPacientes
+{
+private:
+    static constexpr int8_t CONTROL_VACIO = -128; // los slots ocupados guardan 0..127
+    static constexpr size_t TAM_GRUPO = 16;
+
+    struct Grupo
     {
-        if (a.prioridad != b.prioridad)
+        int8_t control[TAM_GRUPO];
+        uint32_t posicion[TAM_GRUPO];
+    };
+
+    vector<Paciente> pacientes;
+    vector<Grupo> grupos;
+    size_t mascaraGrupos = 0;
+    int idMaximo = 0;
+
+    // Entero unico para un DNI de 1 a 9 digitos: las claves de longitud L empiezan en (10^L - 10) / 9
+    static bool claveNumerica(string_view dni, uint32_t& clave)
+    {
+        if (dni.empty() || dni.size() > 9)
+            return false;
+        uint32_t valor = 0, base = 1;
+        for (char ch : dni)
         {
-            return a.prioridad < b.prioridad;
+            if (ch < '0' || ch > '9')
+                return false;
+            valor = valor * 10 + static_cast<uint32_t>(ch - '0');
+            base *= 10;
         }
-        if (a.fecha != b.fecha)
+        clave = valor + (base - 10) / 9;
+        return true;
+    }
+
+    static uint64_t hashDni(string_view dni)
+    {
+        uint32_t clave;
+        if (!claveNumerica(dni, clave))
+            return hash<string_view>()(dni) * 0x9E3779B97F4A7C15ULL;
+        uint64_t h = clave * 0x9E3779B97F4A7C15ULL;
+        return h ^ (h >> 29);
+    }
+
+    // Bits (uno por byte del grupo) de los controles iguales a 'valor'
+    static uint32_t coincidencias(const int8_t* control, int8_t valor)
+    {
+#ifdef USAR_SSE2
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(control));
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(valor))));
+#else
+        uint32_t mascara = 0;
+        for (size_t i = 0; i < TAM_GRUPO; ++i)
+            mascara |= static_cast<uint32_t>(control[i] == valor) << i;
+        return mascara;
+#endif
+    }
+
+    long long buscarPosicion(string_view dni) const
+    {
+        if (grupos.empty())
+            return -1;
+        uint64_t h = hashDni(dni);
+        int8_t h2 = static_cast<int8_t>(h & 0x7F);
+        size_t g = (h >> 7) & mascaraGrupos;
+        for (size_t paso = 1;; ++paso)
         {
-            return a.fecha < b.fecha;
+            const Grupo& grupo = grupos[g];
+            for (uint32_t m = coincidencias(grupo.control, h2); m != 0; m &= m - 1)
+            {
+                uint32_t pos = grupo.posicion[contarCerosFinales(m)];
+                if (pacientes[pos].dni == dni)
+                    return pos;
+            }
+            if (coincidencias(grupo.control, CONTROL_VACIO) != 0)
+                return -1;
+            g = (g + paso) & mascaraGrupos; // sondeo triangular: recorre todos los grupos
         }
-        return a.hora < b.hora;
-    };
-
-// --- 3. ALGORITMOS DE ORDENAMIENTO (Quick Sort y Merge Sort) ---
+    }
 
-// Implementación de Partición (Necesaria para Quick Sort)
-int particion(vector<Cita>& arr, int low, int high, const CitaComparator& comp)
-{
-    Cita pivot = arr[high];
-    int i = (low - 1);
-    for (int j = low; j <= high - 1; j++)
+    // Ubica un DNI que se sabe ausente; hay capacidad garantizada
+    void ubicar(string_view dni, uint32_t posicion)
     {
-        if (comp(arr[j], pivot))
+        uint64_t h = hashDni(dni);
+        size_t g = (h >> 7) & mascaraGrupos;
+        for (size_t paso = 1;; ++paso)
         {
-            i++;
-            swap(arr[i], arr[j]);
+            Grupo& grupo = grupos[g];
+            uint32_t libres = coincidencias(grupo.control, CONTROL_VACIO);
+            if (libres != 0)
+            {
+                int i = contarCerosFinales(libres);
+                grupo.control[i] = static_cast<int8_t>(h & 0x7F);
+                grupo.posicion[i] = posicion;
+                return;
+            }
+            g = (g + paso) & mascaraGrupos;
         }
     }
-    swap(arr[i + 1], arr[high]);
-    return (i + 1);
-}
 
-/**
- * Quick Sort: Ordenamiento rápido, útil para ordenar citas por fecha o prioridad.
- * Complejidad: O(n log n) promedio.
- */
-void quickSort(vector<Cita>& arr, int low, int high, const CitaComparator& comp)
-{
-    if (low < high)
+    // Rehash a la menor potencia de 2 de grupos que mantiene la carga <= 7/8
+    void redimensionar(size_t elementos)
+    {
+        size_t numGrupos = 1;
+        while (numGrupos * TAM_GRUPO * 7 / 8 < elementos)
+            numGrupos *= 2;
+        if (numGrupos == grupos.size())
+            return;
+        Grupo vacio;
+        memset(vacio.control, CONTROL_VACIO, sizeof(vacio.control));
+        memset(vacio.posicion, 0, sizeof(vacio.posicion));
+        grupos.assign(numGrupos, vacio);
+        mascaraGrupos = numGrupos - 1;
+        for (uint32_t i = 0; i < pacientes.size(); ++i)
+            ubicar(pacientes[i].dni, i);
+    }
+
+public:
+    Paciente* buscar(string_view dni)
     {
-        int pi = particion(arr, low, high, comp);
-        quickSort(arr, low, pi - 1, comp);
-        quickSort(arr, pi + 1, high, comp);
+        long long pos = buscarPosicion(dni);
+        return pos < 0 ? nullptr : &pacientes[static_cast<size_t>(pos)];
     }
-}
 
-// Implementación de Merge (Necesaria para Merge Sort)
-void merge(vector<Cita>& arr, int l, int m, int r, const CitaComparator& comp)
-{
-    int n1 = m - l + 1;
-    int n2 = r - m;
+    const Paciente* buscar(string_view dni) const
+    {
+        long long pos = buscarPosicion(dni);
+        return pos < 0 ? nullptr : &pacientes[static_cast<size_t>(pos)];
+    }
 
-    vector<Cita> L(n1), R(n2);
-    for (int i = 0; i < n1; i++)
-        L[i] = arr[l + i];
-    for (int j = 0; j < n2; j++)
-        R[j] = arr[m + 1 + j];
+    // Agrega el paciente; si el DNI ya existe no lo modifica y devuelve false
+    bool insertar(Paciente p)
+    {
+        if (buscarPosicion(p.dni) >= 0)
+            return false;
+        if (pacientes.size() + 1 > grupos.size() * TAM_GRUPO * 7 / 8)
+            redimensionar(max<size_t>(pacientes.size() * 2, 64));
+        uint32_t posicion = static_cast<uint32_t>(pacientes.size());
+        idMaximo = max(idMaximo, p.idPaciente);
+        pacientes.push_back(std::move(p));
+        ubicar(pacientes.back().dni, posicion);
+        return true;
+    }
 
-    int i = 0, j = 0, k = l;
-    while (i < n1 && j < n2)
+    // Alta o reemplazo de los datos del paciente
+    void asignar(const Paciente& p)
     {
-        // Mantiene la estabilidad: si son iguales, se toma primero de L
-        if (comp(L[i], R[j]) || (!comp(R[j], L[i]) && !comp(L[i], R[j])))
+        if (Paciente* existente = buscar(p.dni))
         {
-            arr[k] = L[i];
-            i++;
+            *existente = p;
+            idMaximo = max(idMaximo, p.idPaciente);
         }
         else
+            insertar(p);
+    }
+
+    void reservar(size_t n)
+    {
+        pacientes.reserve(n);
+        if (n > grupos.size() * TAM_GRUPO * 7 / 8)
+            redimensionar(n);
+    }
+
+    /**
+     * Carga masiva en paralelo sobre la tabla vaciada. Los grupos se reparten en
+     * tramos contiguos y cada hilo ubica, en el orden del archivo, las filas cuyo
+     * grupo inicial cae en sus tramos, con el mismo sondeo que insertar(). Si el
+     * sondeo sale del tramo la fila se difiere y se ubica al final en un solo
+     * hilo. Los grupos solo se llenan, asi que lo que un hilo vio lleno sigue
+     * lleno y una busqueda recorre el mismo camino. Un DNI repetido tiene el
+     * mismo hash y cae en el mismo tramo: se detecta en ese recorrido y se
+     * conserva la primera fila. Devuelve cuantas filas repetidas se descartaron.
+     */
+    size_t cargarEnParalelo(vector<Paciente>& filas, int hilos)
+    {
+        limpiar();
+        const size_t n = filas.size();
+        if (n == 0)
+            return 0;
+        redimensionar(n);
+        hilos = max(1, hilos);
+
+        // Las posiciones guardadas son indices de 'filas' hasta compactar
+        auto ejecutar = [hilos](size_t tareas, const function<void(size_t)>& tarea)
+        {
+            atomic<size_t> siguiente(0);
+            auto trabajar = [&]()
+            {
+                for (size_t t = siguiente++; t < tareas; t = siguiente++)
+                    tarea(t);
+            };
+            vector<thread> trabajadores;
+            for (int h = 1; h < hilos; ++h)
+                trabajadores.emplace_back(trabajar);
+            trabajar();
+            for (thread& t : trabajadores)
+                t.join();
+        };
+
+        const size_t TAM_LOTE = 1 << 16;
+        vector<uint64_t> hashes(n);
+        ejecutar((n + TAM_LOTE - 1) / TAM_LOTE, [&](size_t lote)
+                 {
+                     for (size_t i = lote * TAM_LOTE; i < min(n, (lote + 1) * TAM_LOTE); ++i)
+                         hashes[i] = hashDni(filas[i].dni);
+                 });
+
+        const size_t tramos = min(grupos.size(), static_cast<size_t>(hilos) * 8);
+        const size_t gruposPorTramo = (grupos.size() + tramos - 1) / tramos;
+        vector<size_t> inicioTramo(tramos + 1, 0);
+        for (size_t i = 0; i < n; ++i)
+            inicioTramo[((hashes[i] >> 7) & mascaraGrupos) / gruposPorTramo + 1]++;
+        for (size_t t = 0; t < tramos; ++t)
+            inicioTramo[t + 1] += inicioTramo[t];
+        vector<uint32_t> filasPorTramo(n);
+        {
+            vector<size_t> cursor(inicioTramo.begin(), inicioTramo.end() - 1);
+            for (size_t i = 0; i < n; ++i)
+                filasPorTramo[cursor[((hashes[i] >> 7) & mascaraGrupos) / gruposPorTramo]++] = static_cast<uint32_t>(i);
+        }
+
+        vector<char> repetida(n, 0);
+        // Sigue el sondeo de la fila i; false si sale de [desde, hasta) antes de ubicarla
+        auto ubicarFila = [&](uint32_t i, size_t desde, size_t hasta)
+        {
+            int8_t h2 = static_cast<int8_t>(hashes[i] & 0x7F);
+            size_t g = (hashes[i] >> 7) & mascaraGrupos;
+            for (size_t paso = 1;; ++paso)
+            {
+                if (g < desde || g >= hasta)
+                    return false;
+                Grupo& grupo = grupos[g];
+                for (uint32_t m = coincidencias(grupo.control, h2); m != 0; m &= m - 1)
+                {
+                    if (filas[grupo.posicion[contarCerosFinales(m)]].dni == filas[i].dni)
+                    {
+                        repetida[i] = 1;
+                        return true;
+                    }
+                }
+                uint32_t libres = coincidencias(grupo.control, CONTROL_VACIO);
+                if (libres != 0)
+                {
+                    int k = contarCerosFinales(libres);
+                    grupo.control[k] = h2;
+                    grupo.posicion[k] = i;
+                    return true;
+                }
+                g = (g + paso) & mascaraGrupos;
+            }
+        };
+        vector<vector<uint32_t>> diferidas(tramos);
+        ejecutar(tramos, [&](size_t t)
+                 {
+                     size_t desde = t * gruposPorTramo, hasta = min(grupos.size(), desde + gruposPorTramo);
+                     for (size_t k = inicioTramo[t]; k < inicioTramo[t + 1]; ++k)
+                         if (!ubicarFila(filasPorTramo[k], desde, hasta))
+                             diferidas[t].push_back(filasPorTramo[k]);
+                 });
+        for (const auto& lista : diferidas)
+            for (uint32_t i : lista)
+                ubicarFila(i, 0, grupos.size());
+
+        // Compacta: las filas repetidas se descartan y las posiciones pasan a ser densas
+        vector<uint32_t> nuevaPosicion(n);
+        size_t repetidas = 0;
+        pacientes.reserve(n);
+        for (size_t i = 0; i < n; ++i)
         {
-            arr[k] = R[j];
-            j++;
+            if (repetida[i])
+            {
+                repetidas++;
+                continue;
+            }
+            nuevaPosicion[i] = static_cast<uint32_t>(pacientes.size());
+            idMaximo = max(idMaximo, filas[i].idPaciente);
+            pacientes.push_back(std::move(filas[i]));
         }
-        k++;
+        if (repetidas > 0)
+            ejecutar(tramos, [&](size_t t)
+                     {
+                         for (size_t g = t * gruposPorTramo; g < min(grupos.size(), (t + 1) * gruposPorTramo); ++g)
+                             for (size_t k = 0; k < TAM_GRUPO; ++k)
+                                 if (grupos[g].control[k] != CONTROL_VACIO)
+                                     grupos[g].posicion[k] = nuevaPosicion[grupos[g].posicion[k]];
+                     });
+        return repetidas;
     }
-    while (i < n1)
-        arr[k++] = L[i++];
-    while (j < n2)
-        arr[k++] = R[j++];
-}
 
-/**
- * Merge Sort: Ordenamiento estable, ideal para consolidar citas de múltiples clínicas.
+    void limpiar()
+    {
+        pacientes.clear();
+        grupos.clear();
+        mascaraGrupos = 0;
+        idMaximo = 0;
+    }
+
+    size_t size() const
+    {
+        return pacientes.size();
+    }
+
+    // Las posiciones son estables: los pacientes solo se agregan al final
+    const Paciente& enPosicion(uint32_t posicion) const
+    {
+        return pacientes[posicion];
+    }
+
+    int siguienteId() const
+    {
+        return idMaximo + 1;
+    }
+
+    vector<Paciente>::const_iterator begin() const
+    {
+        return pacientes.begin();
+    }
+
+    vector<Paciente>::const_iterator end() const
+    {
+        return pacientes.end();
+    }
+
+    // Memoria del indice y del vector de pacientes (sin el heap de los strings)
+    size_t bytesUsados() const
+    {
+        return pacientes.capacity() * sizeof(Paciente) + grupos.capacity() * sizeof(Grupo);
+    }
+};
+
+// --- 2. DATOS GLOBALES Y HASHING ---
+
+// Tablas Hash (unordered_map) para búsqueda O(1) promedio
+TablaPacientes tablaPacientes;                  // Clave: DNI (tabla plana, seccion 1B)
+unordered_map<string, Medico> tablaMedicos;     // Clave: nombreCompleto
+
+// Vector para la gestión de citas (la lista de espera indexada se define en la seccion 3D)
+vector<Cita> citasProgramadas;
+
+/*
+ * Salida de las operaciones del menu. Es cout salvo en el hilo que la desvia:
+ * el servidor apunta la de cada pedido a su respuesta sin tocar el cout global,
+ * que siguen usando los demas hilos (el escritor del journal, por ejemplo).
  */
-void mergeSort(vector<Cita>& arr, int l, int r, const CitaComparator& comp)
+thread_local ostream* salidaDelHilo = &cout;
+
+inline ostream& consola()
 {
-    if (l >= r)
-        return;
-    int m = l + (r - l) / 2;
-    mergeSort(arr, l, m, comp);
-    mergeSort(arr, m + 1, r, comp);
-    merge(arr, l, m, r, comp);
+    return *salidaDelHilo;
 }
 
-// --- 4. FUNCIONES DEL MÓDULO (Siguiendo el Diagrama de Flujo) ---
-
-/**
- * Cargar citas del día y cargar información de pacientes y medicos (Inicio)
- */
-void cargarDatos()
+class DesvioSalida
 {
-    // Simulación de carga de pacientes (Hashing)
-    tablaPacientes["23127181"] = { 101, "23127181", "Carlos Quispe" };
-    tablaPacientes["21200622"] = { 102, "21200622", "Moises Sacsara" };
+private:
+    ostream* anterior;
 
-    // Simulación de carga de médicos (Hashing)
-    tablaMedicos["Dioses Zarate"] = { 501, "Dioses Zarate", "Cardiología", true };
-    tablaMedicos["Terrel Santos"] = { 502, "Terrel Santos", "Pediatría", true };
+public:
+    explicit DesvioSalida(ostream& destino) : anterior(salidaDelHilo) { salidaDelHilo = &destino; }
+    ~DesvioSalida() { salidaDelHilo = anterior; }
+    DesvioSalida(const DesvioSalida&) = delete;
+    DesvioSalida& operator=(const DesvioSalida&) = delete;
+};
 
-    // Simulación de carga de citas
-    citasProgramadas = {
-        {1, 101, 501, "23127181", "Dioses Zarate", "2025-12-01", "10:00", "Cardiología", 2},
-        {2, 102, 502, "21200622", "Terrel Santos", "2025-12-01", "09:00", "Pediatría", 1},
-        {3, 101, 501, "23127181", "Dioses Zarate", "2025-12-02", "08:00", "Cardiología", 3} };
-    listaEspera = {
-        {4, 999, 0, "33445566", "N/A", "N/A", "N/A", "Medicina General", 1} // Prioridad Alta (1)
-    };
-    cout << "\n[INFO] Datos iniciales cargados." << endl;
-}
+// --- 2B. INDICES SECUNDARIOS SOBRE LA AGENDA ---
 
-/**
- * Lógica de Ordenamiento y Fusión (¿Citas provienen de una sola área?)
- */
-void iniciarProcesamiento(bool multiplesAreas)
+// Ids de cita aceptados al ingresar (CSV, menu, replay): 0..MAX_ID_CITA
+const int MAX_ID_CITA = 1000000000;
+
+inline bool idCitaValido(int idCita)
 {
-    cout << "\n--- INICIO DEL PROCESAMIENTO DE CITAS ---" << endl;
-    if (multiplesAreas)
-    { // Diagrama: No -> Fusionar todas las listas de citas
-        cout << "[MERGE SORT] Consolidando y ordenando citas de multiples areas (estable)..." << endl;
-        // Se ejecuta Merge Sort para consolidación estable
-        mergeSort(citasProgramadas, 0, citasProgramadas.size() - 1, globalComparator);
-    }
-    else
-    { // Diagrama: Sí -> Ordenar citas
-        cout << "[QUICK SORT] Ordenando citas del dia por prioridad y hora (rapido)..." << endl;
-        // Se ejecuta Quick Sort para ordenamiento rápido
-        quickSort(citasProgramadas, 0, citasProgramadas.size() - 1, globalComparator);
-    }
-    cout << "[INFO] Citas procesadas correctamente." << endl;
+    return idCita >= 0 && idCita <= MAX_ID_CITA;
 }
 
 /**
- * Buscar paciente (Diagrama: Buscar paciente -> Mostrar datos de paciente)
- * Usa Hashing O(1) promedio.
+ * Indices mantenidos de forma incremental sobre citasProgramadas:
+ *  - idCita -> posicion en el vector (arreglo denso, O(1)). El arreglo crece
+ *    hasta ~4 veces el numero de citas; los ids sueltos por encima de eso van
+ *    a un mapa, asi un id enorme no reserva memoria por si solo.
+ *  - idMedico, fecha y DNI -> ids de sus citas. Guardan ids y no posiciones,
+ *    asi que reordenar la agenda solo obliga a recalcular el arreglo denso.
+ * Las citas canceladas siguen indexadas (siguen en la agenda); las consultas
+ * filtran por estado si lo necesitan.
  */
-void buscarPacientePorDNI()
+class IndiceCitas
 {
-    string dni;
-    cout << "\n[BUSCAR PACIENTE] Ingrese DNI: ";
-    cin >> dni;
-
-    auto it = tablaPacientes.find(dni); // Búsqueda O(1)
-    if (it != tablaPacientes.end())
+private:
+    vector<int> posicionPorId;              // -1 si el id no existe
+    unordered_map<int, int> posicionDispersa; // ids por encima del arreglo denso
+    size_t indexadas = 0;
+    unordered_map<int, vector<int>> idsPorMedico;
+    map<string, vector<int>> idsPorFecha; // ordenado: permite recorrer dias consecutivos
+    unordered_map<string, vector<int>> idsPorDni;
+
+    static void quitarId(vector<int>& ids, int idCita)
     {
-        cout << "  > ENCONTRADO: " << it->second.nombreCompleto << endl;
-        cout << "  > DNI: " << it->second.dni << ", ID: " << it->second.idPaciente << endl;
+        auto it = find(ids.begin(), ids.end(), idCita);
+        if (it != ids.end())
+        {
+            *it = ids.back();
+            ids.pop_back();
+        }
     }
-    else
+
+    template <typename Mapa, typename Clave>
+    static void quitarDeMapa(Mapa& mapa, const Clave& clave, int idCita)
     {
-        cout << "  > ERROR: Paciente con DNI " << dni << " no encontrado." << endl;
+        auto it = mapa.find(clave);
+        if (it == mapa.end())
+            return;
+        quitarId(it->second, idCita);
+        if (it->second.empty())
+            mapa.erase(it);
     }
-}
-
-/**
- * Modificar disponibilidad (Diagrama: Modificar disponibilidad -> Actualizar estado del médico)
- * Usa Hashing O(1) promedio.
- */
-void modificarDisponibilidadMedico()
-{
-    string nombreMedico;
-    int estado;
-    cout << "\n[MODIFICAR DISPONIBILIDAD] Ingrese nombre del Medico: ";
-    cin.ignore();
-    getline(cin, nombreMedico);
-    cout << "  > Ingrese nuevo estado (1: DISPONIBLE, 0: NO DISPONIBLE): ";
-    cin >> estado;
 
-    auto it = tablaMedicos.find(nombreMedico); // Búsqueda O(1)
+    size_t limiteDenso() const
+    {
+        return max<size_t>(4 * indexadas, 1024);
+    }
 
-    if (it != tablaMedicos.end())
+    // Crece el arreglo denso y trae del mapa los ids que ahora caben en el
+    void crecerDenso(size_t tam)
     {
-        it->second.disponible = (estado == 1);
-        cout << "  > EXITO: Disponibilidad de " << nombreMedico
-            << " actualizada a " << (it->second.disponible ? "DISPONIBLE" : "NO DISPONIBLE") << "." << endl;
+        posicionPorId.resize(tam, -1);
+        for (auto it = posicionDispersa.begin(); it != posicionDispersa.end();)
+        {
+            if (static_cast<size_t>(it->first) < tam)
+            {
+                posicionPorId[it->first] = it->second;
+                it = posicionDispersa.erase(it);
+            }
+            else
+                ++it;
+        }
     }
-    else
+
+    void fijarPosicion(int idCita, int posicion)
     {
-        cout << "  > ERROR: Medico " << nombreMedico << " no encontrado." << endl;
+        if (idCita < 0)
+            return;
+        size_t id = static_cast<size_t>(idCita);
+        if (id >= posicionPorId.size())
+        {
+            if (id >= limiteDenso())
+            {
+                posicionDispersa[idCita] = posicion;
+                return;
+            }
+            crecerDenso(min(max(id + 1, posicionPorId.size() * 2), limiteDenso()));
+        }
+        posicionPorId[id] = posicion;
     }
-}
 
-/**
- * Cancelar cita (Diagrama: Cancelar cita -> Actualizar agenda -> Mostrar cita como cancelada)
- * Incluye Reasignación Automática.
- */
-void cancelarCita()
-{
-    int idCita;
-    cout << "\n[CANCELAR CITA] Ingrese ID de la cita a cancelar: ";
-    if (!(cin >> idCita))
-        return;
+public:
+    void limpiar()
+    {
+        posicionPorId.clear();
+        posicionDispersa.clear();
+        indexadas = 0;
+        idsPorMedico.clear();
+        idsPorFecha.clear();
+        idsPorDni.clear();
+    }
 
-    Cita* citaCancelada = nullptr;
-    // 1. Actualizar agenda/Mostrar cita como cancelada
-    for (Cita& cita : citasProgramadas)
+    // Reconstruye todos los indices desde cero: O(n)
+    void reconstruir(const vector<Cita>& citas)
     {
-        if (cita.idCita == idCita && !cita.cancelada)
+        limpiar();
+        int maxId = -1;
+        for (const Cita& c : citas)
         {
-            cita.cancelada = true;
-            citaCancelada = &cita;
-            cout << "  > EXITO: Cita #" << idCita << " marcada como cancelada." << endl;
-            break;
+            maxId = max(maxId, c.idCita);
+            indexadas += c.idCita >= 0;
+        }
+        posicionPorId.assign(min(static_cast<size_t>(maxId + 1), limiteDenso()), -1);
+        idsPorDni.reserve(citas.size() / 4); // carga masiva: evita rehashes sucesivos
+
+        // Las agendas suelen venir agrupadas por dia: se reutiliza la lista de la fecha anterior
+        const string* fechaAnterior = nullptr;
+        vector<int>* idsFechaAnterior = nullptr;
+        for (size_t i = 0; i < citas.size(); ++i)
+        {
+            const Cita& c = citas[i];
+            if (c.idCita < 0)
+                continue;
+            fijarPosicion(c.idCita, static_cast<int>(i));
+            idsPorMedico[c.idMedico].push_back(c.idCita);
+            if (!fechaAnterior || *fechaAnterior != c.fecha)
+            {
+                fechaAnterior = &c.fecha;
+                idsFechaAnterior = &idsPorFecha[c.fecha];
+            }
+            idsFechaAnterior->push_back(c.idCita);
+            idsPorDni[c.dniPaciente].push_back(c.idCita);
         }
     }
 
-    if (citaCancelada && !listaEspera.empty())
+    // Tras reordenar la agenda solo cambian las posiciones: O(n) sin tocar los indices secundarios
+    void actualizarPosiciones(const vector<Cita>& citas)
     {
-        // 2. Reasignación automática: Usamos Quick Sort para asegurar la máxima prioridad
-        quickSort(listaEspera, 0, listaEspera.size() - 1, globalComparator);
+        for (size_t i = 0; i < citas.size(); ++i)
+            fijarPosicion(citas[i].idCita, static_cast<int>(i));
+    }
 
-        Cita pacientePrioritario = listaEspera[0];
+    void insertar(const Cita& c, int posicion)
+    {
+        if (c.idCita < 0)
+            return;
+        indexadas++;
+        fijarPosicion(c.idCita, posicion);
+        idsPorMedico[c.idMedico].push_back(c.idCita);
+        idsPorFecha[c.fecha].push_back(c.idCita);
+        idsPorDni[c.dniPaciente].push_back(c.idCita);
+    }
 
-        // 3. Asignar el slot liberado al paciente prioritario
-        citaCancelada->idPaciente = pacientePrioritario.idPaciente;
-        citaCancelada->dniPaciente = pacientePrioritario.dniPaciente;
-        citaCancelada->cancelada = false; // La cita está nuevamente activa
+    // Reasignacion: el slot cambia de paciente, medico y fecha se mantienen
+    void cambiarPaciente(int idCita, const string& dniAnterior, const string& dniNuevo)
+    {
+        if (dniAnterior == dniNuevo)
+            return;
+        quitarDeMapa(idsPorDni, dniAnterior, idCita);
+        idsPorDni[dniNuevo].push_back(idCita);
+    }
 
-        // 4. Eliminar de lista de espera
-        listaEspera.erase(listaEspera.begin());
+    int buscarPosicion(int idCita) const
+    {
+        if (idCita < 0)
+            return -1;
+        if (static_cast<size_t>(idCita) < posicionPorId.size())
+            return posicionPorId[idCita];
+        auto it = posicionDispersa.find(idCita);
+        return it == posicionDispersa.end() ? -1 : it->second;
+    }
 
-        cout << "  > REASIGNACIÓN: Cita reasignada a paciente prioritario (DNI: "
-            << citaCancelada->dniPaciente << ") en el slot liberado." << endl;
+    const vector<int>& idsDeMedico(int idMedico) const
+    {
+        static const vector<int> vacio;
+        auto it = idsPorMedico.find(idMedico);
+        return it == idsPorMedico.end() ? vacio : it->second;
     }
-    else if (citaCancelada)
+
+    const vector<int>& idsEnFecha(const string& fecha) const
     {
-        cout << "  > INFO: No hay pacientes en lista de espera para reasignar el slot." << endl;
+        static const vector<int> vacio;
+        auto it = idsPorFecha.find(fecha);
+        return it == idsPorFecha.end() ? vacio : it->second;
     }
-    else
+
+    const vector<int>& idsDePaciente(const string& dni) const
     {
-        cout << "  > ERROR: Cita #" << idCita << " no encontrada o ya estaba cancelada." << endl;
+        static const vector<int> vacio;
+        auto it = idsPorDni.find(dni);
+        return it == idsPorDni.end() ? vacio : it->second;
     }
-}
+};
 
-// --- 4B. OPTIMIZACIÓN DE RUTA DE AMBULANCIA (GRAFO + BFS) ---
+IndiceCitas indiceCitas;
 
-struct AristaAmbulancia
+// Debe llamarse despues de cualquier reordenamiento de citasProgramadas
+void sincronizarIndiceCitas()
 {
-    int u;     // nodo origen
-    int v;     // nodo destino
-    int peso;  // tiempo estimado (minutos). Puede ser negativo como penalización.
-};
-
-int numNodosAmbulancia = 0;
-vector<AristaAmbulancia> aristasAmbulancia;
+    indiceCitas.actualizarPosiciones(citasProgramadas);
+}
 
-// Modelo simple de ambulancias y emergencias
-struct Ambulancia
+/*
+ * Indice temporal de la agenda: cada cita se ubica por su instante (minutos
+ * desde 1970-01-01 00:00, calculado en la seccion 3B) en una secuencia de
+ * bloques ordenados de hasta 2*TAM_BLOQUE entradas. Las "cercas" (primera
+ * entrada de cada bloque) viven en un arreglo contiguo: una busqueda binaria
+ * sobre ellas y otra dentro del bloque ubican el inicio de un rango en
+ * O(log n) y el recorrido sigue en orden, bloque a bloque, por O(k).
+ * Hay una secuencia para toda la agenda y una por medico y por especialidad,
+ * asi los filtros tambien cuestan O(log n + k). Las citas no se borran (la
+ * cancelacion es un estado); el recorrido filtra las canceladas.
+ */
+struct EntradaTemporal
 {
-    int idAmbulancia;
-    int nodoActual;
-    bool disponible;
+    uint32_t instante; // minutos desde 1970-01-01 00:00
+    int32_t idCita;
+
+    bool operator<(const EntradaTemporal& o) const
+    {
+        return instante != o.instante ? instante < o.instante : idCita < o.idCita;
+    }
 };
 
-struct EmergenciaRuta
+class SecuenciaTemporal
 {
-    int idEmergencia;
-    int nodoDestino;
-    bool atendida;
-    int idAmbulanciaAsignada;
-    vector<int> ruta;
-    int tiempoEstimado; // en minutos
-};
-
-vector<Ambulancia> ambulancias;
-vector<EmergenciaRuta> emergencias;
-int contadorEmergencias = 1;
-
-const int INF_TIEMPO = 1000000000;
-
-// Inicializa grafo urbano ponderado y ambulancias de ejemplo
-void cargarGrafoAmbulancia()
-{
-    // Modelo urbano simple de 6 nodos
-    // 0: Hospital Central
-    // 1: Cruce Norte
-    // 2: Cruce Sur
-    // 3: Avenida Rapida
-    // 4: Zona Residencial
-    // 5: Zona Industrial
-    numNodosAmbulancia = 6;
-
-    aristasAmbulancia.clear();
+private:
+    static constexpr size_t TAM_BLOQUE = 512;
+    vector<vector<EntradaTemporal>> bloques;
+    vector<EntradaTemporal> cercas;
+    size_t total = 0;
 
-    auto addEdge = [](int u, int v, int peso)
+    // Bloque donde esta (o iria) la entrada
+    size_t bloqueDe(const EntradaTemporal& e) const
     {
-        aristasAmbulancia.push_back({u, v, peso});
-        aristasAmbulancia.push_back({v, u, peso}); // grafo no dirigido: se agrega en ambos sentidos
-    };
-
-    addEdge(0, 1, 5);   // Hospital -> Cruce Norte (5 min)
-    addEdge(0, 2, 7);   // Hospital -> Cruce Sur (7 min)
-    addEdge(1, 3, 3);   // Cruce Norte -> Av. Rapida (3 min)
-    addEdge(2, 3, 2);   // Cruce Sur -> Av. Rapida (2 min)
-    addEdge(3, 4, 6);   // Av. Rapida -> Zona Residencial (6 min)
-    addEdge(3, 5, 4);   // Av. Rapida -> Zona Industrial (4 min)
-    addEdge(4, 5, 5);   // Residencial <-> Industrial
-
-    // Ambulancias disponibles en diferentes nodos de la ciudad
-    ambulancias.clear();
-    ambulancias.push_back({1, 0, true}); // Ambulancia 1 en Hospital Central
-    ambulancias.push_back({2, 1, true}); // Ambulancia 2 en Cruce Norte
-    ambulancias.push_back({3, 5, true}); // Ambulancia 3 en Zona Industrial
-
-    cout << "\n[INFO] Grafo urbano ponderado de ambulancias cargado." << endl;
-}
-
-// Bellman-Ford: calcula distancias minimas desde un origen a todos los nodos
-bool bellmanFord(int origen, vector<int>& dist, vector<int>& padre)
-{
-    dist.assign(numNodosAmbulancia, INF_TIEMPO);
-    padre.assign(numNodosAmbulancia, -1);
-    dist[origen] = 0;
+        size_t b = static_cast<size_t>(upper_bound(cercas.begin(), cercas.end(), e) - cercas.begin());
+        return b == 0 ? 0 : b - 1;
+    }
 
-    // Relajaciones
-    for (int i = 0; i < numNodosAmbulancia - 1; ++i)
+public:
+    void limpiar()
     {
-        bool cambio = false;
-        for (const auto& e : aristasAmbulancia)
-        {
-            if (dist[e.u] == INF_TIEMPO)
-                continue;
-            if (dist[e.u] + e.peso < dist[e.v])
-            {
-                dist[e.v] = dist[e.u] + e.peso;
-                padre[e.v] = e.u;
-                cambio = true;
-            }
-        }
-        if (!cambio)
-            break;
+        bloques.clear();
+        cercas.clear();
+        total = 0;
     }
 
-    // Detección simple de ciclos negativos (no deberian existir en este modelo)
-    for (const auto& e : aristasAmbulancia)
+    // Carga masiva desde entradas ya ordenadas; los bloques quedan a la mitad para absorber inserciones
+    void cargarOrdenadas(const EntradaTemporal* entradas, size_t n)
     {
-        if (dist[e.u] == INF_TIEMPO)
-            continue;
-        if (dist[e.u] + e.peso < dist[e.v])
+        limpiar();
+        for (size_t i = 0; i < n; i += TAM_BLOQUE)
         {
-            cout << "[ALERTA] Se detecto un posible ciclo negativo en el mapa urbano.\n";
-            return false;
+            bloques.emplace_back(entradas + i, entradas + min(n, i + TAM_BLOQUE));
+            cercas.push_back(entradas[i]);
         }
+        total = n;
     }
-    return true;
-}
 
-// Construye la ruta desde origen a destino usando el vector padre
-vector<int> reconstruirRuta(int origen, int destino, const vector<int>& padre)
-{
-    vector<int> ruta;
-    int nodo = destino;
-    while (nodo != -1)
-    {
-        ruta.push_back(nodo);
-        if (nodo == origen)
-            break;
-        nodo = padre[nodo];
-    }
-    if (ruta.back() != origen)
+    void insertar(const EntradaTemporal& e)
     {
-        ruta.clear(); // no hay ruta posible
-        return ruta;
+        if (bloques.empty())
+        {
+            bloques.emplace_back(1, e);
+            cercas.push_back(e);
+            total = 1;
+            return;
+        }
+        size_t b = bloqueDe(e);
+        vector<EntradaTemporal>& bloque = bloques[b];
+        bloque.insert(upper_bound(bloque.begin(), bloque.end(), e), e);
+        cercas[b] = bloque.front();
+        total++;
+        if (bloque.size() > 2 * TAM_BLOQUE)
+        {
+            vector<EntradaTemporal> mitad(bloque.begin() + TAM_BLOQUE, bloque.end());
+            bloque.resize(TAM_BLOQUE);
+            cercas.insert(cercas.begin() + b + 1, mitad.front());
+            bloques.insert(bloques.begin() + b + 1, std::move(mitad));
+        }
     }
-    reverse(ruta.begin(), ruta.end());
-    return ruta;
-}
 
-// Actualizar peso de una calle (para simular trafico, desvio, bloqueo, etc.)
-void actualizarPesoArista(int u, int v, int nuevoPeso)
-{
-    bool encontrado = false;
-    for (auto& e : aristasAmbulancia)
+    /**
+     * Visita en orden las entradas mayores que 'despuesDe' con instante <= hasta.
+     * 'visitar' devuelve false para cortar (p. ej. pagina completa).
+     */
+    template <typename Visitar>
+    void recorrer(const EntradaTemporal& despuesDe, uint32_t hasta, Visitar visitar) const
     {
-        if ((e.u == u && e.v == v) || (e.u == v && e.v == u))
+        if (bloques.empty())
+            return;
+        size_t b = bloqueDe(despuesDe);
+        size_t i = static_cast<size_t>(upper_bound(bloques[b].begin(), bloques[b].end(), despuesDe) - bloques[b].begin());
+        for (; b < bloques.size(); ++b, i = 0)
         {
-            e.peso = nuevoPeso;
-            encontrado = true;
+            for (; i < bloques[b].size(); ++i)
+            {
+                const EntradaTemporal& e = bloques[b][i];
+                if (e.instante > hasta || !visitar(e))
+                    return;
+            }
         }
     }
-    if (encontrado)
-        cout << "[INFO] Peso de la arista (" << u << "," << v << ") actualizado a " << nuevoPeso << " minutos.\n";
-    else
-        cout << "[ADVERTENCIA] No se encontro una via entre " << u << " y " << v << ".\n";
-}
-
-// Registrar una nueva emergencia en el sistema
-void registrarEmergencia()
-{
-    int nodo;
-    cout << "\n[EMERGENCIA] Ingrese nodo de la emergencia (0-" << (numNodosAmbulancia - 1) << "): ";
-    cin >> nodo;
 
-    if (nodo < 0 || nodo >= numNodosAmbulancia)
+    size_t size() const
     {
-        cout << "[ERROR] Nodo fuera de rango.\n";
-        return;
+        return total;
     }
+};
 
-    EmergenciaRuta e;
-    e.idEmergencia = contadorEmergencias++;
-    e.nodoDestino = nodo;
-    e.atendida = false;
-    e.idAmbulanciaAsignada = -1;
-    e.tiempoEstimado = INF_TIEMPO;
-
-    emergencias.push_back(e);
-
-    cout << "[INFO] Emergencia #" << e.idEmergencia
-         << " registrada en nodo " << e.nodoDestino << ".\n";
-}
-
-// Asignar la ambulancia mas cercana a una emergencia especifica
-void asignarAmbulanciaMasCercana(int idEmergencia)
+class IndiceTemporalCitas
 {
-    if (emergencias.empty())
+private:
+    SecuenciaTemporal todas;
+    unordered_map<int, SecuenciaTemporal> porMedico;
+    unordered_map<string, SecuenciaTemporal> porEspecialidad;
+
+public:
+    void limpiar()
     {
-        cout << "[INFO] No hay emergencias registradas.\n";
-        return;
+        todas.limpiar();
+        porMedico.clear();
+        porEspecialidad.clear();
     }
 
-    EmergenciaRuta* objetivo = nullptr;
-    for (auto& e : emergencias)
+    // Carga masiva: 'instantes[i]' corresponde a citas[i] (UINT32_MAX si la cita no tiene fecha valida)
+    void reconstruir(const vector<Cita>& citas, const vector<uint32_t>& instantes)
     {
-        if (e.idEmergencia == idEmergencia)
+        limpiar();
+        vector<pair<EntradaTemporal, uint32_t>> entradas; // (entrada, posicion en citas)
+        entradas.reserve(citas.size());
+        for (size_t i = 0; i < citas.size(); ++i)
+            if (instantes[i] != UINT32_MAX)
+                entradas.push_back({ { instantes[i], citas[i].idCita }, static_cast<uint32_t>(i) });
+        sort(entradas.begin(), entradas.end(),
+             [](const pair<EntradaTemporal, uint32_t>& a, const pair<EntradaTemporal, uint32_t>& b)
+             { return a.first < b.first; });
+
+        // Reparto estable por medico y especialidad: cada grupo sale ya ordenado
+        vector<EntradaTemporal> orden(entradas.size());
+        unordered_map<int, vector<EntradaTemporal>> gruposMedico;
+        unordered_map<string, vector<EntradaTemporal>> gruposEspecialidad;
+        for (size_t i = 0; i < entradas.size(); ++i)
         {
-            objetivo = &e;
-            break;
+            const Cita& c = citas[entradas[i].second];
+            orden[i] = entradas[i].first;
+            gruposMedico[c.idMedico].push_back(orden[i]);
+            gruposEspecialidad[c.especialidad].push_back(orden[i]);
         }
+        todas.cargarOrdenadas(orden.data(), orden.size());
+        for (auto& kv : gruposMedico)
+            porMedico[kv.first].cargarOrdenadas(kv.second.data(), kv.second.size());
+        for (auto& kv : gruposEspecialidad)
+            porEspecialidad[kv.first].cargarOrdenadas(kv.second.data(), kv.second.size());
     }
 
-    if (!objetivo)
+    void insertar(const Cita& c, uint32_t instante)
     {
-        cout << "[ERROR] Emergencia con ID " << idEmergencia << " no encontrada.\n";
-        return;
-    }
-    if (objetivo->atendida)
-    {
-        cout << "[INFO] La emergencia #" << idEmergencia << " ya fue atendida.\n";
-        return;
+        EntradaTemporal e = { instante, c.idCita };
+        todas.insertar(e);
+        porMedico[c.idMedico].insertar(e);
+        porEspecialidad[c.especialidad].insertar(e);
     }
 
-    int mejorTiempo = INF_TIEMPO;
-    int idxMejorAmb = -1;
-    vector<int> mejorRuta;
-
-    for (size_t i = 0; i < ambulancias.size(); ++i)
+    // Secuencia a recorrer: toda la agenda, un medico (idMedico >= 0) o una especialidad
+    const SecuenciaTemporal* secuencia(int idMedico, const string& especialidad) const
     {
-        if (!ambulancias[i].disponible)
-            continue;
-
-        vector<int> dist, padre;
-        if (!bellmanFord(ambulancias[i].nodoActual, dist, padre))
+        if (idMedico >= 0)
         {
-            cout << "[ERROR] No se pudo ejecutar Bellman-Ford para la ambulancia " << ambulancias[i].idAmbulancia << ".\n";
-            continue;
+            auto it = porMedico.find(idMedico);
+            return it == porMedico.end() ? nullptr : &it->second;
         }
-
-        if (dist[objetivo->nodoDestino] < mejorTiempo)
+        if (!especialidad.empty())
         {
-            vector<int> rutaCandidata = reconstruirRuta(ambulancias[i].nodoActual,
-                                                        objetivo->nodoDestino, padre);
-            if (!rutaCandidata.empty())
-            {
-                mejorTiempo = dist[objetivo->nodoDestino];
-                idxMejorAmb = static_cast<int>(i);
-                mejorRuta = rutaCandidata;
-            }
+            auto it = porEspecialidad.find(especialidad);
+            return it == porEspecialidad.end() ? nullptr : &it->second;
         }
+        return &todas;
     }
+};
 
-    if (idxMejorAmb == -1)
+IndiceTemporalCitas indiceTemporal;
+
+// --- 2C. JOURNAL DE MUTACIONES (REDO LOG CON GROUP COMMIT) ---
+
+/*
+ * Cada mutacion de estado se agrega a un journal binario append-only:
+ *   uint32 longitudPayload | uint32 crc32 | uint64 lsn | uint8 tipo | payload
+ * El crc cubre lsn, tipo y payload; un registro cortado por una caida se
+ * detecta al reproducir y se descarta junto con todo lo que le sigue.
+ * Se registran operaciones logicas (p. ej. "cancelar cita 7"): reproducirlas
+ * en orden sobre el mismo estado base vuelve a ejecutar la misma logica,
+ * incluida la reasignacion desde la lista de espera.
+ * Es un redo log, no un write-ahead log: la operacion se aplica en memoria y
+ * se registra despues, solo si tuvo exito. El estado en memoria se pierde en
+ * una caida, asi que lo que importa es el orden entre el journal y lo que sale
+ * del proceso: con esperarConfirmacion la respuesta al cliente espera a que su
+ * registro sea durable, y el journal solo se recorta cuando el snapshot que lo
+ * reemplaza ya esta en disco (ver guardarSnapshot).
+ */
+enum TipoMutacion : uint8_t
+{
+    MUT_CANCELAR_CITA = 1,
+    MUT_DISPONIBILIDAD = 2,
+    MUT_ASIGNAR_RECURSOS = 3,
+    MUT_ALTA_PACIENTES = 4,
+    MUT_CONSUMIR_MEDICAMENTO = 5,
+    MUT_REABASTECER_MEDICAMENTO = 6,
+    MUT_PACIENTE_CRITICO = 7,
+    MUT_AGENDAR_CITA = 8,
+    MUT_AGREGAR_ESPERA = 9,
+    MUT_RETIRAR_ESPERA = 10,
+    MUT_PESO_ARISTA = 11,
+    MUT_REGISTRAR_PACIENTE = 12,
+    MUT_CANCELAR_SIN_REASIGNAR = 13,
+    MUT_LLENAR_HUECOS = 14,
+    MUT_LLENAR_HUECOS_CITAS = 15
+};
+
+const size_t BYTES_CABECERA_MUTACION = 4 + 4 + 8 + 1;
+
+struct TablaCrc32
+{
+    uint32_t valor[256];
+
+    TablaCrc32()
     {
-        cout << "[ALERTA] No hay ambulancias disponibles para esta emergencia.\n";
-        return;
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k)
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            valor[i] = c;
+        }
     }
+};
 
-    // Asignacion final
-    objetivo->atendida = true;
-    objetivo->idAmbulanciaAsignada = ambulancias[idxMejorAmb].idAmbulancia;
-    objetivo->ruta = mejorRuta;
-    objetivo->tiempoEstimado = mejorTiempo;
-    ambulancias[idxMejorAmb].disponible = false;
+uint32_t crc32(const char* datos, size_t n, uint32_t crc = 0)
+{
+    static const TablaCrc32 tabla; // static local: inicializacion segura entre hilos
+    crc = ~crc;
+    for (size_t i = 0; i < n; ++i)
+        crc = tabla.valor[(crc ^ static_cast<uint8_t>(datos[i])) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
 
-    cout << "\n[ASIGNACION] Emergencia #" << objetivo->idEmergencia
-         << " atendida por Ambulancia #" << objetivo->idAmbulanciaAsignada << ".\n";
-    cout << "Ruta optima: ";
-    for (int nodo : objetivo->ruta)
-        cout << nodo << " ";
-    cout << "\nTiempo estimado de llegada: " << objetivo->tiempoEstimado << " minutos.\n";
+// fsync de un archivo ya cerrado o de un directorio, por su ruta (en Windows no hace nada)
+bool sincronizarRuta(const string& ruta)
+{
+#ifdef _WIN32
+    (void)ruta;
+    return true;
+#else
+    int fd = open(ruta.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    bool ok = fsync(fd) == 0;
+    close(fd);
+    return ok;
+#endif
 }
 
-// Asignar ambulancias a todas las emergencias pendientes (emergencias simultaneas)
-void asignarEmergenciasSimultaneas()
+// Directorio que contiene 'ruta', para hacer durable un rename
+string directorioDe(const string& ruta)
 {
-    if (emergencias.empty())
-    {
-        cout << "[INFO] No hay emergencias registradas.\n";
-        return;
-    }
+    filesystem::path padre = filesystem::path(ruta).parent_path();
+    return padre.empty() ? string(".") : padre.string();
+}
 
-    cout << "\n[EMERGENCIAS] Asignando ambulancias a todas las emergencias pendientes...\n";
+// Construye el payload de una mutacion
+class Mutacion
+{
+public:
+    TipoMutacion tipo;
+    string payload;
 
-    bool huboAsignaciones = false;
+    explicit Mutacion(TipoMutacion t) : tipo(t) {}
 
-    // Estrategia greedy: siempre buscar la mejor ambulancia para cada emergencia pendiente
-    for (auto& e : emergencias)
+    Mutacion& entero(int32_t v)
     {
-        if (e.atendida)
-            continue;
+        payload.append(reinterpret_cast<const char*>(&v), sizeof(v));
+        return *this;
+    }
 
-        int mejorTiempo = INF_TIEMPO;
-        int idxMejorAmb = -1;
-        vector<int> mejorRuta;
+    Mutacion& texto(const string& s)
+    {
+        entero(static_cast<int32_t>(s.size()));
+        payload += s;
+        return *this;
+    }
+};
 
-        for (size_t i = 0; i < ambulancias.size(); ++i)
-        {
-            if (!ambulancias[i].disponible)
-                continue;
+// Lee en orden los campos de un payload; 'ok' queda en false si se agota
+class LectorMutacion
+{
+private:
+    const string& payload;
+    size_t pos = 0;
 
-            vector<int> dist, padre;
-            if (!bellmanFord(ambulancias[i].nodoActual, dist, padre))
-                continue;
+public:
+    bool ok = true;
 
-            if (dist[e.nodoDestino] < mejorTiempo)
-            {
-                vector<int> rutaCandidata = reconstruirRuta(ambulancias[i].nodoActual,
-                                                            e.nodoDestino, padre);
-                if (!rutaCandidata.empty())
-                {
-                    mejorTiempo = dist[e.nodoDestino];
-                    idxMejorAmb = static_cast<int>(i);
-                    mejorRuta = rutaCandidata;
-                }
-            }
-        }
+    explicit LectorMutacion(const string& p) : payload(p) {}
 
-        if (idxMejorAmb != -1)
+    int32_t entero()
+    {
+        int32_t v = 0;
+        if (pos + sizeof(v) > payload.size())
         {
-            e.atendida = true;
-            e.idAmbulanciaAsignada = ambulancias[idxMejorAmb].idAmbulancia;
-            e.ruta = mejorRuta;
-            e.tiempoEstimado = mejorTiempo;
-            ambulancias[idxMejorAmb].disponible = false;
-            huboAsignaciones = true;
-
-            cout << "[ASIGNACION] Emergencia #" << e.idEmergencia
-                 << " -> Ambulancia #" << e.idAmbulanciaAsignada
-                 << " (ETA: " << e.tiempoEstimado << " min)\n";
+            ok = false;
+            return 0;
         }
+        memcpy(&v, payload.data() + pos, sizeof(v));
+        pos += sizeof(v);
+        return v;
     }
 
-    if (!huboAsignaciones)
-        cout << "[INFO] No se pudo asignar ninguna ambulancia (todas ocupadas o sin ruta).\n";
-}
-
-// Permite actualizar el trafico y recalcular la ruta de una emergencia ya asignada
-void actualizarTraficoYRecalcular()
-{
-    if (emergencias.empty())
+    string texto()
     {
-        cout << "[INFO] No hay emergencias registradas.\n";
-        return;
+        int32_t n = entero();
+        if (!ok || n < 0 || pos + static_cast<size_t>(n) > payload.size())
+        {
+            ok = false;
+            return string();
+        }
+        string s = payload.substr(pos, static_cast<size_t>(n));
+        pos += static_cast<size_t>(n);
+        return s;
     }
+};
 
-    int u, v, nuevoPeso;
-    cout << "\n[TRAFICO] Actualizar peso de una via.\n";
-    cout << "Nodo origen: ";
-    cin >> u;
-    cout << "Nodo destino: ";
-    cin >> v;
-    cout << "Nuevo tiempo estimado (minutos, puede ser negativo como penalizacion): ";
-    cin >> nuevoPeso;
-
-    actualizarPesoArista(u, v, nuevoPeso);
+enum class ModoDurabilidad
+{
+    Ninguna,   // solo se escribe al sistema operativo (sin fsync)
+    Grupo,     // fsync compartido por lote o por intervalo (group commit)
+    Inmediata  // fsync por cada mutacion
+};
 
-    int idEmerg;
-    cout << "\n[RECALCULO] Ingrese ID de la emergencia a recalcular: ";
-    cin >> idEmerg;
+struct ConfigJournal
+{
+    ModoDurabilidad modo = ModoDurabilidad::Grupo;
+    int intervaloMs = 10;             // latencia maxima antes de forzar el lote a disco
+    size_t loteMaximo = 256;          // mutaciones pendientes que disparan el fsync
+    bool esperarConfirmacion = false; // si true, registrar() espera a que su lote sea durable
+};
 
-    EmergenciaRuta* e = nullptr;
-    for (auto& em : emergencias)
+/**
+ * Journal append-only con group commit. Las mutaciones se acumulan en un
+ * buffer y un hilo escritor las lleva a disco con un solo fsync por lote,
+ * cuando se llena el lote o vence el intervalo. Asi miles de operaciones por
+ * segundo comparten unos pocos fsync; el intervalo acota cuanto se puede
+ * perder ante una caida (o nada, con esperarConfirmacion / modo Inmediata).
+ */
+class JournalMutaciones
+{
+private:
+    FILE* archivo = nullptr;
+    string ruta;
+    ConfigJournal config;
+
+    mutex mtx;        // protege buffer, contadores y lsn
+    mutex mtxArchivo; // serializa escrituras: se toma antes de soltar mtx para conservar el orden
+    condition_variable cvEscritor;
+    condition_variable cvDurable;
+    thread escritor;
+    string bufferPendiente;
+    size_t registrosPendientes = 0;
+    bool detener = false;
+
+    uint64_t lsnSiguiente = 1;
+    uint64_t lsnDurable = 0;
+
+    static void codificar(string& destino, uint64_t lsn, TipoMutacion tipo, const string& payload)
     {
-        if (em.idEmergencia == idEmerg)
-        {
-            e = &em;
-            break;
-        }
+        uint32_t longitud = static_cast<uint32_t>(payload.size());
+        string cuerpo;
+        cuerpo.reserve(9 + payload.size());
+        cuerpo.append(reinterpret_cast<const char*>(&lsn), sizeof(lsn));
+        cuerpo.push_back(static_cast<char>(tipo));
+        cuerpo += payload;
+        uint32_t crc = crc32(cuerpo.data(), cuerpo.size());
+        destino.append(reinterpret_cast<const char*>(&longitud), sizeof(longitud));
+        destino.append(reinterpret_cast<const char*>(&crc), sizeof(crc));
+        destino += cuerpo;
     }
 
-    if (!e)
+    static void sincronizarArchivo(FILE* f)
     {
-        cout << "[ERROR] Emergencia no encontrada.\n";
-        return;
+        fflush(f);
+#ifdef _WIN32
+        _commit(_fileno(f));
+#else
+        fdatasync(fileno(f));
+#endif
     }
 
-    if (e->idAmbulanciaAsignada == -1)
+    void escribirLote(const string& lote, bool conFsync)
     {
-        cout << "[INFO] La emergencia seleccionada aun no tiene ambulancia asignada.\n";
-        return;
+        if (!archivo)
+            return;
+        fwrite(lote.data(), 1, lote.size(), archivo);
+        if (conFsync)
+            sincronizarArchivo(archivo);
+        else
+            fflush(archivo);
+        bytesEscritos += static_cast<long long>(lote.size());
+        if (conFsync)
+            fsyncs++;
     }
 
-    // Buscamos la ambulancia que tiene ese ID
-    Ambulancia* amb = nullptr;
-    for (auto& a : ambulancias)
+    void bucleEscritor()
     {
-        if (a.idAmbulancia == e->idAmbulanciaAsignada)
+        unique_lock<mutex> lk(mtx);
+        while (true)
         {
-            amb = &a;
-            break;
+            cvEscritor.wait_for(lk, chrono::milliseconds(config.intervaloMs),
+                                [this]
+                                {
+                                    return detener || registrosPendientes >= config.loteMaximo ||
+                                           (config.esperarConfirmacion && registrosPendientes > 0);
+                                });
+            if (!bufferPendiente.empty())
+            {
+                string lote;
+                lote.swap(bufferPendiente);
+                uint64_t hasta = lsnSiguiente - 1;
+                registrosPendientes = 0;
+                unique_lock<mutex> lkArchivo(mtxArchivo);
+                lk.unlock();
+                escribirLote(lote, config.modo != ModoDurabilidad::Ninguna);
+                lkArchivo.unlock();
+                lk.lock();
+                lsnDurable = max(lsnDurable, hasta);
+                cvDurable.notify_all();
+            }
+            if (detener)
+                break;
         }
     }
 
-    if (!amb)
+public:
+    bool suspendido = false; // true mientras se reproduce el journal
+    long long registros = 0;
+    long long fsyncs = 0;
+    long long bytesEscritos = 0;
+
+    ~JournalMutaciones()
     {
-        cout << "[ERROR] No se encontro la ambulancia asignada.\n";
-        return;
+        cerrar();
     }
 
-    vector<int> dist, padre;
-    if (!bellmanFord(amb->nodoActual, dist, padre))
+    bool activo() const
     {
-        cout << "[ERROR] No se pudo recalcular la ruta.\n";
-        return;
+        return archivo != nullptr && !suspendido;
     }
 
-    vector<int> nuevaRuta = reconstruirRuta(amb->nodoActual, e->nodoDestino, padre);
-    if (nuevaRuta.empty())
+    // Abre (o crea) el journal para agregar; lsnInicial = ultimo lsn ya aplicado
+    bool abrir(const string& rutaJournal, const ConfigJournal& cfg, uint64_t lsnInicial)
     {
-        cout << "[ALERTA] Tras el cambio de trafico ya no existe ruta valida hacia la emergencia.\n";
-        return;
+        cerrar();
+        archivo = fopen(rutaJournal.c_str(), "ab");
+        if (!archivo)
+            return false;
+        ruta = rutaJournal;
+        config = cfg;
+        lsnSiguiente = lsnInicial + 1;
+        lsnDurable = lsnInicial;
+        detener = false;
+        if (config.modo != ModoDurabilidad::Inmediata)
+            escritor = thread(&JournalMutaciones::bucleEscritor, this);
+        return true;
     }
 
-    e->ruta = nuevaRuta;
-    e->tiempoEstimado = dist[e->nodoDestino];
-
-    cout << "\n[NUEVA RUTA] Emergencia #" << e->idEmergencia
-         << " atendida por Ambulancia #" << e->idAmbulanciaAsignada << ".\n";
-    cout << "Ruta recalculada: ";
-    for (int nodo : e->ruta)
-        cout << nodo << " ";
-    cout << "\nNuevo tiempo estimado de llegada: " << e->tiempoEstimado << " minutos.\n";
-}
-
-// Mostrar resumen de emergencias registradas y tiempos estimados
-void mostrarResumenEmergencias()
-{
-    if (emergencias.empty())
+    void cerrar()
     {
-        cout << "\n[INFO] No hay emergencias registradas.\n";
-        return;
+        if (escritor.joinable())
+        {
+            {
+                lock_guard<mutex> lk(mtx);
+                detener = true;
+            }
+            cvEscritor.notify_all();
+            escritor.join();
+        }
+        if (!archivo)
+            return;
+        sincronizarArchivo(archivo);
+        fclose(archivo);
+        archivo = nullptr;
     }
 
-    cout << "\n========== RESUMEN DE EMERGENCIAS ==========\n";
-    for (const auto& e : emergencias)
+    uint64_t ultimoLsn()
     {
-        cout << "Emergencia #" << e.idEmergencia
-             << " | Nodo: " << e.nodoDestino
-             << " | Estado: " << (e.atendida ? "ATENDIDA" : "PENDIENTE");
+        lock_guard<mutex> lk(mtx);
+        return lsnSiguiente - 1;
+    }
 
-        if (e.atendida)
+    // Agrega la mutacion; devuelve su lsn (0 si el journal no esta activo)
+    uint64_t registrar(const Mutacion& m)
+    {
+        if (!activo())
+            return 0;
+        unique_lock<mutex> lk(mtx);
+        uint64_t lsn = lsnSiguiente++;
+        codificar(bufferPendiente, lsn, m.tipo, m.payload);
+        registros++;
+
+        if (config.modo == ModoDurabilidad::Inmediata)
+        {
+            string lote;
+            lote.swap(bufferPendiente);
+            lock_guard<mutex> lkArchivo(mtxArchivo);
+            escribirLote(lote, true);
+            lsnDurable = lsn;
+            return lsn;
+        }
+        if (++registrosPendientes >= config.loteMaximo)
+            cvEscritor.notify_one();
+        if (config.esperarConfirmacion)
         {
-            cout << " | Ambulancia #" << e.idAmbulanciaAsignada
-                 << " | ETA: " << e.tiempoEstimado << " min";
+            // No se espera al intervalo: el escritor sale ya, y quienes lleguen mientras
+            // dura su fsync forman el siguiente lote
+            cvEscritor.notify_one();
+            cvDurable.wait(lk, [this, lsn] { return lsnDurable >= lsn; });
         }
-        cout << "\n";
+        return lsn;
     }
-    cout << "===========================================\n";
-}
 
-// Sub-menu principal del modulo de rutas de ambulancia
-void optimizarRutaAmbulancia()
-{
-    int opcion = -1;
-    do
+    // Fuerza a disco todo lo pendiente
+    void sincronizar()
     {
-        cout << "\n---------------- MODULO DE RUTAS DE AMBULANCIAS ----------------\n";
-        cout << "1. Registrar nueva emergencia\n";
-        cout << "2. Asignar ambulancia mas cercana a una emergencia\n";
-        cout << "3. Asignar ambulancias a todas las emergencias pendientes\n";
-        cout << "4. Actualizar trafico y recalcular ruta de una emergencia\n";
-        cout << "5. Ver resumen de emergencias y tiempos estimados\n";
-        cout << "0. Volver al menu principal\n";
-        cout << "Seleccione una opcion: ";
-        cin >> opcion;
-
-        switch (opcion)
-        {
-        case 1:
-            registrarEmergencia();
-            break;
-        case 2:
+        if (!archivo)
+            return;
+        lock_guard<mutex> lk(mtx);
+        lock_guard<mutex> lkArchivo(mtxArchivo);
+        if (!bufferPendiente.empty())
         {
-            int id;
-            cout << "Ingrese ID de la emergencia a asignar: ";
-            cin >> id;
-            asignarAmbulanciaMasCercana(id);
-            break;
+            escribirLote(bufferPendiente, true);
+            bufferPendiente.clear();
+            registrosPendientes = 0;
+            lsnDurable = lsnSiguiente - 1;
+            cvDurable.notify_all();
         }
-        case 3:
-            asignarEmergenciasSimultaneas();
-            break;
-        case 4:
-            actualizarTraficoYRecalcular();
-            break;
-        case 5:
-            mostrarResumenEmergencias();
-            break;
-        case 0:
-            cout << "[INFO] Volviendo al menu principal...\n";
-            break;
-        default:
-            cout << "[ERROR] Opcion no valida en modulo de ambulancias.\n";
-            break;
+        else
+        {
+            sincronizarArchivo(archivo);
         }
+    }
 
-    } while (opcion != 0);
-}
-
-// --- 6. ASIGNACIÓN DE RECURSOS HOSPITALARIOS (GREEDY + SKEW HEAP) ---
+    /**
+     * Checkpoint: quita del journal las mutaciones con lsn <= hasta, que ya estan
+     * en un snapshot durable. Las registradas despues (otro hilo pudo agregar
+     * entre que se tomo el lsn del snapshot y este punto) se conservan: se
+     * reescriben en un archivo temporal que reemplaza al journal con rename.
+     * Todo ocurre con el journal bloqueado, asi ningun registro queda a medias.
+     */
+    void truncarHasta(uint64_t hasta)
+    {
+        if (!archivo)
+            return;
+        lock_guard<mutex> lk(mtx);
+        lock_guard<mutex> lkArchivo(mtxArchivo);
+        if (lsnSiguiente - 1 <= hasta)
+        {
+            bufferPendiente.clear();
+            registrosPendientes = 0;
+            archivo = freopen(ruta.c_str(), "wb", archivo);
+            if (archivo)
+                sincronizarArchivo(archivo);
+        }
+        else
+        {
+            escribirLote(bufferPendiente, false);
+            bufferPendiente.clear();
+            registrosPendientes = 0;
+            string resto;
+            long long leidos;
+            bool recortado;
+            leer(ruta,
+                 [&resto, hasta](uint64_t lsn, TipoMutacion tipo, const string& payload)
+                 {
+                     if (lsn > hasta)
+                         codificar(resto, lsn, tipo, payload);
+                 },
+                 leidos, recortado);
+            string rutaTemporal = ruta + ".tmp";
+            FILE* nuevo = fopen(rutaTemporal.c_str(), "wb");
+            bool ok = nuevo && fwrite(resto.data(), 1, resto.size(), nuevo) == resto.size();
+            if (nuevo)
+            {
+                sincronizarArchivo(nuevo);
+                fclose(nuevo);
+            }
+            if (ok && rename(rutaTemporal.c_str(), ruta.c_str()) == 0)
+            {
+                sincronizarRuta(directorioDe(ruta));
+                fclose(archivo);
+                archivo = fopen(ruta.c_str(), "ab");
+            }
+            // si no se pudo reemplazar, el journal queda entero: reproducirlo descarta lsn <= hasta
+        }
+        if (!archivo)
+            cout << "[ERROR] No se pudo reabrir el journal " << ruta << "; se desactiva." << endl;
+        lsnDurable = lsnSiguiente - 1;
+        cvDurable.notify_all();
+    }
 
-// Niveles de urgencia ESI 1-5 (1 = más urgente)
-enum class UrgenciaESI
-{
-    ESI1 = 1,
-    ESI2 = 2,
-    ESI3 = 3,
-    ESI4 = 4,
-    ESI5 = 5
+    /**
+     * Recorre un journal y entrega cada mutacion valida en orden. Se detiene en
+     * el primer registro incompleto o con crc invalido (escritura cortada) y
+     * recorta el archivo en ese punto. Devuelve el ultimo lsn leido.
+     */
+    static uint64_t leer(const string& rutaJournal,
+                         const function<void(uint64_t, TipoMutacion, const string&)>& aplicar,
+                         long long& leidos, bool& recortado)
+    {
+        leidos = 0;
+        recortado = false;
+        uint64_t ultimo = 0;
+        ifstream in(rutaJournal, ios::binary);
+        if (!in)
+            return 0;
+        string contenido((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+        in.close();
+
+        size_t pos = 0;
+        while (pos + BYTES_CABECERA_MUTACION <= contenido.size())
+        {
+            uint32_t longitud, crc;
+            memcpy(&longitud, contenido.data() + pos, sizeof(longitud));
+            memcpy(&crc, contenido.data() + pos + 4, sizeof(crc));
+            size_t inicioCuerpo = pos + 8;
+            size_t bytesCuerpo = 9 + static_cast<size_t>(longitud);
+            if (inicioCuerpo + bytesCuerpo > contenido.size() ||
+                crc32(contenido.data() + inicioCuerpo, bytesCuerpo) != crc)
+                break;
+            uint64_t lsn;
+            memcpy(&lsn, contenido.data() + inicioCuerpo, sizeof(lsn));
+            TipoMutacion tipo = static_cast<TipoMutacion>(contenido[inicioCuerpo + 8]);
+            aplicar(lsn, tipo, contenido.substr(inicioCuerpo + 9, longitud));
+            ultimo = lsn;
+            leidos++;
+            pos = inicioCuerpo + bytesCuerpo;
+        }
+        if (pos < contenido.size())
+        {
+            recortado = true;
+            ofstream out(rutaJournal, ios::binary | ios::trunc);
+            out.write(contenido.data(), static_cast<streamsize>(pos));
+        }
+        return ultimo;
+    }
 };
 
-// Paciente crítico para asignación de UCI/ventiladores
-struct PacienteCritico
-{
-    int idPaciente;
-    string dni;
-    string nombre;
-    UrgenciaESI urgencia;
-    bool necesitaUCI;
-    bool necesitaVentilador;
-    bool necesitaMedCritica;
-    long long ordenLlegada; // para desempatar por orden de llegada
-};
+JournalMutaciones journalMutaciones;
 
-// Comparador de prioridad: menor ESI -> más prioridad; si empatan, menor ordenLlegada
-bool tieneMayorPrioridad(const PacienteCritico& a, const PacienteCritico& b)
+// Punto unico de registro usado por las operaciones que modifican el estado
+inline void registrarMutacion(const Mutacion& m)
 {
-    if (static_cast<int>(a.urgencia) != static_cast<int>(b.urgencia))
-        return static_cast<int>(a.urgencia) < static_cast<int>(b.urgencia);
-    return a.ordenLlegada < b.ordenLlegada;
+    journalMutaciones.registrar(m);
 }
 
-// Nodo de Skew Heap
-struct NodoSkew
-{
-    PacienteCritico valor;
-    NodoSkew* izq;
-    NodoSkew* der;
-
-    NodoSkew(const PacienteCritico& p) : valor(p), izq(nullptr), der(nullptr) {}
-};
+// --- 2D. INDICE DE NOMBRES DE PACIENTES (VOCABULARIO + TRIGRAMAS) ---
+
+/*
+ * Autocompletado por nombre sin recorrer tablaPacientes. Los nombres se
+ * normalizan (minusculas, sin tildes) y se parten en palabras:
+ *  - vocabulario: cada palabra distinta tiene la lista ordenada de posiciones
+ *    de los pacientes que la usan (los pacientes solo se agregan al final,
+ *    asi que las listas crecen con push_back) y cada paciente guarda los ids
+ *    de sus palabras para verificar candidatos sin releer su nombre;
+ *  - consulta: cada palabra de la consulta se resuelve contra el vocabulario
+ *    (palabras con ese prefijo, y en una segunda fase las que estan a 1-2
+ *    errores de tipeo); la de menos pacientes guia un recorrido de su union
+ *    desde los pacientes mas recientes y las demas solo se verifican;
+ *  - errores de tipeo: cada palabra del vocabulario esta indexada por sus
+ *    trigramas (" ca", "car", ...) y sus bigramas (" c", "ca", ...). Una edicion
+ *    o transposicion destruye como mucho 4 trigramas y 3 bigramas, asi que toda
+ *    palabra a d errores aparece en alguna de las 4d+1 listas de trigramas mas
+ *    cortas de la consulta si esta tiene mas de 4d trigramas distintos, o si no
+ *    (palabras de 4-5 letras con d=1, de 8-9 con d=2) en alguna de las 3d+1
+ *    listas de bigramas mas cortas.
+ * El vocabulario es mucho menor que la cantidad de pacientes, de modo que
+ * resolver las palabras cuesta poco aunque haya decenas de millones.
+ */
+const int SIMBOLOS_TRIGRAMA = 37;               // espacio, a-z, 0-9
+const size_t LIMITE_PALABRAS_PREFIJO = 4096;     // mas palabras con el prefijo: el termino solo se verifica
+const size_t LIMITE_CANDIDATOS_NOMBRE = 20000;   // pacientes explorados como maximo por fase
 
-// Skew Heap para cola de prioridad de pacientes críticos
-class SkewHeapCritico
+// Minusculas sin tildes; todo lo que no es letra o digito separa palabras (un solo espacio)
+string normalizarNombre(string_view s)
 {
-private:
-    NodoSkew* raiz;
-
-    static NodoSkew* fusionar(NodoSkew* a, NodoSkew* b)
+    string r;
+    r.reserve(s.size());
+    auto agregar = [&r](char ch)
     {
-        if (!a)
-            return b;
-        if (!b)
-            return a;
-
-        // El nodo con mayor prioridad (más urgente) debe ir en la raíz
-        if (!tieneMayorPrioridad(a->valor, b->valor))
+        if (ch == ' ')
         {
-            std::swap(a, b);
+            if (!r.empty() && r.back() != ' ')
+                r.push_back(' ');
         }
-
-        // Fusión en subárbol derecho
-        a->der = fusionar(a->der, b);
-
-        // Propiedad del skew heap: se intercambian hijos
-        std::swap(a->izq, a->der);
-        return a;
-    }
-
-    static void limpiar(NodoSkew* n)
+        else
+            r.push_back(ch);
+    };
+    for (size_t i = 0; i < s.size(); ++i)
     {
-        if (!n)
-            return;
-        limpiar(n->izq);
-        limpiar(n->der);
-        delete n;
+        unsigned char ch = static_cast<unsigned char>(s[i]);
+        if (ch >= 'A' && ch <= 'Z')
+            agregar(static_cast<char>(ch - 'A' + 'a'));
+        else if ((ch >= 'a' && ch <= 'z') || (ch >= '0' && ch <= '9'))
+            agregar(static_cast<char>(ch));
+        else if (ch == 0xC3 && i + 1 < s.size()) // vocales con tilde, ü y ñ en UTF-8
+        {
+            unsigned char sig = static_cast<unsigned char>(s[++i]) | 0x20; // mayuscula -> minuscula
+            switch (sig)
+            {
+            case 0xA1: agregar('a'); break;
+            case 0xA9: agregar('e'); break;
+            case 0xAD: agregar('i'); break;
+            case 0xB3: agregar('o'); break;
+            case 0xBA:
+            case 0xBC: agregar('u'); break;
+            case 0xB1: agregar('n'); break;
+            default: agregar(' '); break;
+            }
+        }
+        else
+            agregar(' ');
     }
+    if (!r.empty() && r.back() == ' ')
+        r.pop_back();
+    return r;
+}
 
-public:
-    SkewHeapCritico() : raiz(nullptr) {}
-
-    ~SkewHeapCritico()
+static vector<string_view> palabrasDe(string_view normalizado)
+{
+    vector<string_view> palabras;
+    size_t inicio = 0;
+    while (inicio < normalizado.size())
     {
-        limpiar(raiz);
+        size_t fin = normalizado.find(' ', inicio);
+        if (fin == string_view::npos)
+            fin = normalizado.size();
+        palabras.push_back(normalizado.substr(inicio, fin - inicio));
+        inicio = fin + 1;
     }
+    return palabras;
+}
 
-    bool estaVacio() const
-    {
-        return raiz == nullptr;
-    }
+static int codigoSimbolo(char ch)
+{
+    if (ch >= 'a' && ch <= 'z')
+        return 1 + (ch - 'a');
+    if (ch >= '0' && ch <= '9')
+        return 27 + (ch - '0');
+    return 0;
+}
 
-    const PacienteCritico& obtenerMaxPrioridad() const
+// Bigramas de " palabra" (sin repetir)
+static void bigramasDe(string_view palabra, vector<uint32_t>& salida)
+{
+    salida.clear();
+    int a = 0;
+    for (char ch : palabra)
     {
-        return raiz->valor; // se asume que no está vacío
+        int b = codigoSimbolo(ch);
+        salida.push_back(static_cast<uint32_t>(a * SIMBOLOS_TRIGRAMA + b));
+        a = b;
     }
+    sort(salida.begin(), salida.end());
+    salida.erase(unique(salida.begin(), salida.end()), salida.end());
+}
 
-    void insertar(const PacienteCritico& p)
+// Trigramas de " palabra" (sin repetir) para cada palabra de un nombre normalizado
+static void trigramasDe(const vector<string_view>& palabras, vector<uint32_t>& salida)
+{
+    salida.clear();
+    for (string_view p : palabras)
     {
-        NodoSkew* n = new NodoSkew(p);
-        raiz = fusionar(raiz, n);
+        int a = 0, b = codigoSimbolo(p.empty() ? ' ' : p[0]);
+        for (size_t i = 1; i < p.size(); ++i)
+        {
+            int c = codigoSimbolo(p[i]);
+            salida.push_back(static_cast<uint32_t>((a * SIMBOLOS_TRIGRAMA + b) * SIMBOLOS_TRIGRAMA + c));
+            a = b;
+            b = c;
+        }
     }
+    sort(salida.begin(), salida.end());
+    salida.erase(unique(salida.begin(), salida.end()), salida.end());
+}
 
-    void eliminarMaxPrioridad()
+// Menor distancia de edicion (con transposiciones) entre 'consulta' y algun prefijo de 'palabra'; cota: maximo + 1
+static int distanciaPrefijo(string_view consulta, string_view palabra, int maximo)
+{
+    const size_t LARGO_MAXIMO = 48;
+    size_t m = min(consulta.size(), LARGO_MAXIMO), n = min(palabra.size(), LARGO_MAXIMO);
+    // columnas j-2, j-1 y j de la matriz (una fila por caracter de la consulta)
+    int antePrevia[LARGO_MAXIMO + 1], previa[LARGO_MAXIMO + 1], actual[LARGO_MAXIMO + 1];
+    for (size_t i = 0; i <= m; ++i)
+        previa[i] = static_cast<int>(i); // prefijo vacio de la palabra
+    int mejor = previa[m];
+    for (size_t j = 1; j <= n; ++j)
     {
-        if (!raiz)
-            return;
-        NodoSkew* viejaRaiz = raiz;
-        raiz = fusionar(raiz->izq, raiz->der);
-        delete viejaRaiz;
+        actual[0] = static_cast<int>(j);
+        int minimoColumna = actual[0];
+        for (size_t i = 1; i <= m; ++i)
+        {
+            int costo = consulta[i - 1] != palabra[j - 1];
+            actual[i] = min({ previa[i] + 1, actual[i - 1] + 1, previa[i - 1] + costo });
+            if (i > 1 && j > 1 && consulta[i - 1] == palabra[j - 2] && consulta[i - 2] == palabra[j - 1])
+                actual[i] = min(actual[i], antePrevia[i - 2] + 1);
+            minimoColumna = min(minimoColumna, actual[i]);
+        }
+        mejor = min(mejor, actual[m]);
+        if (minimoColumna > maximo)
+            break;
+        memcpy(antePrevia, previa, sizeof(int) * (m + 1));
+        memcpy(previa, actual, sizeof(int) * (m + 1));
     }
-};
+    return min(mejor, maximo + 1);
+}
 
-// Inventario de medicamentos críticos
-struct StockMedicamento
+// Errores tolerados en una palabra de la consulta segun su largo
+static int erroresPermitidos(size_t largo)
 {
-    string nombre;
-    int cantidad;
-    int umbralMinimo;
+    return largo < 4 ? 0 : (largo < 8 ? 1 : 2);
+}
+
+struct ResultadoNombre
+{
+    const Paciente* paciente;
+    int distancia;          // 0: todas las palabras coinciden como prefijo
+    int palabrasCompletas;  // palabras de la consulta que coinciden enteras
 };
 
-class InventarioMedicamentos
+class IndiceNombresPacientes
 {
 private:
-    map<string, StockMedicamento> inventario;
+    struct Entrada
+    {
+        uint32_t inicio;   // en palabrasPorPaciente
+        uint32_t cantidad;
+    };
 
-public:
-    void agregarTipoMedicamento(const string& nombre, int cantidadInicial, int umbralMinimo)
+    // Palabra del vocabulario aceptada para una palabra de la consulta
+    struct Alternativa
     {
-        inventario[nombre] = { nombre, cantidadInicial, umbralMinimo };
+        uint32_t palabra;
+        int distancia;
+    };
+
+    // Palabras de la consulta ya resueltas contra el vocabulario
+    struct Termino
+    {
+        string_view texto;
+        vector<Alternativa> alternativas; // ordenadas por id de palabra
+        size_t pacientes = 0;             // largo total de sus listas
+        bool amplio = false;              // demasiadas palabras con ese prefijo: solo se verifica
+    };
+
+    deque<string> textos; // deque: las vistas de los mapas no se invalidan al crecer
+    unordered_map<string_view, uint32_t> idPorTexto;
+    map<string_view, uint32_t> ordenadas; // para enumerar las palabras con un prefijo
+    vector<vector<uint32_t>> pacientesDePalabra;
+    vector<vector<uint32_t>> palabrasDeTrigrama;
+    vector<vector<uint32_t>> palabrasDeBigrama;
+    vector<Entrada> entradas; // por posicion en tablaPacientes
+    vector<uint32_t> palabrasPorPaciente;
+
+    uint32_t idPalabra(string_view palabra)
+    {
+        auto it = idPorTexto.find(palabra);
+        if (it != idPorTexto.end())
+            return it->second;
+        uint32_t id = static_cast<uint32_t>(textos.size());
+        textos.emplace_back(palabra);
+        string_view guardada = textos.back();
+        idPorTexto.emplace(guardada, id);
+        ordenadas.emplace(guardada, id);
+        pacientesDePalabra.emplace_back();
+        vector<uint32_t> gramas;
+        trigramasDe({ guardada }, gramas);
+        for (uint32_t t : gramas)
+            palabrasDeTrigrama[t].push_back(id);
+        bigramasDe(guardada, gramas);
+        for (uint32_t b : gramas)
+            palabrasDeBigrama[b].push_back(id);
+        return id;
     }
 
-    bool consumir(const string& nombre, int cantidad)
+    static void agregarOrdenado(vector<uint32_t>& lista, uint32_t valor)
     {
-        auto it = inventario.find(nombre);
-        if (it == inventario.end())
-        {
-            cout << "[ALERTA] Medicamento '" << nombre << "' no registrado.\n";
-            return false;
-        }
-        if (cantidad > it->second.cantidad)
+        if (lista.empty() || lista.back() < valor)
+            lista.push_back(valor);
+        else
         {
-            cout << "[ALERTA] Stock insuficiente de '" << nombre
-                << "'. Solicitado: " << cantidad
-                << ", disponible: " << it->second.cantidad << "\n";
-            return false;
+            auto it = lower_bound(lista.begin(), lista.end(), valor);
+            if (it == lista.end() || *it != valor)
+                lista.insert(it, valor);
         }
-        it->second.cantidad -= cantidad;
-        if (it->second.cantidad < it->second.umbralMinimo)
+    }
+
+    // Palabras del vocabulario que empiezan con 'prefijo'; false si hay mas de 'limite'
+    bool conPrefijo(string_view prefijo, size_t limite, vector<Alternativa>& salida) const
+    {
+        for (auto it = ordenadas.lower_bound(prefijo); it != ordenadas.end(); ++it)
         {
-            cout << "[ALERTA CRITICA] Stock bajo de '" << nombre
-                << "'. Cantidad actual: " << it->second.cantidad << "\n";
+            if (it->first.compare(0, prefijo.size(), prefijo) != 0)
+                break;
+            if (salida.size() >= limite)
+                return false;
+            salida.push_back({ it->second, 0 });
         }
         return true;
     }
 
-    void reabastecer(const string& nombre, int cantidad)
+    /*
+     * Palabras a distancia de prefijo 1..d: union de las 4d+1 listas de trigramas
+     * mas cortas, o de las 3d+1 de bigramas si la palabra tiene pocos trigramas.
+     * Si tampoco hay bigramas suficientes (pocas letras distintas, p. ej. "anana")
+     * se revisa todo el vocabulario.
+     */
+    void cercanas(string_view palabra, int d, vector<Alternativa>& salida) const
     {
-        auto it = inventario.find(nombre);
-        if (it == inventario.end())
+        vector<uint32_t> gramas;
+        const vector<vector<uint32_t>>* listas = &palabrasDeTrigrama;
+        size_t necesarias = static_cast<size_t>(4 * d + 1);
+        trigramasDe({ palabra }, gramas);
+        if (gramas.size() < necesarias)
         {
-            // si no existe, se crea con umbral por defecto
-            inventario[nombre] = { nombre, cantidad, max(1, cantidad / 4) };
+            listas = &palabrasDeBigrama;
+            necesarias = static_cast<size_t>(3 * d + 1);
+            bigramasDe(palabra, gramas);
+        }
+        vector<uint32_t> candidatas;
+        if (gramas.size() < necesarias)
+        {
+            candidatas.resize(textos.size());
+            for (uint32_t id = 0; id < candidatas.size(); ++id)
+                candidatas[id] = id;
         }
         else
         {
-            it->second.cantidad += cantidad;
+            sort(gramas.begin(), gramas.end(),
+                 [listas](uint32_t a, uint32_t b) { return (*listas)[a].size() < (*listas)[b].size(); });
+            gramas.resize(necesarias);
+            for (uint32_t g : gramas)
+                candidatas.insert(candidatas.end(), (*listas)[g].begin(), (*listas)[g].end());
+            sort(candidatas.begin(), candidatas.end());
+            candidatas.erase(unique(candidatas.begin(), candidatas.end()), candidatas.end());
+        }
+        for (uint32_t id : candidatas)
+        {
+            const string& texto = textos[id];
+            if (texto.compare(0, palabra.size(), palabra) == 0)
+                continue; // ya esta como prefijo exacto
+            int dist = distanciaPrefijo(palabra, texto, d);
+            if (dist <= d)
+                salida.push_back({ id, dist });
         }
-        cout << "[INFO] Nuevo stock de '" << nombre
-            << "': " << inventario[nombre].cantidad << "\n";
     }
 
-    void reporte() const
+    /**
+     * Distancia total del paciente a la consulta (cada termino contra la mejor
+     * de sus palabras) o -1 si algun termino no coincide.
+     */
+    int verificar(const vector<Termino>& terminos, uint32_t posicion, int& completas) const
     {
-        cout << "=== INVENTARIO DE MEDICAMENTOS CRITICOS ===\n";
-        for (const auto& kv : inventario)
+        if (posicion >= entradas.size())
+            return -1;
+        const Entrada& e = entradas[posicion];
+        const uint32_t* palabras = palabrasPorPaciente.data() + e.inicio;
+        int total = 0;
+        completas = 0;
+        for (const Termino& t : terminos)
         {
-            const auto& m = kv.second;
-            cout << " - " << m.nombre
-                << " | Cant: " << m.cantidad
-                << " | Umbral min: " << m.umbralMinimo << "\n";
+            int mejor = INT32_MAX;
+            bool completa = false;
+            for (uint32_t i = 0; i < e.cantidad; ++i)
+            {
+                const string& texto = textos[palabras[i]];
+                int d = INT32_MAX;
+                if (texto.compare(0, t.texto.size(), t.texto) == 0)
+                    d = 0;
+                else if (!t.amplio)
+                {
+                    auto it = lower_bound(t.alternativas.begin(), t.alternativas.end(), palabras[i],
+                                          [](const Alternativa& a, uint32_t id) { return a.palabra < id; });
+                    if (it != t.alternativas.end() && it->palabra == palabras[i])
+                        d = it->distancia;
+                }
+                if (d < mejor || (d == mejor && d == 0 && texto.size() == t.texto.size()))
+                {
+                    mejor = d;
+                    completa = (d == 0 && texto.size() == t.texto.size());
+                }
+            }
+            if (mejor == INT32_MAX)
+                return -1;
+            total += mejor;
+            completas += completa;
         }
-        cout << "===========================================\n";
+        return total;
     }
-};
 
-// Gestor de recursos hospitalarios (UCI, ventiladores, meds)
-class GestorRecursosHospitalarios
-{
-private:
-    int totalCamasUCI;
-    int camasOcupadas;
+    /**
+     * Recorre, de la posicion mayor a la menor, la union de las listas de las
+     * alternativas del termino 'guia' y entrega cada paciente a 'visitar'
+     * (que devuelve false para cortar). Explora como mucho 'limite' pacientes.
+     */
+    template <typename Visitar>
+    void recorrerUnion(const Termino& guia, size_t limite, Visitar visitar) const
+    {
+        // (posicion, lista, indice) en un heap de maximos
+        using Cursor = tuple<uint32_t, uint32_t, size_t>;
+        vector<Cursor> heap;
+        for (const Alternativa& a : guia.alternativas)
+        {
+            const vector<uint32_t>& l = pacientesDePalabra[a.palabra];
+            if (!l.empty())
+                heap.emplace_back(l.back(), a.palabra, l.size() - 1);
+        }
+        make_heap(heap.begin(), heap.end());
+        long long anterior = -1;
+        while (!heap.empty() && limite > 0)
+        {
+            pop_heap(heap.begin(), heap.end());
+            Cursor& c = heap.back();
+            uint32_t pos = get<0>(c);
+            if (get<2>(c) > 0)
+            {
+                size_t i = --get<2>(c);
+                get<0>(c) = pacientesDePalabra[get<1>(c)][i];
+                push_heap(heap.begin(), heap.end());
+            }
+            else
+                heap.pop_back();
+            if (static_cast<long long>(pos) == anterior)
+                continue;
+            anterior = pos;
+            limite--;
+            if (!visitar(pos))
+                return;
+        }
+    }
+
+public:
+    IndiceNombresPacientes()
+        : palabrasDeTrigrama(SIMBOLOS_TRIGRAMA * SIMBOLOS_TRIGRAMA * SIMBOLOS_TRIGRAMA),
+          palabrasDeBigrama(SIMBOLOS_TRIGRAMA * SIMBOLOS_TRIGRAMA)
+    {
+    }
+
+    void limpiar()
+    {
+        textos.clear();
+        idPorTexto.clear();
+        ordenadas.clear();
+        pacientesDePalabra.clear();
+        for (auto& l : palabrasDeTrigrama)
+            vector<uint32_t>().swap(l);
+        for (auto& l : palabrasDeBigrama)
+            vector<uint32_t>().swap(l);
+        entradas.clear();
+        palabrasPorPaciente.clear();
+    }
+
+    // Alta incremental; si la posicion se reindexa (cambio de nombre) las listas viejas se descartan al verificar
+    void agregar(uint32_t posicion, const string& nombre)
+    {
+        string normalizado = normalizarNombre(nombre);
+        vector<uint32_t> ids;
+        for (string_view p : palabrasDe(normalizado))
+            ids.push_back(idPalabra(p));
+        sort(ids.begin(), ids.end());
+        ids.erase(unique(ids.begin(), ids.end()), ids.end());
+        if (entradas.size() <= posicion)
+            entradas.resize(static_cast<size_t>(posicion) + 1, Entrada{ 0, 0 });
+        entradas[posicion] = { static_cast<uint32_t>(palabrasPorPaciente.size()), static_cast<uint32_t>(ids.size()) };
+        palabrasPorPaciente.insert(palabrasPorPaciente.end(), ids.begin(), ids.end());
+        for (uint32_t id : ids)
+            agregarOrdenado(pacientesDePalabra[id], posicion);
+    }
+
+    void reconstruir(const TablaPacientes& tabla)
+    {
+        limpiar();
+        entradas.reserve(tabla.size());
+        palabrasPorPaciente.reserve(tabla.size() * 4);
+        uint32_t posicion = 0;
+        for (const Paciente& p : tabla)
+            agregar(posicion++, p.nombreCompleto);
+    }
+
+    /**
+     * Hasta k pacientes cuyo nombre contiene, como prefijos de palabra, las
+     * palabras de la consulta ("carl qui" -> "Carlos Quispe"). Si no alcanzan,
+     * completa con coincidencias con errores de tipeo. Los exactos van primero,
+     * luego los de menor distancia; a igualdad, los mas recientes.
+     */
+    vector<ResultadoNombre> buscar(const string& consulta, size_t k, const TablaPacientes& tabla) const
+    {
+        vector<ResultadoNombre> resultados;
+        string normalizada = normalizarNombre(consulta);
+        vector<Termino> terminos;
+        for (string_view p : palabrasDe(normalizada))
+        {
+            Termino t;
+            t.texto = p;
+            t.amplio = p.size() < 2 || !conPrefijo(p, LIMITE_PALABRAS_PREFIJO, t.alternativas);
+            terminos.push_back(std::move(t));
+        }
+        if (terminos.empty() || k == 0)
+            return resultados;
+
+        vector<uint32_t> vistos;
+        for (int fase = 0; fase < 2 && resultados.size() < k; ++fase)
+        {
+            bool difusa = (fase == 1);
+            if (difusa)
+            {
+                bool alguno = false;
+                for (Termino& t : terminos)
+                {
+                    int d = erroresPermitidos(t.texto.size());
+                    if (t.amplio || d == 0)
+                        continue;
+                    cercanas(t.texto, d, t.alternativas);
+                    alguno = true;
+                }
+                if (!alguno)
+                    break;
+            }
+            // El termino con menos pacientes guia el recorrido; los demas solo se verifican
+            const Termino* guia = nullptr;
+            for (Termino& t : terminos)
+            {
+                if (t.amplio)
+                    continue;
+                sort(t.alternativas.begin(), t.alternativas.end(),
+                     [](const Alternativa& a, const Alternativa& b) { return a.palabra < b.palabra; });
+                t.pacientes = 0;
+                for (const Alternativa& a : t.alternativas)
+                    t.pacientes += pacientesDePalabra[a.palabra].size();
+                if (!guia || t.pacientes < guia->pacientes)
+                    guia = &t;
+            }
+            if (!guia && difusa)
+                break; // solo terminos de una letra o demasiado generales
+
+            sort(vistos.begin(), vistos.end());
+            vector<ResultadoNombre> cercanos;
+            size_t faltan = k - resultados.size(), conUnError = 0;
+            auto visitar = [&](uint32_t pos)
+            {
+                int completas;
+                int d = verificar(terminos, pos, completas);
+                if (d < 0 || pos >= tabla.size() || binary_search(vistos.begin(), vistos.end(), pos))
+                    return true;
+                if (!difusa)
+                {
+                    resultados.push_back({ &tabla.enPosicion(pos), 0, completas });
+                    vistos.push_back(pos);
+                    return resultados.size() < k;
+                }
+                // Los exactos ya salieron en la fase 0: nada baja de distancia 1, asi que
+                // al juntar los que faltan con distancia 1 ya se tiene el top-k
+                cercanos.push_back({ &tabla.enPosicion(pos), d, completas });
+                conUnError += (d == 1);
+                return conUnError < faltan;
+            };
+            if (guia)
+                recorrerUnion(*guia, LIMITE_CANDIDATOS_NOMBRE, visitar);
+            else
+            {
+                // Ningun termino acota (p.ej. "a"): se verifican los pacientes mas recientes
+                size_t limite = min(entradas.size(), LIMITE_CANDIDATOS_NOMBRE);
+                for (size_t i = 0; i < limite; ++i)
+                    if (!visitar(static_cast<uint32_t>(entradas.size() - 1 - i)))
+                        break;
+            }
+            stable_sort(cercanos.begin(), cercanos.end(),
+                        [](const ResultadoNombre& a, const ResultadoNombre& b) { return a.distancia < b.distancia; });
+            for (size_t i = 0; i < cercanos.size() && resultados.size() < k; ++i)
+                resultados.push_back(cercanos[i]);
+        }
+
+        stable_sort(resultados.begin(), resultados.end(), [](const ResultadoNombre& a, const ResultadoNombre& b)
+                    { return a.distancia != b.distancia ? a.distancia < b.distancia : a.palabrasCompletas > b.palabrasCompletas; });
+        return resultados;
+    }
+
+    size_t palabrasDistintas() const
+    {
+        return textos.size();
+    }
+
+    size_t bytesUsados() const
+    {
+        size_t bytes = (palabrasDeTrigrama.capacity() + palabrasDeBigrama.capacity()) * sizeof(vector<uint32_t>) +
+                       pacientesDePalabra.capacity() * sizeof(vector<uint32_t>) +
+                       entradas.capacity() * sizeof(Entrada) + palabrasPorPaciente.capacity() * sizeof(uint32_t);
+        for (const auto& l : palabrasDeTrigrama)
+            bytes += l.capacity() * sizeof(uint32_t);
+        for (const auto& l : palabrasDeBigrama)
+            bytes += l.capacity() * sizeof(uint32_t);
+        for (const auto& l : pacientesDePalabra)
+            bytes += l.capacity() * sizeof(uint32_t);
+        for (const string& s : textos)
+            bytes += sizeof(string) + s.capacity() + 1 + 2 * (sizeof(string_view) + sizeof(uint32_t) + 2 * sizeof(void*));
+        return bytes;
+    }
+};
+
+IndiceNombresPacientes indiceNombres;
+
+// Tipo de alias para el comparador de ordenamiento
+using CitaComparator = function<bool(const Cita&, const Cita&)>;
+
+// Comparador Global: Prioridad (menor es más urgente) > Fecha > Hora (RF01.1)
+CitaComparator globalComparator = [](const Cita& a, const Cita& b)
+    {
+        if (a.prioridad != b.prioridad)
+        {
+            return a.prioridad < b.prioridad;
+        }
+        if (a.fecha != b.fecha)
+        {
+            return a.fecha < b.fecha;
+        }
+        return a.hora < b.hora;
+    };
+
+// --- 3. ALGORITMOS DE ORDENAMIENTO (Quick Sort y Merge Sort) ---
+
+// Particiones con a lo mas este numero de citas se terminan con insercion directa
+const int UMBRAL_INSERCION = 16;
+// A partir de este tamaño el pivote se elige con ninther (mediana de medianas de tres)
+const int UMBRAL_NINTHER = 128;
+
+/*
+ * Instrumentacion de --comparar-ordenamiento. Compilando con -DMEDIR_ORDENAMIENTOS
+ * los ordenamientos cuentan sus movimientos y el operator new global cuenta las
+ * reservas de cada hilo; sin la opcion, la agenda se ordena sin contadores ni
+ * reemplazo del allocator y el benchmark informa esas columnas como -1.
+ */
+#ifdef MEDIR_ORDENAMIENTOS
+#define CONTAR_ORDEN(sentencia) sentencia
+#else
+#define CONTAR_ORDEN(sentencia)
+#endif
+
+// Estadisticas acumuladas de Quick Sort (las reinicia quien mide, p. ej. --comparar-ordenamiento)
+struct EstadisticasQuickSort
+{
+    long long movimientos = 0;   // un swap cuenta como 3 movimientos
+    long long particiones = 0;
+    long long respaldosHeap = 0; // tramos resueltos con Heap Sort (sus movimientos no se cuentan)
+};
+
+EstadisticasQuickSort estadisticasQuickSort;
+
+// Devuelve el indice de la mediana entre arr[a], arr[b] y arr[c]
+int medianaDeTres(const vector<Cita>& arr, int a, int b, int c, const CitaComparator& comp)
+{
+    if (comp(arr[a], arr[b]))
+    {
+        if (comp(arr[b], arr[c]))
+            return b;
+        return comp(arr[a], arr[c]) ? c : a;
+    }
+    if (comp(arr[a], arr[c]))
+        return a;
+    return comp(arr[b], arr[c]) ? c : b;
+}
+
+// Insercion directa sobre [low, high], estable y muy rapida en tramos pequeños
+void insercionCitas(vector<Cita>& arr, int low, int high, const CitaComparator& comp)
+{
+    for (int i = low + 1; i <= high; ++i)
+    {
+        if (!comp(arr[i], arr[i - 1]))
+            continue;
+        Cita actual = std::move(arr[i]);
+        int j = i;
+        do
+        {
+            arr[j] = std::move(arr[j - 1]);
+            --j;
+        } while (j > low && comp(actual, arr[j - 1]));
+        arr[j] = std::move(actual);
+        CONTAR_ORDEN(estadisticasQuickSort.movimientos += (i - j) + 2);
+    }
+}
+
+// Heap Sort sobre [low, high]: respaldo O(n log n) cuando la recursion se degrada
+void heapSortCitas(vector<Cita>& arr, int low, int high, const CitaComparator& comp)
+{
+    auto inicio = arr.begin() + low;
+    auto fin = arr.begin() + high + 1;
+    make_heap(inicio, fin, comp);
+    sort_heap(inicio, fin, comp);
+}
+
+/**
+ * Partición de Hoare (Necesaria para Quick Sort).
+ * El pivote es la mediana de tres (o ninther en tramos grandes), por lo que una
+ * agenda ya ordenada o invertida se divide por la mitad en lugar de degenerar.
+ * Los iguales al pivote se reparten a ambos lados (prioridades repetidas).
+ */
+int particion(vector<Cita>& arr, int low, int high, const CitaComparator& comp)
+{
+    int n = high - low + 1;
+    int mid = low + n / 2;
+    int idxPivote;
+    if (n > UMBRAL_NINTHER)
+    {
+        int paso = n / 8;
+        int m1 = medianaDeTres(arr, low, low + paso, low + 2 * paso, comp);
+        int m2 = medianaDeTres(arr, mid - paso, mid, mid + paso, comp);
+        int m3 = medianaDeTres(arr, high - 2 * paso, high - paso, high, comp);
+        idxPivote = medianaDeTres(arr, m1, m2, m3, comp);
+    }
+    else
+    {
+        idxPivote = medianaDeTres(arr, low, mid, high, comp);
+    }
+    swap(arr[low], arr[idxPivote]);
+    CONTAR_ORDEN(long long swaps = 2); // el del pivote y el final
+
+    const Cita& pivot = arr[low]; // no se mueve durante el barrido
+    int i = low, j = high + 1;
+    while (true)
+    {
+        while (comp(arr[++i], pivot))
+            if (i == high)
+                break;
+        while (comp(pivot, arr[--j]))
+            if (j == low)
+                break;
+        if (i >= j)
+            break;
+        swap(arr[i], arr[j]);
+        CONTAR_ORDEN(swaps++);
+    }
+    swap(arr[low], arr[j]);
+    CONTAR_ORDEN(estadisticasQuickSort.movimientos += 3 * swaps);
+    CONTAR_ORDEN(estadisticasQuickSort.particiones++);
+    return j;
+}
+
+/**
+ * Quick Sort (introsort): Ordenamiento rápido, útil para ordenar citas por fecha o prioridad.
+ * Pila explícita (profundidad O(log n)), insercion en tramos pequeños y Heap Sort
+ * si la profundidad supera 2*log2(n).
+ * Complejidad: O(n log n) en el peor caso.
+ */
+void quickSort(vector<Cita>& arr, int low, int high, const CitaComparator& comp)
+{
+    if (low >= high)
+        return;
+
+    struct Tramo
+    {
+        int low;
+        int high;
+        int profundidadRestante;
+    };
+
+    int limite = 0;
+    for (int n = high - low + 1; n > 1; n >>= 1)
+        limite += 2;
+
+    vector<Tramo> pila;
+    pila.push_back({ low, high, limite });
+    while (!pila.empty())
+    {
+        Tramo t = pila.back();
+        pila.pop_back();
+
+        while (t.high - t.low + 1 > UMBRAL_INSERCION)
+        {
+            if (t.profundidadRestante == 0)
+            {
+                heapSortCitas(arr, t.low, t.high, comp);
+                CONTAR_ORDEN(estadisticasQuickSort.respaldosHeap++);
+                t.high = t.low; // tramo ya resuelto
+                break;
+            }
+            t.profundidadRestante--;
+
+            int pi = particion(arr, t.low, t.high, comp);
+            // Se apila el lado mayor y se continua con el menor
+            if (pi - t.low < t.high - pi)
+            {
+                pila.push_back({ pi + 1, t.high, t.profundidadRestante });
+                t.high = pi - 1;
+            }
+            else
+            {
+                pila.push_back({ t.low, pi - 1, t.profundidadRestante });
+                t.low = pi + 1;
+            }
+        }
+        if (t.low < t.high)
+            insercionCitas(arr, t.low, t.high, comp);
+    }
+}
+
+// Estadisticas de la ultima ejecucion de Merge Sort
+struct EstadisticasMergeSort
+{
+    long long comparaciones = 0;
+    long long movimientos = 0;
+    long long fusiones = 0;
+    long long asignaciones = 0; // reservas del buffer auxiliar (0 si se reutilizo)
+};
+
+// Tramos iniciales que se ordenan por insercion antes de empezar a fusionar
+const size_t TAMANO_TRAMO_INICIAL = 16;
+
+/**
+ * Aplica una permutacion in situ: la posicion i recibe arr[origen[i]].
+ * Sigue ciclos, por lo que cada elemento se mueve exactamente una vez.
+ * 'origen' queda como la identidad al terminar. Devuelve los movimientos hechos.
+ */
+size_t aplicarPermutacion(vector<Cita>& arr, vector<uint32_t>& origen)
+{
+    size_t movimientos = 0;
+    for (size_t i = 0; i < origen.size(); ++i)
+    {
+        if (origen[i] == i)
+            continue;
+        Cita temporal = std::move(arr[i]);
+        size_t j = i;
+        while (origen[j] != i)
+        {
+            size_t k = origen[j];
+            arr[j] = std::move(arr[k]);
+            origen[j] = static_cast<uint32_t>(j);
+            j = k;
+            movimientos++;
+        }
+        arr[j] = std::move(temporal);
+        origen[j] = static_cast<uint32_t>(j);
+        movimientos += 2;
+    }
+    return movimientos;
+}
+
+/**
+ * Merge Sort ascendente (bottom-up) sin recursion ni reservas por fusion.
+ * Usa un unico buffer auxiliar que se conserva entre ordenamientos y alterna
+ * origen/destino en cada pasada (ping-pong), moviendo las citas en lugar de
+ * copiarlas. Tambien puede ordenar solo una permutacion de indices de 32 bits
+ * y aplicarla al final, evitando mover los structs completos en cada pasada.
+ */
+class MotorMergeSort
+{
+private:
+    vector<Cita> bufferCitas;
+    vector<uint32_t> bufferIndices;
+    EstadisticasMergeSort stats;
+
+    template <typename T>
+    void asegurarCapacidad(vector<T>& buffer, size_t n)
+    {
+        if (buffer.size() < n)
+        {
+            buffer.resize(n);
+            stats.asignaciones++;
+        }
+    }
+
+    template <typename T, typename Menor>
+    bool comparar(Menor& menor, const T& a, const T& b)
+    {
+        CONTAR_ORDEN(stats.comparaciones++);
+        return menor(a, b);
+    }
+
+    // Insercion estable sobre [l, r)
+    template <typename T, typename Menor>
+    void insercionTramo(T* a, size_t l, size_t r, Menor& menor)
+    {
+        for (size_t i = l + 1; i < r; ++i)
+        {
+            if (!comparar(menor, a[i], a[i - 1]))
+                continue;
+            T actual = std::move(a[i]);
+            size_t j = i;
+            do
+            {
+                a[j] = std::move(a[j - 1]);
+                CONTAR_ORDEN(stats.movimientos++);
+                --j;
+            } while (j > l && comparar(menor, actual, a[j - 1]));
+            a[j] = std::move(actual);
+            CONTAR_ORDEN(stats.movimientos += 2);
+        }
+    }
+
+    // Fusiona origen[l, m) y origen[m, r) en destino[l, r). Estable: en empate gana la izquierda.
+    template <typename T, typename Menor>
+    void fusionar(T* origen, T* destino, size_t l, size_t m, size_t r, Menor& menor)
+    {
+        size_t i = l, j = m, k = l;
+        while (i < m && j < r)
+        {
+            if (comparar(menor, origen[j], origen[i]))
+                destino[k++] = std::move(origen[j++]);
+            else
+                destino[k++] = std::move(origen[i++]);
+        }
+        while (i < m)
+            destino[k++] = std::move(origen[i++]);
+        while (j < r)
+            destino[k++] = std::move(origen[j++]);
+        CONTAR_ORDEN(stats.movimientos += static_cast<long long>(r - l));
+        CONTAR_ORDEN(stats.fusiones++);
+    }
+
+    template <typename T, typename Menor>
+    void ordenarTramo(T* datos, T* auxiliar, size_t n, Menor menor)
+    {
+        for (size_t l = 0; l < n; l += TAMANO_TRAMO_INICIAL)
+            insercionTramo(datos, l, min(l + TAMANO_TRAMO_INICIAL, n), menor);
+
+        T* origen = datos;
+        T* destino = auxiliar;
+        for (size_t ancho = TAMANO_TRAMO_INICIAL; ancho < n; ancho *= 2)
+        {
+            for (size_t l = 0; l < n; l += 2 * ancho)
+            {
+                size_t m = min(l + ancho, n);
+                size_t r = min(l + 2 * ancho, n);
+                if (m == r)
+                {
+                    for (size_t k = l; k < r; ++k) // tramo sin pareja: solo se traslada
+                        destino[k] = std::move(origen[k]);
+                    CONTAR_ORDEN(stats.movimientos += static_cast<long long>(r - l));
+                }
+                else
+                {
+                    fusionar(origen, destino, l, m, r, menor);
+                }
+            }
+            swap(origen, destino);
+        }
+        if (origen != datos)
+        {
+            for (size_t k = 0; k < n; ++k)
+                datos[k] = std::move(origen[k]);
+            CONTAR_ORDEN(stats.movimientos += static_cast<long long>(n));
+        }
+    }
+
+public:
+    // Ordena arr[l..r] (inclusive) moviendo las citas
+    void ordenar(vector<Cita>& arr, int l, int r, const CitaComparator& comp)
+    {
+        stats = EstadisticasMergeSort();
+        if (l >= r)
+            return;
+        size_t n = static_cast<size_t>(r - l + 1);
+        asegurarCapacidad(bufferCitas, n);
+        ordenarTramo(arr.data() + l, bufferCitas.data(), n, comp);
+    }
+
+    // Ordena una permutacion de indices (arr no se modifica): perm[i] = indice de la i-esima cita
+    void ordenarIndices(const vector<Cita>& arr, vector<uint32_t>& perm, const CitaComparator& comp)
+    {
+        stats = EstadisticasMergeSort();
+        perm.resize(arr.size());
+        for (size_t i = 0; i < perm.size(); ++i)
+            perm[i] = static_cast<uint32_t>(i);
+        if (perm.size() < 2)
+            return;
+        asegurarCapacidad(bufferIndices, perm.size());
+        auto menor = [&arr, &comp](uint32_t a, uint32_t b) { return comp(arr[a], arr[b]); };
+        ordenarTramo(perm.data(), bufferIndices.data(), perm.size(), menor);
+    }
+
+    // Ordena por indices y aplica la permutacion una sola vez al final
+    void ordenarPorIndices(vector<Cita>& arr, const CitaComparator& comp)
+    {
+        vector<uint32_t> perm;
+        ordenarIndices(arr, perm, comp);
+        stats.movimientos += static_cast<long long>(aplicarPermutacion(arr, perm)); // una suma por ordenamiento
+    }
+
+    const EstadisticasMergeSort& estadisticas() const
+    {
+        return stats;
+    }
+
+    // Libera los buffers auxiliares (p. ej. tras consolidar una agenda masiva)
+    void liberarBuffers()
+    {
+        vector<Cita>().swap(bufferCitas);
+        vector<uint32_t>().swap(bufferIndices);
+    }
+};
+
+// Motor compartido: el buffer auxiliar se reutiliza entre ordenamientos
+MotorMergeSort motorMergeSort;
+
+/**
+ * Merge Sort: Ordenamiento estable, ideal para consolidar citas de múltiples clínicas.
+ * Complejidad: O(n log n), memoria auxiliar O(n) reservada una sola vez.
+ */
+void mergeSort(vector<Cita>& arr, int l, int r, const CitaComparator& comp)
+{
+    motorMergeSort.ordenar(arr, l, r, comp);
+}
+
+// --- 3B. CLAVE EMPAQUETADA DE 64 BITS Y RADIX SORT ---
+
+/*
+ * Distribucion de bits de Cita::claveOrden (de mayor a menor peso):
+ *   [63..61] prioridad (3 bits)
+ *   [60..41] dias desde 1970-01-01 (20 bits)
+ *   [40..30] minuto del dia (11 bits)
+ *   [29..0]  secuencia de ingesta (30 bits, desempate estable)
+ * Comparar claves como enteros equivale a globalComparator sobre fechas
+ * "YYYY-MM-DD" y horas "HH:MM"; los valores no parseables ("N/A") toman el
+ * maximo del campo, igual que quedarian al final comparando strings. Tambien
+ * lo toman las fechas imposibles (2025-02-30) y las que no entran en el campo:
+ * no se admiten fechas anteriores a 1970-01-01 (el indice temporal cuenta
+ * minutos desde entonces) ni posteriores al dia MAX_DIA - 1 (año 4840).
+ * La prioridad ya llega validada (1..5, ver prioridadValida). La secuencia no
+ * se deja desbordar: al agotarse se renumeran las claves vivas (agenda y lista
+ * de espera) conservando su orden, asi el desempate sigue siendo estable.
+ */
+const int BITS_SECUENCIA = 30;
+const int BITS_MINUTO = 11;
+const int BITS_DIA = 20;
+const uint64_t MAX_SECUENCIA = (1ULL << BITS_SECUENCIA) - 1;
+const uint64_t MAX_MINUTO = (1ULL << BITS_MINUTO) - 1;
+const uint64_t MAX_DIA = (1ULL << BITS_DIA) - 1;
+
+static_assert(PRIORIDAD_MAS_BAJA < 8, "la prioridad ocupa 3 bits de claveOrden");
+
+uint32_t contadorIngestaCitas = 0;
+
+void renumerarSecuenciasIngesta(); // seccion 3D, necesita la agenda y la lista de espera
+
+static bool leerDigitos(const string& s, size_t pos, size_t n, int& valor)
+{
+    valor = 0;
+    for (size_t i = pos; i < pos + n; ++i)
+    {
+        if (i >= s.size() || s[i] < '0' || s[i] > '9')
+            return false;
+        valor = valor * 10 + (s[i] - '0');
+    }
+    return true;
+}
+
+static int diasDelMes(int y, int m)
+{
+    static const int DIAS[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    bool bisiesto = (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+    return m == 2 && bisiesto ? 29 : DIAS[m - 1];
+}
+
+// Dias desde 1970-01-01 para una fecha "YYYY-MM-DD" (calendario gregoriano proleptico);
+// MAX_DIA si es malformada, imposible o esta fuera de [1970-01-01, MAX_DIA - 1]
+uint64_t diasDesdeEpoca(const string& fecha)
+{
+    int y, m, d;
+    if (fecha.size() != 10 || fecha[4] != '-' || fecha[7] != '-' ||
+        !leerDigitos(fecha, 0, 4, y) || !leerDigitos(fecha, 5, 2, m) || !leerDigitos(fecha, 8, 2, d) ||
+        m < 1 || m > 12 || d < 1 || d > diasDelMes(y, m))
+        return MAX_DIA;
+
+    y -= m <= 2;
+    const int era = y / 400;
+    const int yoe = y - era * 400;
+    const int doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    long long dias = static_cast<long long>(era) * 146097 + doe - 719468;
+    if (dias < 0 || dias >= static_cast<long long>(MAX_DIA))
+        return MAX_DIA;
+    return static_cast<uint64_t>(dias);
+}
+
+// Minuto del dia para una hora "HH:MM"
+uint64_t minutoDelDia(const string& hora)
+{
+    int h, m;
+    if (hora.size() != 5 || hora[2] != ':' || !leerDigitos(hora, 0, 2, h) || !leerDigitos(hora, 3, 2, m) ||
+        h > 23 || m > 59)
+        return MAX_MINUTO;
+    return static_cast<uint64_t>(h * 60 + m);
+}
+
+// Instante entero (minutos desde 1970-01-01 00:00) para el indice temporal (seccion 2B)
+bool instanteDe(const string& fecha, const string& hora, uint32_t& instante)
+{
+    uint64_t dia = diasDesdeEpoca(fecha);
+    uint64_t minuto = minutoDelDia(hora);
+    if (dia == MAX_DIA || minuto == MAX_MINUTO)
+        return false;
+    instante = static_cast<uint32_t>(dia * 24 * 60 + minuto);
+    return true;
+}
+
+uint64_t empaquetarClaveCita(const Cita& c, uint64_t secuencia)
+{
+    uint64_t prioridad = static_cast<uint64_t>(c.prioridad) & 7;
+    return (prioridad << (BITS_DIA + BITS_MINUTO + BITS_SECUENCIA)) |
+           (diasDesdeEpoca(c.fecha) << (BITS_MINUTO + BITS_SECUENCIA)) |
+           (minutoDelDia(c.hora) << BITS_SECUENCIA) |
+           (secuencia & MAX_SECUENCIA);
+}
+
+// Se llama al ingresar una cita al sistema (carga, importacion, generacion)
+void asignarClaveOrden(Cita& c)
+{
+    if (contadorIngestaCitas > MAX_SECUENCIA)
+        renumerarSecuenciasIngesta();
+    c.claveOrden = empaquetarClaveCita(c, contadorIngestaCitas++);
+}
+
+/**
+ * Radix Sort LSD por bytes sobre pares (clave, indice), sin comparaciones de strings.
+ * Los bytes en los que todas las claves coinciden se omiten (p. ej. prioridad y
+ * fecha en una agenda de un solo dia). La permutacion resultante se aplica una
+ * sola vez al final siguiendo ciclos, moviendo cada Cita exactamente una vez.
+ * Complejidad: O(n * bytes utiles), estable. Devuelve los movimientos de citas.
+ */
+size_t radixSortCitas(vector<Cita>& arr)
+{
+    const size_t n = arr.size();
+    if (n < 2)
+        return 0;
+
+    struct ParClave
+    {
+        uint64_t clave;
+        uint32_t indice;
+    };
+    vector<ParClave> pares(n), auxiliar(n);
+    size_t histogramas[8][256] = {};
+    for (size_t i = 0; i < n; ++i)
+    {
+        uint64_t k = arr[i].claveOrden;
+        pares[i] = { k, static_cast<uint32_t>(i) };
+        for (int b = 0; b < 8; ++b)
+            histogramas[b][(k >> (8 * b)) & 0xFF]++;
+    }
+
+    for (int b = 0; b < 8; ++b)
+    {
+        size_t* h = histogramas[b];
+        if (h[(pares[0].clave >> (8 * b)) & 0xFF] == n)
+            continue; // todas las claves comparten este byte
+
+        size_t offset = 0;
+        for (int d = 0; d < 256; ++d)
+        {
+            size_t c = h[d];
+            h[d] = offset;
+            offset += c;
+        }
+        for (size_t i = 0; i < n; ++i)
+            auxiliar[h[(pares[i].clave >> (8 * b)) & 0xFF]++] = pares[i];
+        pares.swap(auxiliar);
+    }
+
+    // Aplicar la permutacion: la posicion i debe recibir arr[pares[i].indice]
+    vector<uint32_t> origen(n);
+    for (size_t i = 0; i < n; ++i)
+        origen[i] = pares[i].indice;
+    vector<ParClave>().swap(auxiliar);
+    return aplicarPermutacion(arr, origen);
+}
+
+// --- 3C. FUSION K-WAY DE AGENDAS POR AREA (ARBOL DE PERDEDORES) ---
+
+/*
+ * Formato CSV de una cita (una por linea, sin encabezado):
+ *   idCita,idPaciente,idMedico,dniPaciente,nombreMedico,fecha,hora,especialidad,prioridad[,cancelada]
+ */
+/*
+ * Separa una linea CSV en vistas sobre la propia linea; devuelve cuantos campos
+ * leyo. Un campo entre comillas puede traer comas: la vista excluye las comillas
+ * externas pero conserva las internas duplicadas (asignarCampoCSV las deshace).
+ */
+size_t separarCamposCSV(string_view linea, string_view* campos, size_t maximo)
+{
+    if (!linea.empty() && linea.back() == '\r')
+        linea.remove_suffix(1);
+    size_t n = 0, inicio = 0;
+    while (n < maximo)
+    {
+        size_t coma;
+        if (inicio < linea.size() && linea[inicio] == '"')
+        {
+            size_t cierre = inicio + 1;
+            while ((cierre = linea.find('"', cierre)) != string_view::npos && cierre + 1 < linea.size() &&
+                   linea[cierre + 1] == '"')
+                cierre += 2;
+            if (cierre == string_view::npos) // comilla sin cerrar: el campo llega hasta el final
+            {
+                campos[n++] = linea.substr(inicio + 1);
+                break;
+            }
+            campos[n++] = linea.substr(inicio + 1, cierre - inicio - 1);
+            coma = linea.find(',', cierre + 1);
+        }
+        else
+        {
+            coma = linea.find(',', inicio);
+            campos[n++] = linea.substr(inicio, coma == string_view::npos ? string_view::npos : coma - inicio);
+        }
+        if (coma == string_view::npos)
+            break;
+        inicio = coma + 1;
+    }
+    return n;
+}
+
+// Copia un campo de texto leido con separarCamposCSV, reduciendo las comillas duplicadas
+void asignarCampoCSV(string& destino, string_view campo)
+{
+    destino.assign(campo.data(), campo.size());
+    for (size_t i = destino.find("\"\""); i != string::npos; i = destino.find("\"\"", i + 1))
+        destino.erase(i, 1);
+}
+
+// Escribe un campo de texto; va entre comillas (duplicando las internas) solo si trae comas o comillas
+void escribirCampoCSV(ostream& out, string_view campo)
+{
+    if (campo.find_first_of(",\"") == string_view::npos)
+    {
+        out << campo;
+        return;
+    }
+    out << '"';
+    for (char ch : campo)
+    {
+        if (ch == '"')
+            out << '"';
+        out << ch;
+    }
+    out << '"';
+}
+
+bool leerEnteroCSV(string_view campo, int& valor)
+{
+    auto r = from_chars(campo.data(), campo.data() + campo.size(), valor);
+    return r.ec == errc() && r.ptr == campo.data() + campo.size();
+}
+
+bool leerCitaCSV(string_view linea, Cita& c)
+{
+    string_view campos[10];
+    size_t n = separarCamposCSV(linea, campos, 10);
+    if (n < 9 || !leerEnteroCSV(campos[0], c.idCita) || !leerEnteroCSV(campos[1], c.idPaciente) ||
+        !leerEnteroCSV(campos[2], c.idMedico) || !leerEnteroCSV(campos[8], c.prioridad) ||
+        !idCitaValido(c.idCita) || !prioridadValida(c.prioridad))
+        return false;
+    c.dniPaciente.assign(campos[3].data(), campos[3].size());
+    asignarCampoCSV(c.nombreMedico, campos[4]);
+    c.fecha.assign(campos[5].data(), campos[5].size());
+    c.hora.assign(campos[6].data(), campos[6].size());
+    asignarCampoCSV(c.especialidad, campos[7]);
+    c.cancelada = (n == 10 && campos[9] == "1");
+    return true;
+}
+
+void escribirCitaCSV(ostream& out, const Cita& c)
+{
+    out << c.idCita << ',' << c.idPaciente << ',' << c.idMedico << ',' << c.dniPaciente << ',';
+    escribirCampoCSV(out, c.nombreMedico);
+    out << ',' << c.fecha << ',' << c.hora << ',';
+    escribirCampoCSV(out, c.especialidad);
+    out << ',' << c.prioridad << ',' << (c.cancelada ? 1 : 0) << '\n';
+}
+
+// Flujo de citas ya ordenadas de un area/clinica
+class FuenteCitas
+{
+public:
+    virtual ~FuenteCitas() {}
+    virtual bool siguiente(Cita& c) = 0; // false al agotarse
+};
+
+class FuenteVectorCitas : public FuenteCitas
+{
+private:
+    vector<Cita>& datos;
+    size_t pos;
+    bool mover;
+
+public:
+    // Con moverCitas = true las citas se trasladan fuera del vector en lugar de copiarse
+    FuenteVectorCitas(vector<Cita>& d, bool moverCitas = false) : datos(d), pos(0), mover(moverCitas) {}
+
+    bool siguiente(Cita& c) override
+    {
+        if (pos >= datos.size())
+            return false;
+        if (mover)
+            c = std::move(datos[pos++]);
+        else
+            c = datos[pos++];
+        return true;
+    }
+};
+
+class FuenteArchivoCitas : public FuenteCitas
+{
+private:
+    ifstream archivo;
+    string linea;
+
+public:
+    long long lineasInvalidas = 0;
+
+    explicit FuenteArchivoCitas(const string& ruta) : archivo(ruta) {}
+
+    bool abierto() const
+    {
+        return archivo.is_open();
+    }
+
+    bool siguiente(Cita& c) override
+    {
+        while (getline(archivo, linea))
+        {
+            if (linea.empty())
+                continue;
+            if (leerCitaCSV(linea, c))
+            {
+                asignarClaveOrden(c);
+                return true;
+            }
+            lineasInvalidas++;
+        }
+        return false;
+    }
+};
+
+struct EstadisticasFusionKWay
+{
+    long long citasEmitidas = 0;
+    long long comparaciones = 0;
+    long long fueraDeOrden = 0; // citas que llegaron desordenadas dentro de su propia fuente
+};
+
+/**
+ * Fusiona N fuentes ya ordenadas con un arbol de perdedores (torneo).
+ * Cada cita emitida cuesta O(log N) comparaciones y solo se mantiene en memoria
+ * la cabeza de cada fuente, de modo que la salida puede escribirse a medida
+ * que se produce. En empate gana la fuente de menor indice (fusion estable).
+ * Complejidad: O(total * log N).
+ */
+EstadisticasFusionKWay fusionarAgendasOrdenadas(const vector<FuenteCitas*>& fuentes, const CitaComparator& comp,
+                                                const function<void(Cita&&)>& emitir)
+{
+    EstadisticasFusionKWay st;
+    const int k = static_cast<int>(fuentes.size());
+    if (k == 0)
+        return st;
+
+    vector<Cita> cabeza(k);
+    vector<char> activa(k);
+    for (int i = 0; i < k; ++i)
+        activa[i] = fuentes[i]->siguiente(cabeza[i]);
+
+    // true si la cabeza de 'a' debe salir antes que la de 'b'
+    auto gana = [&](int a, int b)
+    {
+        if (!activa[a])
+            return false;
+        if (!activa[b])
+            return true;
+        st.comparaciones++;
+        if (comp(cabeza[a], cabeza[b]))
+            return true;
+        if (comp(cabeza[b], cabeza[a]))
+            return false;
+        return a < b;
+    };
+
+    // arbol[0] = ganador; arbol[1..k-1] = perdedor de cada partido. Hojas en k..2k-1.
+    vector<int> arbol(k);
+    function<int(int)> construir = [&](int nodo) -> int
+    {
+        if (nodo >= k)
+            return nodo - k;
+        int izq = construir(2 * nodo);
+        int der = construir(2 * nodo + 1);
+        if (gana(izq, der))
+        {
+            arbol[nodo] = der;
+            return izq;
+        }
+        arbol[nodo] = izq;
+        return der;
+    };
+    arbol[0] = (k == 1) ? 0 : construir(1);
+
+    Cita siguienteCita;
+    while (activa[arbol[0]])
+    {
+        int w = arbol[0];
+        bool hay = fuentes[w]->siguiente(siguienteCita);
+        if (hay && comp(siguienteCita, cabeza[w]))
+            st.fueraDeOrden++;
+        emitir(std::move(cabeza[w]));
+        st.citasEmitidas++;
+        if (hay)
+            cabeza[w] = std::move(siguienteCita);
+        else
+            activa[w] = false;
+
+        // Repetir los partidos desde la hoja de w hasta la raiz
+        for (int nodo = (w + k) / 2; nodo >= 1; nodo /= 2)
+        {
+            if (gana(arbol[nodo], w))
+                swap(arbol[nodo], w);
+        }
+        arbol[0] = w;
+    }
+    return st;
+}
+
+/**
+ * Consolida en citasProgramadas las agendas ya ordenadas de cada area,
+ * sin reordenar el conjunto completo. Las agendas de entrada se vacian.
+ * Las citas son las mismas que habia en la agenda (ver separarAgendasPorArea):
+ * el llamador solo sincroniza las posiciones del indice.
+ */
+void consolidarAgendasPorArea(vector<vector<Cita>>& agendasPorArea)
+{
+    vector<FuenteVectorCitas> fuentesVector;
+    vector<FuenteCitas*> fuentes;
+    size_t total = 0;
+    fuentesVector.reserve(agendasPorArea.size());
+    for (auto& agenda : agendasPorArea)
+    {
+        total += agenda.size();
+        fuentesVector.emplace_back(agenda, true);
+    }
+    for (auto& f : fuentesVector)
+        fuentes.push_back(&f);
+
+    citasProgramadas.clear();
+    citasProgramadas.reserve(total);
+    EstadisticasFusionKWay st = fusionarAgendasOrdenadas(fuentes, globalComparator,
+                                                         [](Cita&& c) { citasProgramadas.push_back(std::move(c)); });
+    for (auto& agenda : agendasPorArea)
+        agenda.clear();
+
+    consola() << "[K-WAY MERGE] " << st.citasEmitidas << " citas de " << fuentes.size()
+              << " areas consolidadas (" << st.comparaciones << " comparaciones)." << endl;
+    if (st.fueraDeOrden > 0)
+        consola() << "[ADVERTENCIA] " << st.fueraDeOrden << " citas llegaron desordenadas dentro de su area." << endl;
+}
+
+/**
+ * Reparte citasProgramadas en una agenda por area (especialidad), en el orden
+ * en que aparece cada area y conservando el orden relativo de sus citas. Cada
+ * area suele llegar ya ordenada; las que no, se ordenan por separado con Merge
+ * Sort (estable). Devuelve cuantas areas hubo que ordenar.
+ */
+int separarAgendasPorArea(vector<vector<Cita>>& agendasPorArea)
+{
+    unordered_map<string, size_t> areaDe;
+    agendasPorArea.clear();
+    for (Cita& c : citasProgramadas)
+    {
+        auto it = areaDe.emplace(c.especialidad, agendasPorArea.size()).first;
+        if (it->second == agendasPorArea.size())
+            agendasPorArea.emplace_back();
+        agendasPorArea[it->second].push_back(std::move(c));
+    }
+    citasProgramadas.clear();
+
+    int ordenadas = 0;
+    for (auto& agenda : agendasPorArea)
+    {
+        if (is_sorted(agenda.begin(), agenda.end(), globalComparator))
+            continue;
+        mergeSort(agenda, 0, static_cast<int>(agenda.size()) - 1, globalComparator);
+        ordenadas++;
+    }
+    return ordenadas;
+}
+
+/**
+ * Consolidacion nocturna desde archivos: fusiona agendas CSV ordenadas por area
+ * y escribe el resultado en streaming, sin cargar todas las citas en memoria.
+ */
+int consolidarArchivosAgendas(const string& rutaSalida, const vector<string>& rutasEntrada)
+{
+    vector<unique_ptr<FuenteArchivoCitas>> archivos;
+    vector<FuenteCitas*> fuentes;
+    for (const string& ruta : rutasEntrada)
+    {
+        archivos.emplace_back(new FuenteArchivoCitas(ruta));
+        if (!archivos.back()->abierto())
+        {
+            cerr << "[ERROR] No se pudo abrir la agenda: " << ruta << endl;
+            return 1;
+        }
+        fuentes.push_back(archivos.back().get());
+    }
+    ofstream salida(rutaSalida);
+    if (!salida)
+    {
+        cerr << "[ERROR] No se pudo crear el archivo de salida: " << rutaSalida << endl;
+        return 1;
+    }
+
+    auto inicio = chrono::steady_clock::now();
+    EstadisticasFusionKWay st = fusionarAgendasOrdenadas(fuentes, globalComparator,
+                                                         [&salida](Cita&& c) { escribirCitaCSV(salida, c); });
+    salida.flush();
+    double segundos = chrono::duration<double>(chrono::steady_clock::now() - inicio).count();
+
+    long long invalidas = 0;
+    for (const auto& a : archivos)
+        invalidas += a->lineasInvalidas;
+    consola() << "[K-WAY MERGE] " << st.citasEmitidas << " citas de " << fuentes.size() << " agendas en "
+              << fixed << setprecision(3) << segundos << " s ("
+              << (segundos > 0 ? st.citasEmitidas / segundos : 0.0) << " citas/s)." << endl;
+    if (invalidas > 0)
+        consola() << "[ADVERTENCIA] Lineas invalidas descartadas: " << invalidas << endl;
+    if (st.fueraDeOrden > 0)
+        consola() << "[ADVERTENCIA] " << st.fueraDeOrden << " citas llegaron desordenadas dentro de su agenda." << endl;
+    return salida ? 0 : 1;
+}
+
+// --- 3D. LISTA DE ESPERA INDEXADA POR ESPECIALIDAD ---
+
+/**
+ * Lista de espera organizada como una cola de prioridad por especialidad.
+ * Cada cola es un arbol ordenado por claveOrden (misma semantica que
+ * globalComparator, con el orden de ingreso como desempate), por lo que
+ * extraer al mejor paciente compatible con un slot liberado cuesta O(log n)
+ * y retirar a un paciente por DNI tambien es O(log n).
+ */
+class ListaEsperaIndexada
+{
+private:
+    using ColaEspecialidad = set<pair<uint64_t, uint32_t>>; // (claveOrden, slot)
+
+    vector<Cita> entradas;        // almacenamiento de las citas en espera
+    vector<uint32_t> slotsLibres; // slots de 'entradas' reutilizables
+    unordered_map<string, ColaEspecialidad> colas;          // Clave: especialidad
+    unordered_map<string, vector<uint32_t>> slotsPorDni;    // Clave: DNI
+    size_t total = 0;
+
+    // Quita el slot de su cola de especialidad y lo devuelve al pool
+    void liberarSlot(uint32_t slot)
+    {
+        Cita& c = entradas[slot];
+        auto itCola = colas.find(c.especialidad);
+        itCola->second.erase({ c.claveOrden, slot });
+        if (itCola->second.empty())
+            colas.erase(itCola);
+        slotsLibres.push_back(slot);
+        total--;
+    }
+
+public:
+    // Agrega un paciente a la espera; su ingreso define el desempate entre iguales
+    void agregar(Cita c)
+    {
+        asignarClaveOrden(c);
+        uint32_t slot;
+        if (!slotsLibres.empty())
+        {
+            slot = slotsLibres.back();
+            slotsLibres.pop_back();
+            entradas[slot] = std::move(c);
+        }
+        else
+        {
+            slot = static_cast<uint32_t>(entradas.size());
+            entradas.push_back(std::move(c));
+        }
+        const Cita& guardada = entradas[slot];
+        colas[guardada.especialidad].insert({ guardada.claveOrden, slot });
+        slotsPorDni[guardada.dniPaciente].push_back(slot);
+        total++;
+    }
+
+    // Extrae al paciente de mayor prioridad que espera la especialidad indicada
+    bool extraerMejor(const string& especialidad, Cita& salida)
+    {
+        auto itCola = colas.find(especialidad);
+        if (itCola == colas.end())
+            return false;
+        return extraer(itCola->second.begin()->second, salida);
+    }
+
+    // Hasta 'n' entradas de la especialidad en orden de prioridad (identificadas por su slot)
+    vector<uint32_t> primeros(const string& especialidad, size_t n) const
+    {
+        vector<uint32_t> slots;
+        auto itCola = colas.find(especialidad);
+        if (itCola == colas.end())
+            return slots;
+        for (auto it = itCola->second.begin(); it != itCola->second.end() && slots.size() < n; ++it)
+            slots.push_back(it->second);
+        return slots;
+    }
+
+    const Cita& entrada(uint32_t slot) const
+    {
+        return entradas[slot];
+    }
+
+    // Extrae una entrada concreta (obtenida con primeros)
+    bool extraer(uint32_t slot, Cita& salida)
+    {
+        auto itDni = slotsPorDni.find(entradas[slot].dniPaciente);
+        vector<uint32_t>& slots = itDni->second;
+        slots.erase(find(slots.begin(), slots.end(), slot));
+        if (slots.empty())
+            slotsPorDni.erase(itDni);
+
+        liberarSlot(slot);
+        salida = std::move(entradas[slot]);
+        return true;
+    }
+
+    // Retira todas las entradas de un paciente (p. ej. si abandona la lista). Devuelve cuantas.
+    int eliminarPorDni(const string& dni)
+    {
+        auto itDni = slotsPorDni.find(dni);
+        if (itDni == slotsPorDni.end())
+            return 0;
+        int eliminadas = 0;
+        for (uint32_t slot : itDni->second)
+        {
+            liberarSlot(slot);
+            entradas[slot] = Cita();
+            eliminadas++;
+        }
+        slotsPorDni.erase(itDni);
+        return eliminadas;
+    }
+
+    bool contiene(const string& dni) const
+    {
+        return slotsPorDni.count(dni) > 0;
+    }
+
+    size_t size() const
+    {
+        return total;
+    }
+
+    bool empty() const
+    {
+        return total == 0;
+    }
+
+    void limpiar()
+    {
+        entradas.clear();
+        slotsLibres.clear();
+        colas.clear();
+        slotsPorDni.clear();
+        total = 0;
+    }
+
+    // Claves de las entradas vivas, para renumerar la secuencia de ingesta
+    void clavesVivas(vector<uint64_t*>& claves)
+    {
+        for (auto& kv : colas)
+            for (const auto& e : kv.second)
+                claves.push_back(&entradas[e.second].claveOrden);
+    }
+
+    // Reordena las colas tras cambiar las claves de las entradas
+    void reindexarColas()
+    {
+        for (auto& kv : colas)
+        {
+            ColaEspecialidad nueva;
+            for (const auto& e : kv.second)
+                nueva.insert({ entradas[e.second].claveOrden, e.second });
+            kv.second.swap(nueva);
+        }
+    }
+
+    // Copia de las entradas, ordenadas por especialidad y luego por prioridad
+    vector<Cita> aVector() const
+    {
+        map<string, const ColaEspecialidad*> ordenadas;
+        for (const auto& kv : colas)
+            ordenadas[kv.first] = &kv.second;
+        vector<Cita> resultado;
+        resultado.reserve(total);
+        for (const auto& kv : ordenadas)
+            for (const auto& entrada : *kv.second)
+                resultado.push_back(entradas[entrada.second]);
+        return resultado;
+    }
+};
+
+ListaEsperaIndexada listaEspera;
+
+/*
+ * Reasigna la secuencia de ingesta 0..n-1 a las citas vivas en el orden de sus
+ * claves actuales: ninguna comparacion cambia y las citas nuevas vuelven a tener
+ * espacio detras de todas. Se llama cuando contadorIngestaCitas llega a 2^30
+ * (nunca en la practica: haria falta esa cantidad de altas en una sola sesion).
+ */
+void renumerarSecuenciasIngesta()
+{
+    vector<uint64_t*> claves;
+    claves.reserve(citasProgramadas.size() + listaEspera.size());
+    for (Cita& c : citasProgramadas)
+        claves.push_back(&c.claveOrden);
+    listaEspera.clavesVivas(claves);
+    sort(claves.begin(), claves.end(), [](const uint64_t* a, const uint64_t* b) { return *a < *b; });
+    for (size_t i = 0; i < claves.size(); ++i)
+        *claves[i] = (*claves[i] & ~MAX_SECUENCIA) | static_cast<uint64_t>(i);
+    listaEspera.reindexarColas();
+    contadorIngestaCitas = static_cast<uint32_t>(claves.size());
+}
+
+// --- 3E. CALENDARIO DE MEDICOS (BITMAP DE SLOTS POR DIA) ---
+
+// Cada dia se divide en slots de 15 minutos: 96 slots = 2 palabras de 64 bits
+const int MINUTOS_POR_SLOT = 15;
+const int SLOTS_POR_DIA = 24 * 60 / MINUTOS_POR_SLOT;
+const int PALABRAS_POR_DIA = (SLOTS_POR_DIA + 63) / 64;
+// Jornada de atencion usada para buscar huecos libres
+const int SLOT_INICIO_JORNADA = 8 * 60 / MINUTOS_POR_SLOT;  // 08:00
+const int SLOT_FIN_JORNADA = 20 * 60 / MINUTOS_POR_SLOT;    // 20:00 (exclusivo)
+
+// Mascara de los bits [desde, hasta) dentro de la palabra p
+inline uint64_t mascaraRango(int p, int desde, int hasta)
+{
+    int lo = max(desde - 64 * p, 0);
+    int hi = min(hasta - 64 * p, 64);
+    if (lo >= hi)
+        return 0;
+    uint64_t m = (hi == 64) ? ~0ULL : ((1ULL << hi) - 1);
+    return m & ~((1ULL << lo) - 1);
+}
+
+// Fecha "YYYY-MM-DD" a partir de dias desde 1970-01-01 (inversa de diasDesdeEpoca)
+string formatearFecha(uint64_t dias)
+{
+    long long z = static_cast<long long>(dias) + 719468;
+    long long era = z / 146097;
+    long long doe = z - era * 146097;
+    long long yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    long long y = yoe + era * 400;
+    long long doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    long long mp = (5 * doy + 2) / 153;
+    long long d = doy - (153 * mp + 2) / 5 + 1;
+    long long m = mp < 10 ? mp + 3 : mp - 9;
+    y += (m <= 2);
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%04lld-%02lld-%02lld", y, m, d);
+    return buf;
+}
+
+string formatearMinuto(int minuto)
+{
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%02d:%02d", minuto / 60, minuto % 60);
+    return buf;
+}
+
+string formatearHoraSlot(int slot)
+{
+    return formatearMinuto(slot * MINUTOS_POR_SLOT);
+}
+
+// Resultado de una busqueda de hueco libre
+struct HuecoLibre
+{
+    int idMedico = -1;
+    uint32_t dia = 0;
+    int slot = -1;
+};
+
+/**
+ * Medicos disponibles por especialidad. Cada especialidad numera a sus medicos
+ * en forma densa (0..n-1) y guarda un bitset con los disponibles, su cantidad
+ * y la carga (citas activas) de cada uno. "Hay alguno" es O(1), listarlos es
+ * O(n/64 + k) con ctz y el menos cargado se elige mirando solo los k bits
+ * encendidos. Se actualiza en cada cambio de disponibilidad y de agenda.
+ */
+class DisponibilidadPorEspecialidad
+{
+private:
+    struct Especialidad
+    {
+        vector<int> idMedico;          // posicion densa -> idMedico
+        vector<uint32_t> carga;        // citas activas por posicion
+        vector<uint64_t> disponibles;  // un bit por posicion
+        size_t cantidadDisponibles = 0;
+    };
+
+    struct Ubicacion
+    {
+        uint32_t especialidad;
+        uint32_t posicion;
+    };
+
+    vector<Especialidad> especialidades;
+    unordered_map<string, uint32_t> idEspecialidad;
+    unordered_map<int, Ubicacion> ubicacionPorMedico;
+
+    const Especialidad* buscarEspecialidad(const string& especialidad) const
+    {
+        auto it = idEspecialidad.find(especialidad);
+        return it == idEspecialidad.end() ? nullptr : &especialidades[it->second];
+    }
+
+    // Recorre las posiciones disponibles de la especialidad en orden
+    template <typename Visitar>
+    static void recorrerDisponibles(const Especialidad& e, Visitar visitar)
+    {
+        for (size_t p = 0; p < e.disponibles.size(); ++p)
+            for (uint64_t bits = e.disponibles[p]; bits; bits &= bits - 1)
+                visitar(static_cast<uint32_t>(64 * p + contarCerosFinales(bits)));
+    }
+
+public:
+    void limpiar()
+    {
+        especialidades.clear();
+        idEspecialidad.clear();
+        ubicacionPorMedico.clear();
+    }
+
+    void registrarMedico(const Medico& m)
+    {
+        if (ubicacionPorMedico.count(m.idMedico))
+        {
+            cambiarDisponibilidad(m.idMedico, m.disponible);
+            return;
+        }
+        auto it = idEspecialidad.emplace(m.especialidad, static_cast<uint32_t>(especialidades.size())).first;
+        if (it->second == especialidades.size())
+            especialidades.emplace_back();
+        Especialidad& e = especialidades[it->second];
+        uint32_t posicion = static_cast<uint32_t>(e.idMedico.size());
+        e.idMedico.push_back(m.idMedico);
+        e.carga.push_back(0);
+        if (posicion % 64 == 0)
+            e.disponibles.push_back(0);
+        ubicacionPorMedico[m.idMedico] = { it->second, posicion };
+        cambiarDisponibilidad(m.idMedico, m.disponible);
+    }
+
+    void cambiarDisponibilidad(int idMedico, bool disponible)
+    {
+        auto it = ubicacionPorMedico.find(idMedico);
+        if (it == ubicacionPorMedico.end())
+            return;
+        Especialidad& e = especialidades[it->second.especialidad];
+        uint64_t& palabra = e.disponibles[it->second.posicion / 64];
+        uint64_t bit = 1ULL << (it->second.posicion % 64);
+        if (disponible == ((palabra & bit) != 0))
+            return;
+        palabra ^= bit;
+        if (disponible)
+            e.cantidadDisponibles++;
+        else
+            e.cantidadDisponibles--;
+    }
+
+    // Una cita activa mas (+1) o menos (-1) para el medico
+    void sumarCarga(int idMedico, int delta)
+    {
+        auto it = ubicacionPorMedico.find(idMedico);
+        if (it == ubicacionPorMedico.end())
+            return;
+        uint32_t& c = especialidades[it->second.especialidad].carga[it->second.posicion];
+        c = (delta < 0 && c == 0) ? 0 : c + delta;
+    }
+
+    int carga(int idMedico) const
+    {
+        auto it = ubicacionPorMedico.find(idMedico);
+        if (it == ubicacionPorMedico.end())
+            return 0;
+        return static_cast<int>(especialidades[it->second.especialidad].carga[it->second.posicion]);
+    }
+
+    bool hayDisponible(const string& especialidad) const
+    {
+        const Especialidad* e = buscarEspecialidad(especialidad);
+        return e && e->cantidadDisponibles > 0;
+    }
+
+    vector<int> disponibles(const string& especialidad) const
+    {
+        vector<int> ids;
+        const Especialidad* e = buscarEspecialidad(especialidad);
+        if (!e)
+            return ids;
+        ids.reserve(e->cantidadDisponibles);
+        recorrerDisponibles(*e, [&](uint32_t pos) { ids.push_back(e->idMedico[pos]); });
+        return ids;
+    }
+
+    // Medico disponible con menos citas activas (a igualdad, el registrado primero), o -1
+    int menosCargado(const string& especialidad) const
+    {
+        const Especialidad* e = buscarEspecialidad(especialidad);
+        if (!e || e->cantidadDisponibles == 0)
+            return -1;
+        uint32_t mejor = UINT32_MAX;
+        recorrerDisponibles(*e, [&](uint32_t pos)
+        {
+            if (mejor == UINT32_MAX || e->carga[pos] < e->carga[mejor])
+                mejor = pos;
+        });
+        return e->idMedico[mejor];
+    }
+};
+
+DisponibilidadPorEspecialidad disponibilidadMedicos;
+
+/**
+ * Calendario por medico y por dia con un bit por slot de 15 minutos.
+ * Reservar, liberar y detectar choques cuesta O(1); la busqueda del
+ * siguiente hueco recorre palabras de 64 slots con ctz en lugar de revisar
+ * cita por cita. Para una especialidad se combinan (AND) los bitmaps de sus
+ * medicos disponibles: el primer cero es el primer slot en que alguno esta libre.
+ */
+class CalendarioMedicos
+{
+private:
+    struct DiaAgenda
+    {
+        uint64_t ocupado[PALABRAS_POR_DIA] = {};
+    };
+
+    unordered_map<int, unordered_map<uint32_t, DiaAgenda>> agendas; // idMedico -> dia -> bitmap
+    unordered_map<int, string> nombrePorId;
+
+    const DiaAgenda* buscarDia(int idMedico, uint32_t dia) const
+    {
+        auto itMed = agendas.find(idMedico);
+        if (itMed == agendas.end())
+            return nullptr;
+        auto itDia = itMed->second.find(dia);
+        return itDia == itMed->second.end() ? nullptr : &itDia->second;
+    }
+
+    // Primer bit en cero de 'ocupado' dentro de [desde, hasta), o -1
+    static int primerLibre(const uint64_t* ocupado, int desde, int hasta)
+    {
+        for (int p = desde / 64; p * 64 < hasta; ++p)
+        {
+            uint64_t libres = ~(ocupado ? ocupado[p] : 0ULL) & mascaraRango(p, desde, hasta);
+            if (libres)
+                return 64 * p + contarCerosFinales(libres);
+        }
+        return -1;
+    }
+
+public:
+    void limpiar()
+    {
+        agendas.clear();
+        nombrePorId.clear();
+    }
+
+    void registrarMedico(const Medico& m)
+    {
+        nombrePorId.emplace(m.idMedico, m.nombreCompleto);
+    }
+
+    bool estaOcupado(int idMedico, uint32_t dia, int slot) const
+    {
+        const DiaAgenda* d = buscarDia(idMedico, dia);
+        return d && ((d->ocupado[slot / 64] >> (slot % 64)) & 1ULL);
+    }
+
+    // Marca el slot; devuelve false si ya estaba ocupado (choque de horario)
+    bool reservar(int idMedico, uint32_t dia, int slot)
+    {
+        uint64_t& palabra = agendas[idMedico][dia].ocupado[slot / 64];
+        uint64_t bit = 1ULL << (slot % 64);
+        if (palabra & bit)
+            return false;
+        palabra |= bit;
+        return true;
+    }
+
+    void liberar(int idMedico, uint32_t dia, int slot)
+    {
+        auto itMed = agendas.find(idMedico);
+        if (itMed == agendas.end())
+            return;
+        auto itDia = itMed->second.find(dia);
+        if (itDia == itMed->second.end())
+            return;
+        itDia->second.ocupado[slot / 64] &= ~(1ULL << (slot % 64));
+    }
+
+    int slotsOcupados(int idMedico, uint32_t dia) const
+    {
+        const DiaAgenda* d = buscarDia(idMedico, dia);
+        int total = 0;
+        for (int p = 0; d && p < PALABRAS_POR_DIA; ++p)
+            total += contarBits(d->ocupado[p]);
+        return total;
+    }
+
+    // Siguiente slot libre del medico a partir de (dia, slot), buscando hasta 'diasMaximo' dias
+    HuecoLibre siguienteLibreMedico(int idMedico, uint32_t dia, int slotDesde, int diasMaximo) const
+    {
+        HuecoLibre h;
+        for (int k = 0; k < diasMaximo; ++k)
+        {
+            const DiaAgenda* d = buscarDia(idMedico, dia + k);
+            int desde = (k == 0) ? max(slotDesde, SLOT_INICIO_JORNADA) : SLOT_INICIO_JORNADA;
+            int slot = primerLibre(d ? d->ocupado : nullptr, desde, SLOT_FIN_JORNADA);
+            if (slot != -1)
+            {
+                h.idMedico = idMedico;
+                h.dia = dia + k;
+                h.slot = slot;
+                return h;
+            }
+        }
+        return h;
+    }
+
+    // Primer hueco de cualquier medico disponible de la especialidad (AND de sus bitmaps)
+    HuecoLibre siguienteLibreEspecialidad(const string& especialidad, uint32_t dia, int slotDesde,
+                                          int diasMaximo) const
+    {
+        HuecoLibre h;
+        vector<int> candidatos = disponibilidadMedicos.disponibles(especialidad);
+        if (candidatos.empty())
+            return h;
+
+        for (int k = 0; k < diasMaximo; ++k)
+        {
+            uint64_t todosOcupados[PALABRAS_POR_DIA];
+            for (int p = 0; p < PALABRAS_POR_DIA; ++p)
+                todosOcupados[p] = ~0ULL;
+            for (int id : candidatos)
+            {
+                const DiaAgenda* d = buscarDia(id, dia + k);
+                for (int p = 0; p < PALABRAS_POR_DIA; ++p)
+                    todosOcupados[p] &= d ? d->ocupado[p] : 0ULL;
+            }
+            int desde = (k == 0) ? max(slotDesde, SLOT_INICIO_JORNADA) : SLOT_INICIO_JORNADA;
+            int slot = primerLibre(todosOcupados, desde, SLOT_FIN_JORNADA);
+            if (slot == -1)
+                continue;
+            for (int id : candidatos)
+            {
+                if (!estaOcupado(id, dia + k, slot))
+                {
+                    h.idMedico = id;
+                    h.dia = dia + k;
+                    h.slot = slot;
+                    return h;
+                }
+            }
+        }
+        return h;
+    }
+
+    string nombreMedico(int idMedico) const
+    {
+        auto it = nombrePorId.find(idMedico);
+        return it == nombrePorId.end() ? string() : it->second;
+    }
+};
+
+CalendarioMedicos calendarioMedicos;
+
+// Ubica una cita en el calendario: false si su fecha/hora no son validas
+bool slotDeCita(const Cita& c, uint32_t& dia, int& slot)
+{
+    uint64_t d = diasDesdeEpoca(c.fecha);
+    uint64_t minuto = minutoDelDia(c.hora);
+    if (d == MAX_DIA || minuto == MAX_MINUTO)
+        return false;
+    dia = static_cast<uint32_t>(d);
+    slot = static_cast<int>(minuto) / MINUTOS_POR_SLOT;
+    return true;
+}
+
+// Reconstruye el calendario, la disponibilidad por especialidad y el indice temporal desde
+// tablaMedicos y la agenda. Devuelve los choques encontrados.
+int reconstruirCalendarioMedicos()
+{
+    vector<uint32_t> instantes(citasProgramadas.size());
+    for (size_t i = 0; i < citasProgramadas.size(); ++i)
+        if (!instanteDe(citasProgramadas[i].fecha, citasProgramadas[i].hora, instantes[i]))
+            instantes[i] = UINT32_MAX;
+    indiceTemporal.reconstruir(citasProgramadas, instantes);
+
+    calendarioMedicos.limpiar();
+    disponibilidadMedicos.limpiar();
+    for (const auto& kv : tablaMedicos)
+    {
+        calendarioMedicos.registrarMedico(kv.second);
+        disponibilidadMedicos.registrarMedico(kv.second);
+    }
+    int choques = 0;
+    for (const Cita& c : citasProgramadas)
+    {
+        uint32_t dia;
+        int slot;
+        if (c.cancelada)
+            continue;
+        disponibilidadMedicos.sumarCarga(c.idMedico, 1);
+        if (slotDeCita(c, dia, slot) && !calendarioMedicos.reservar(c.idMedico, dia, slot))
+            choques++;
+    }
+    return choques;
+}
+
+// --- 3F. ALMACENAMIENTO COLUMNAR DE CITAS (STRINGS INTERNADOS) ---
+
+// Tabla de internado: cada string distinto se guarda una sola vez y se referencia por id
+class TablaStrings
+{
+private:
+    unordered_map<string, uint32_t> idPorTexto;
+    vector<const string*> textoPorId; // apunta a las claves del mapa (estables ante rehash)
+
+public:
+    uint32_t internar(const string& texto)
+    {
+        auto it = idPorTexto.find(texto);
+        if (it != idPorTexto.end())
+            return it->second;
+        uint32_t id = static_cast<uint32_t>(textoPorId.size());
+        auto insertado = idPorTexto.emplace(texto, id).first;
+        textoPorId.push_back(&insertado->first);
+        return id;
+    }
+
+    // Id de un texto ya internado, o -1 si no existe
+    long long buscar(const string& texto) const
+    {
+        auto it = idPorTexto.find(texto);
+        return it == idPorTexto.end() ? -1 : static_cast<long long>(it->second);
+    }
+
+    const string& texto(uint32_t id) const
+    {
+        return *textoPorId[id];
+    }
+
+    size_t size() const
+    {
+        return textoPorId.size();
+    }
+
+    void reservar(size_t n)
+    {
+        idPorTexto.reserve(n);
+        textoPorId.reserve(n);
+    }
+
+    // Estimacion de memoria: strings + nodos del mapa + buckets + vector de punteros
+    size_t bytesUsados() const
+    {
+        size_t bytes = textoPorId.capacity() * sizeof(const string*) +
+                       idPorTexto.bucket_count() * sizeof(void*);
+        for (const auto& kv : idPorTexto)
+        {
+            bytes += sizeof(kv) + sizeof(void*) + sizeof(size_t); // nodo: par + siguiente + hash
+            if (kv.first.capacity() > 15)
+                bytes += kv.first.capacity() + 1;
+        }
+        return bytes;
+    }
+};
+
+/**
+ * Agenda en formato columnar (structure of arrays). Los campos calientes
+ * (prioridad, dia, minuto, medico, cancelada) son arreglos contiguos y
+ * pequeños, por lo que recorrerlos u ordenarlos toca pocas lineas de cache.
+ * Medicos, especialidades y DNIs se internan a ids de 32 bits; los strings
+ * solo se reconstruyen (materializar) para mostrar una fila.
+ */
+class TablaCitasColumnar
+{
+private:
+    // Columnas calientes
+    vector<uint8_t> prioridad;
+    vector<uint32_t> dia;     // dias desde 1970-01-01 (diasDesdeEpoca)
+    vector<uint16_t> minuto;  // minuto del dia (minutoDelDia)
+    vector<uint32_t> medico;  // id internado de nombreMedico
+    vector<uint8_t> cancelada;
+    // Columnas frias
+    vector<int32_t> idCita;
+    vector<int32_t> idPaciente;
+    vector<int32_t> idMedico;
+    vector<uint32_t> paciente;     // id internado del DNI
+    vector<uint32_t> especialidad; // id internado
+
+    TablaStrings medicos;
+    TablaStrings especialidades;
+    TablaStrings pacientes;
+
+    template <typename T>
+    static size_t bytesColumna(const vector<T>& v)
+    {
+        return v.capacity() * sizeof(T);
+    }
+
+public:
+    size_t size() const
+    {
+        return idCita.size();
+    }
+
+    void reservar(size_t n)
+    {
+        prioridad.reserve(n);
+        dia.reserve(n);
+        minuto.reserve(n);
+        medico.reserve(n);
+        cancelada.reserve(n);
+        idCita.reserve(n);
+        idPaciente.reserve(n);
+        idMedico.reserve(n);
+        paciente.reserve(n);
+        especialidad.reserve(n);
+    }
+
+    void agregar(const Cita& c)
+    {
+        prioridad.push_back(static_cast<uint8_t>(min(max(c.prioridad, 0), 255)));
+        dia.push_back(static_cast<uint32_t>(diasDesdeEpoca(c.fecha)));
+        minuto.push_back(static_cast<uint16_t>(minutoDelDia(c.hora)));
+        medico.push_back(medicos.internar(c.nombreMedico));
+        cancelada.push_back(c.cancelada ? 1 : 0);
+        idCita.push_back(c.idCita);
+        idPaciente.push_back(c.idPaciente);
+        idMedico.push_back(c.idMedico);
+        paciente.push_back(pacientes.internar(c.dniPaciente));
+        especialidad.push_back(especialidades.internar(c.especialidad));
+    }
+
+    // Reconstruye la Cita completa de una fila (solo para mostrar o exportar)
+    Cita materializar(size_t fila) const
+    {
+        Cita c;
+        c.idCita = idCita[fila];
+        c.idPaciente = idPaciente[fila];
+        c.idMedico = idMedico[fila];
+        c.dniPaciente = pacientes.texto(paciente[fila]);
+        c.nombreMedico = medicos.texto(medico[fila]);
+        c.fecha = dia[fila] == MAX_DIA ? "N/A" : formatearFecha(dia[fila]);
+        c.hora = minuto[fila] == MAX_MINUTO ? "N/A" : formatearMinuto(minuto[fila]);
+        c.especialidad = especialidades.texto(especialidad[fila]);
+        c.prioridad = prioridad[fila];
+        c.cancelada = cancelada[fila] != 0;
+        return c;
+    }
+
+    void cancelar(size_t fila)
+    {
+        cancelada[fila] = 1;
+    }
+
+    // Id internado de un medico, o -1 si no aparece en la tabla
+    long long idInternoMedico(const string& nombre) const
+    {
+        return medicos.buscar(nombre);
+    }
+
+    // Recorrido sobre columnas calientes: citas activas de un medico
+    size_t contarActivasDeMedico(uint32_t idInterno) const
+    {
+        size_t total = 0;
+        for (size_t i = 0; i < medico.size(); ++i)
+            total += (medico[i] == idInterno) & (cancelada[i] == 0);
+        return total;
+    }
+
+    // Orden prioridad > fecha > hora (igual que globalComparator) usando solo columnas enteras
+    vector<uint32_t> permutacionOrdenada() const
+    {
+        vector<uint64_t> claves(size());
+        for (size_t i = 0; i < claves.size(); ++i)
+            claves[i] = (static_cast<uint64_t>(prioridad[i]) << 56) | (static_cast<uint64_t>(dia[i]) << 24) |
+                        (static_cast<uint64_t>(minuto[i]) << 8);
+        vector<uint32_t> perm(size());
+        for (size_t i = 0; i < perm.size(); ++i)
+            perm[i] = static_cast<uint32_t>(i);
+        stable_sort(perm.begin(), perm.end(), [&claves](uint32_t a, uint32_t b) { return claves[a] < claves[b]; });
+        return perm;
+    }
+
+    size_t bytesUsados() const
+    {
+        return bytesColumna(prioridad) + bytesColumna(dia) + bytesColumna(minuto) + bytesColumna(medico) +
+               bytesColumna(cancelada) + bytesColumna(idCita) + bytesColumna(idPaciente) +
+               bytesColumna(idMedico) + bytesColumna(paciente) + bytesColumna(especialidad) +
+               medicos.bytesUsados() + especialidades.bytesUsados() + pacientes.bytesUsados();
+    }
+};
+
+// Bytes que ocupa un string fuera de su objeto (0 si cabe en el buffer interno SSO)
+static size_t bytesHeapString(const string& s)
+{
+    const char* p = s.data();
+    const char* obj = reinterpret_cast<const char*>(&s);
+    if (p >= obj && p < obj + sizeof(string))
+        return 0;
+    return s.capacity() + 1;
+}
+
+// Memoria de un vector<Cita>: structs + heap de sus cinco strings
+size_t bytesVectorCitas(const vector<Cita>& citas)
+{
+    size_t bytes = citas.capacity() * sizeof(Cita);
+    for (const Cita& c : citas)
+        bytes += bytesHeapString(c.dniPaciente) + bytesHeapString(c.nombreMedico) + bytesHeapString(c.fecha) +
+                 bytesHeapString(c.hora) + bytesHeapString(c.especialidad);
+    return bytes;
+}
+
+/**
+ * Comparacion de memoria y recorrido entre vector<Cita> y la tabla columnar
+ * sobre una agenda sintetica determinista (main --comparar-memoria [filas]).
+ */
+int compararMemoriaAgendas(size_t filas)
+{
+    const int NUM_MEDICOS = 2000, NUM_ESPECIALIDADES = 24, NUM_PACIENTES = 300000;
+    uint64_t estado = 88172645463325252ULL; // xorshift64 con semilla fija
+    auto aleatorio = [&estado]()
+    {
+        estado ^= estado << 13;
+        estado ^= estado >> 7;
+        estado ^= estado << 17;
+        return estado;
+    };
+
+    vector<Cita> agenda;
+    agenda.reserve(filas);
+    for (size_t i = 0; i < filas; ++i)
+    {
+        Cita c;
+        int m = static_cast<int>(aleatorio() % NUM_MEDICOS);
+        int p = static_cast<int>(aleatorio() % NUM_PACIENTES);
+        c.idCita = static_cast<int>(i + 1);
+        c.idPaciente = 100000 + p;
+        c.idMedico = 500 + m;
+        c.dniPaciente = to_string(10000000 + p * 37);
+        c.nombreMedico = "Medico de Prueba " + to_string(m);
+        c.fecha = formatearFecha(diasDesdeEpoca("2025-01-01") + aleatorio() % 365);
+        c.hora = formatearHoraSlot(SLOT_INICIO_JORNADA + static_cast<int>(aleatorio() % (SLOT_FIN_JORNADA - SLOT_INICIO_JORNADA)));
+        c.especialidad = "Especialidad " + to_string(m % NUM_ESPECIALIDADES);
+        c.prioridad = 1 + static_cast<int>(aleatorio() % 5);
+        c.cancelada = (aleatorio() % 20) == 0;
+        agenda.push_back(std::move(c));
+    }
+
+    TablaCitasColumnar tabla;
+    tabla.reservar(filas);
+    for (const Cita& c : agenda)
+        tabla.agregar(c);
+
+    size_t bytesAos = bytesVectorCitas(agenda);
+    size_t bytesSoa = tabla.bytesUsados();
+    consola() << "\n=========== COMPARACION DE MEMORIA DE LA AGENDA ===========\n";
+    consola() << "Filas: " << filas << " (sizeof(Cita) = " << sizeof(Cita) << " bytes)\n";
+    consola() << fixed << setprecision(2);
+    consola() << "vector<Cita>       : " << bytesAos / (1024.0 * 1024.0) << " MiB (" << double(bytesAos) / filas
+              << " bytes/fila)\n";
+    consola() << "Tabla columnar     : " << bytesSoa / (1024.0 * 1024.0) << " MiB (" << double(bytesSoa) / filas
+              << " bytes/fila)\n";
+    consola() << "Reduccion          : " << (bytesSoa > 0 ? double(bytesAos) / bytesSoa : 0.0) << "x\n";
+
+    // Recorrido: citas activas de un medico
+    const string objetivo = "Medico de Prueba 7";
+    auto t0 = chrono::steady_clock::now();
+    size_t activasAos = 0;
+    for (const Cita& c : agenda)
+        activasAos += (!c.cancelada && c.nombreMedico == objetivo);
+    auto t1 = chrono::steady_clock::now();
+    long long idInterno = tabla.idInternoMedico(objetivo);
+    size_t activasSoa = idInterno < 0 ? 0 : tabla.contarActivasDeMedico(static_cast<uint32_t>(idInterno));
+    auto t2 = chrono::steady_clock::now();
+    consola() << "Recorrido por medico: vector<Cita> " << chrono::duration<double, milli>(t1 - t0).count()
+              << " ms, columnar " << chrono::duration<double, milli>(t2 - t1).count() << " ms ("
+              << activasAos << "/" << activasSoa << " citas activas)\n";
+
+    // Ordenamiento prioridad > fecha > hora
+    vector<uint32_t> permIndices;
+    t0 = chrono::steady_clock::now();
+    motorMergeSort.ordenarIndices(agenda, permIndices, globalComparator);
+    t1 = chrono::steady_clock::now();
+    vector<uint32_t> permColumnar = tabla.permutacionOrdenada();
+    t2 = chrono::steady_clock::now();
+    consola() << "Orden (permutacion): vector<Cita> " << chrono::duration<double, milli>(t1 - t0).count()
+              << " ms, columnar " << chrono::duration<double, milli>(t2 - t1).count() << " ms ("
+              << (permIndices == permColumnar ? "mismo orden" : "ORDEN DISTINTO") << ")\n";
+    consola() << "===========================================================\n";
+    consola().unsetf(ios::floatfield);
+    return permIndices == permColumnar && activasAos == activasSoa ? 0 : 1;
+}
+
+// Memoria estimada de un unordered_map<string, Paciente>: nodos (con hash cacheado), buckets y heap de strings
+static size_t bytesMapaPacientes(const unordered_map<string, Paciente>& mapa)
+{
+    size_t nodo = sizeof(void*) + sizeof(pair<const string, Paciente>) + sizeof(size_t);
+    size_t bytes = mapa.size() * ((nodo + 15) / 16 * 16) + mapa.bucket_count() * sizeof(void*);
+    for (const auto& kv : mapa)
+        bytes += bytesHeapString(kv.first) + bytesHeapString(kv.second.dni) + bytesHeapString(kv.second.nombreCompleto);
+    return bytes;
+}
+
+/**
+ * Compara la tabla plana de pacientes con unordered_map<string, Paciente>
+ * (main --comparar-pacientes [n ...]): construccion, busquedas exitosas y
+ * fallidas en orden aleatorio y memoria por paciente. Las dos estructuras se
+ * construyen una despues de la otra para no duplicar el pico de memoria.
+ */
+int compararIndicePacientes(const vector<size_t>& tamanos)
+{
+    int resultado = 0;
+    consola() << "\n================ INDICE DE PACIENTES POR DNI ================\n";
+    consola() << std::left << setw(16) << "Estructura" << std::right << setw(12) << "Pacientes" << setw(14)
+              << "Carga(ms)" << setw(14) << "Acierto(ns)" << setw(14) << "Fallo(ns)" << setw(14) << "Bytes/pac" << "\n";
+    for (size_t n : tamanos)
+    {
+        n = min<size_t>(n, 90000000); // DNI de 8 digitos distintos
+        uint64_t estado = 88172645463325252ULL;
+        auto aleatorio = [&estado]()
+        {
+            estado ^= estado << 13;
+            estado ^= estado >> 7;
+            estado ^= estado << 17;
+            return estado;
+        };
+        // 7919 es coprimo con 9*10^7: i -> dni es una biyeccion sobre los DNI de 8 digitos
+        auto dniDe = [](size_t i) { return to_string(10000000 + (i * 7919) % 90000000); };
+        size_t numConsultas = min<size_t>(n, 2000000);
+        vector<string> aciertos, fallos;
+        aciertos.reserve(numConsultas);
+        fallos.reserve(numConsultas);
+        for (size_t q = 0; q < numConsultas; ++q)
+        {
+            aciertos.push_back(dniDe(aleatorio() % n));
+            fallos.push_back(to_string(100000000 + aleatorio() % 900000000)); // 9 digitos: nunca presentes
+        }
+
+        auto medir = [&](const char* nombre, auto&& construir, auto&& buscar, auto&& bytes, auto&& liberar)
+        {
+            auto t0 = chrono::steady_clock::now();
+            for (size_t i = 0; i < n; ++i)
+                construir(Paciente{ static_cast<int>(i), dniDe(i), "P" + to_string(i) });
+            auto t1 = chrono::steady_clock::now();
+            long long suma = 0;
+            for (const string& dni : aciertos)
+                suma += buscar(dni);
+            auto t2 = chrono::steady_clock::now();
+            long long encontrados = 0;
+            for (const string& dni : fallos)
+                encontrados += buscar(dni) >= 0;
+            auto t3 = chrono::steady_clock::now();
+            size_t memoria = bytes();
+            liberar();
+            consola() << std::left << setw(16) << nombre << std::right << setw(12) << n << fixed << setprecision(1)
+                      << setw(14) << chrono::duration<double, milli>(t1 - t0).count() << setw(14)
+                      << chrono::duration<double, nano>(t2 - t1).count() / numConsultas << setw(14)
+                      << chrono::duration<double, nano>(t3 - t2).count() / numConsultas << setw(14)
+                      << double(memoria) / n << "\n";
+            consola().unsetf(ios::floatfield);
+            return encontrados == 0 ? suma : -1;
+        };
+
+        long long sumaPlana, sumaMapa;
+        {
+            TablaPacientes tabla;
+            tabla.reservar(n);
+            sumaPlana = medir(
+                "Tabla plana", [&](Paciente&& p) { tabla.insertar(std::move(p)); },
+                [&](const string& dni)
+                {
+                    const Paciente* p = tabla.buscar(dni);
+                    return p ? p->idPaciente : -1;
+                },
+                [&]()
+                {
+                    size_t b = tabla.bytesUsados();
+                    for (const Paciente& p : tabla)
+                        b += bytesHeapString(p.dni) + bytesHeapString(p.nombreCompleto);
+                    return b;
+                },
+                [&]() { tabla.limpiar(); });
+        }
+        {
+            unordered_map<string, Paciente> mapa;
+            mapa.reserve(n);
+            sumaMapa = medir(
+                "unordered_map", [&](Paciente&& p) { string k = p.dni; mapa.emplace(std::move(k), std::move(p)); },
+                [&](const string& dni)
+                {
+                    auto it = mapa.find(dni);
+                    return it == mapa.end() ? -1 : it->second.idPaciente;
+                },
+                [&]() { return bytesMapaPacientes(mapa); }, [&]() { unordered_map<string, Paciente>().swap(mapa); });
+        }
+        if (sumaPlana < 0 || sumaPlana != sumaMapa)
+        {
+            consola() << "[ERROR] Las estructuras no devolvieron los mismos pacientes.\n";
+            resultado = 1;
+        }
+    }
+    consola() << "=============================================================\n";
+    return resultado;
+}
+
+// Nombres para poblaciones sinteticas (benchmarks y main --generar)
+const char* const NOMBRES_SINTETICOS[] = { "Carlos", "Maria", "Jose", "Luis", "Ana", "Juan", "Rosa", "Jorge", "Carmen",
+                                           "Pedro", "Lucia", "Miguel", "Elena", "Victor", "Sofia", "Raul", "Julia",
+                                           "Oscar", "Teresa", "Cesar", "Diana", "Hugo", "Patricia", "Ricardo", "Gabriela",
+                                           "Fernando", "Isabel", "Alberto", "Veronica", "Manuel", "Silvia", "Javier" };
+const char* const APELLIDOS_SINTETICOS[] = { "Quispe", "Flores", "Sanchez", "Rodriguez", "Garcia", "Mamani", "Huaman",
+                                             "Chavez", "Rojas", "Torres", "Vargas", "Ramos", "Castillo", "Mendoza",
+                                             "Espinoza", "Gutierrez", "Cruz", "Diaz", "Perez", "Lopez", "Condori", "Ccori",
+                                             "Salazar", "Vasquez", "Romero", "Ramirez", "Herrera", "Medina", "Aguilar",
+                                             "Silva", "Zarate", "Sacsara", "Palomino", "Cardenas", "Villanueva", "Paredes",
+                                             "Acosta", "Cabrera", "Nunez", "Cordova", "Ayala", "Benites", "Yupanqui" };
+const size_t NUM_NOMBRES_SINTETICOS = sizeof(NOMBRES_SINTETICOS) / sizeof(NOMBRES_SINTETICOS[0]);
+const size_t NUM_APELLIDOS_SINTETICOS = sizeof(APELLIDOS_SINTETICOS) / sizeof(APELLIDOS_SINTETICOS[0]);
+
+/**
+ * Autocompletado sobre pacientes sinteticos (main --comparar-nombres [n]):
+ * tiempo de construccion y memoria del indice de trigramas, latencia de
+ * consultas por prefijo y con un error de tipeo, y el mismo tipo de consulta
+ * resuelto recorriendo toda la tabla.
+ */
+int compararIndiceNombres(size_t n)
+{
+    uint64_t estado = 88172645463325252ULL;
+    auto aleatorio = [&estado]()
+    {
+        estado ^= estado << 13;
+        estado ^= estado >> 7;
+        estado ^= estado << 17;
+        return estado;
+    };
+
+    TablaPacientes tabla;
+    tabla.reservar(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        string nombre = string(NOMBRES_SINTETICOS[aleatorio() % NUM_NOMBRES_SINTETICOS]) + " " +
+                        NOMBRES_SINTETICOS[aleatorio() % NUM_NOMBRES_SINTETICOS] + " " +
+                        APELLIDOS_SINTETICOS[aleatorio() % NUM_APELLIDOS_SINTETICOS] + " " +
+                        APELLIDOS_SINTETICOS[aleatorio() % NUM_APELLIDOS_SINTETICOS];
+        tabla.insertar({ static_cast<int>(i + 1), to_string(10000000 + i), nombre });
+    }
+    IndiceNombresPacientes indice;
+    auto t0 = chrono::steady_clock::now();
+    indice.reconstruir(tabla);
+    double msIndice = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+
+    // Consultas tomadas de pacientes existentes: "nom ape" (prefijos) y "nombre apellido" con dos letras traspuestas
+    const size_t NUM_CONSULTAS = 1000;
+    vector<string> prefijos, conErrores;
+    for (size_t q = 0; q < NUM_CONSULTAS; ++q)
+    {
+        vector<string_view> palabras;
+        string base = normalizarNombre(tabla.enPosicion(static_cast<uint32_t>(aleatorio() % n)).nombreCompleto);
+        palabras = palabrasDe(base);
+        prefijos.push_back(string(palabras[0].substr(0, 3)) + " " + string(palabras[2].substr(0, 4)));
+        string apellido(palabras[3]);
+        size_t i = 1 + aleatorio() % (apellido.size() - 2);
+        swap(apellido[i], apellido[i + 1]);
+        conErrores.push_back(string(palabras[0]) + " " + apellido);
+    }
+
+    auto medir = [&](const vector<string>& consultas, size_t& encontrados)
+    {
+        vector<double> us;
+        encontrados = 0;
+        for (const string& c : consultas)
+        {
+            auto inicio = chrono::steady_clock::now();
+            encontrados += indice.buscar(c, 10, tabla).size();
+            us.push_back(chrono::duration<double, micro>(chrono::steady_clock::now() - inicio).count());
+        }
+        sort(us.begin(), us.end());
+        return us;
+    };
+    size_t encontradosPrefijo, encontradosError;
+    vector<double> usPrefijo = medir(prefijos, encontradosPrefijo);
+    vector<double> usError = medir(conErrores, encontradosError);
+
+    // Referencia: las mismas consultas por prefijo recorriendo toda la tabla
+    const size_t CONSULTAS_RECORRIDO = 5;
+    t0 = chrono::steady_clock::now();
+    size_t encontradosRecorrido = 0;
+    for (size_t q = 0; q < CONSULTAS_RECORRIDO; ++q)
+    {
+        string consulta = normalizarNombre(prefijos[q]);
+        vector<string_view> palabras = palabrasDe(consulta);
+        for (const Paciente& p : tabla)
+        {
+            string nombre = normalizarNombre(p.nombreCompleto);
+            vector<string_view> suyas = palabrasDe(nombre);
+            bool todas = true;
+            for (string_view w : palabras)
+                todas = todas && any_of(suyas.begin(), suyas.end(), [w](string_view s) { return s.compare(0, w.size(), w) == 0; });
+            encontradosRecorrido += todas;
+        }
+    }
+    double msRecorrido = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count() / CONSULTAS_RECORRIDO;
+
+    auto pct = [](const vector<double>& v, double p) { return v[min(v.size() - 1, static_cast<size_t>(p * v.size()))]; };
+    consola() << "\n=============== AUTOCOMPLETADO DE NOMBRES ===============\n";
+    consola() << fixed << setprecision(1);
+    consola() << "Pacientes: " << n << " | indice construido en " << msIndice << " ms, "
+              << double(indice.bytesUsados()) / n << " bytes/paciente\n";
+    consola() << setprecision(1) << "Prefijo  (k=10): p50 " << pct(usPrefijo, 0.5) << " us, p99 "
+              << pct(usPrefijo, 0.99) << " us, max " << usPrefijo.back() << " us ("
+              << double(encontradosPrefijo) / NUM_CONSULTAS << " resultados/consulta)\n";
+    consola() << "1 error  (k=10): p50 " << pct(usError, 0.5) << " us, p99 " << pct(usError, 0.99) << " us, max "
+              << usError.back() << " us (" << double(encontradosError) / NUM_CONSULTAS << " resultados/consulta)\n";
+    consola() << "Recorrido completo por prefijo: " << msRecorrido << " ms/consulta ("
+              << encontradosRecorrido / CONSULTAS_RECORRIDO << " coincidencias/consulta)\n";
+    consola() << "=========================================================\n";
+    consola().unsetf(ios::floatfield);
+    return encontradosPrefijo > 0 ? 0 : 1;
+}
+
+#ifdef MEDIR_ORDENAMIENTOS
+// Reservas de memoria hechas por el hilo actual (las lee --comparar-ordenamiento antes y despues de cada corrida).
+// new/delete van fuera de linea: inlinados, GCC toma el par malloc/free por un new/delete mal emparejado.
+thread_local long long reservasDelHilo = 0;
+
+#if defined(__GNUC__)
+#define FUERA_DE_LINEA __attribute__((noinline))
+#else
+#define FUERA_DE_LINEA
+#endif
+
+FUERA_DE_LINEA void* operator new(size_t n)
+{
+    reservasDelHilo++;
+    if (void* p = malloc(n ? n : 1))
+        return p;
+    throw bad_alloc();
+}
+
+FUERA_DE_LINEA void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+FUERA_DE_LINEA void operator delete(void* p, size_t) noexcept
+{
+    free(p);
+}
+
+const bool CONTADORES_ORDENAMIENTO = true;
+#else
+const long long reservasDelHilo = -1; // sin el reemplazo de operator new no hay conteo
+const bool CONTADORES_ORDENAMIENTO = false;
+#endif
+
+// Cita que cuenta sus movimientos, para medir std::sort y std::stable_sort sin tocar la biblioteca
+struct CitaContada
+{
+    Cita cita;
+    inline static long long movimientos = 0;
+
+    CitaContada() = default;
+    CitaContada(CitaContada&& otra) noexcept : cita(std::move(otra.cita))
+    {
+        movimientos++;
+    }
+    CitaContada& operator=(CitaContada&& otra) noexcept
+    {
+        cita = std::move(otra.cita);
+        movimientos++;
+        return *this;
+    }
+};
+
+enum DistribucionOrden
+{
+    DIST_ALEATORIA,
+    DIST_ORDENADA,
+    DIST_INVERTIDA,
+    DIST_POCAS_PRIORIDADES,
+    DIST_MUCHOS_EMPATES,
+    NUM_DISTRIBUCIONES
+};
+
+const char* NOMBRES_DISTRIBUCION[NUM_DISTRIBUCIONES] = { "aleatoria", "ordenada", "invertida", "pocas_prioridades",
+                                                          "muchos_empates" };
+
+/**
+ * i-esima cita sintetica de una agenda de n para el benchmark de ordenamiento.
+ * "ordenada" e "invertida" reparten n citas sobre todas las claves prioridad x dia x
+ * horario en orden (o al reves); las demas sortean con el xorshift de 'estado'.
+ */
+static Cita citaParaOrdenar(size_t i, size_t n, int distribucion, uint64_t& estado, const vector<string>& fechas,
+                            const vector<string>& horas)
+{
+    auto aleatorio = [&estado]()
+    {
+        estado ^= estado << 13;
+        estado ^= estado >> 7;
+        estado ^= estado << 17;
+        return estado;
+    };
+    const uint64_t DIAS = fechas.size(), HORAS = horas.size();
+    Cita c;
+    uint64_t azar = aleatorio();
+    int m = static_cast<int>(azar % 200);
+    int p = static_cast<int>((azar >> 8) % 300000);
+    c.idCita = static_cast<int>(i + 1);
+    c.idPaciente = 100000 + p;
+    c.idMedico = 500 + m;
+    c.dniPaciente = to_string(10000000 + p * 37);
+    c.nombreMedico = "Medico " + to_string(m);
+    c.especialidad = "Esp " + to_string(m % 24);
+
+    uint64_t dia, hora;
+    if (distribucion == DIST_ORDENADA || distribucion == DIST_INVERTIDA)
+    {
+        uint64_t rango = ((distribucion == DIST_ORDENADA ? i : n - 1 - i) * (5 * DIAS * HORAS)) / n;
+        c.prioridad = 1 + static_cast<int>(rango / (DIAS * HORAS));
+        dia = (rango / HORAS) % DIAS;
+        hora = rango % HORAS;
+    }
+    else if (distribucion == DIST_MUCHOS_EMPATES)
+    {
+        c.prioridad = 1 + static_cast<int>(aleatorio() % 5);
+        dia = aleatorio() % 2;
+        hora = aleatorio() % 4;
+    }
+    else
+    {
+        c.prioridad = 1 + static_cast<int>(aleatorio() % (distribucion == DIST_POCAS_PRIORIDADES ? 2 : 5));
+        dia = aleatorio() % DIAS;
+        hora = aleatorio() % HORAS;
+    }
+    c.fecha = fechas[dia];
+    c.hora = horas[hora];
+    c.claveOrden = empaquetarClaveCita(c, i);
+    return c;
+}
+
+/**
+ * Benchmark de ordenamiento (main --comparar-ordenamiento [n ...]): Quick Sort,
+ * Merge Sort, std::sort, std::stable_sort y Radix Sort sobre vector<Cita> con cinco
+ * distribuciones. Cada corrida emite una fila CSV (o JSONL) con tiempo, comparaciones,
+ * movimientos de citas y reservas de memoria, para seguir la evolucion entre versiones.
+ * Las comparaciones y movimientos se cuentan en una corrida aparte sin cronometrar
+ * (los datos son los mismos en cada repeticion, asi que los conteos tambien).
+ */
+int compararOrdenamientos(const vector<size_t>& tamanos, int repeticiones, bool json, const string& rutaSalida)
+{
+    enum Algoritmo
+    {
+        ALG_QUICK,
+        ALG_MERGE,
+        ALG_STD_SORT,
+        ALG_STD_STABLE,
+        ALG_RADIX,
+        NUM_ALGORITMOS
+    };
+    const char* nombresAlgoritmo[NUM_ALGORITMOS] = { "quickSort", "mergeSort", "std::sort", "std::stable_sort", "radixSort" };
+
+    ofstream archivo;
+    if (!rutaSalida.empty())
+    {
+        ifstream previo(rutaSalida, ios::ate);
+        bool nuevo = !previo || previo.tellg() <= 0;
+        archivo.open(rutaSalida, ios::app);
+        if (!archivo)
+        {
+            cerr << "[ERROR] No se pudo abrir " << rutaSalida << " para escribir." << endl;
+            return 1;
+        }
+        if (nuevo && !json)
+            archivo << "marca,algoritmo,distribucion,n,repeticion,ms,comparaciones,movimientos,reservas,ordenado\n";
+    }
+    else if (!json)
+    {
+        consola() << "marca,algoritmo,distribucion,n,repeticion,ms,comparaciones,movimientos,reservas,ordenado\n";
+    }
+    ostream& salida = rutaSalida.empty() ? consola() : archivo;
+    ostream& resumen = rutaSalida.empty() ? cerr : consola();
+
+    char marca[32];
+    time_t ahora = chrono::system_clock::to_time_t(chrono::system_clock::now());
+    strftime(marca, sizeof(marca), "%Y-%m-%dT%H:%M:%SZ", gmtime(&ahora));
+
+    vector<string> fechas, horas;
+    for (uint64_t d = diasDesdeEpoca("2025-01-01"), k = 0; k < 365; ++k)
+        fechas.push_back(formatearFecha(d + k));
+    for (int s = SLOT_INICIO_JORNADA; s < SLOT_FIN_JORNADA; ++s)
+        horas.push_back(formatearHoraSlot(s));
+
+    auto generar = [&](vector<Cita>& citas, size_t n, int distribucion)
+    {
+        uint64_t estado = 88172645463325252ULL;
+        citas.clear();
+        citas.reserve(n);
+        for (size_t i = 0; i < n; ++i)
+            citas.push_back(citaParaOrdenar(i, n, distribucion, estado, fechas, horas));
+    };
+    auto enOrden = [](const Cita& a, const Cita& b) { return globalComparator(a, b); };
+
+    int resultado = 0;
+    resumen << "\n============ COMPARACION DE ORDENAMIENTOS ============\n";
+    if (!CONTADORES_ORDENAMIENTO)
+        resumen << "(sin -DMEDIR_ORDENAMIENTOS: movimientos de quickSort/mergeSort y reservas se informan como -1)\n";
+    for (size_t n : tamanos)
+    {
+        if (n == 0 || n > static_cast<size_t>(INT32_MAX) || n > MAX_SECUENCIA)
+        {
+            cerr << "[ERROR] Tamano fuera de rango: " << n << endl;
+            resultado = 1;
+            continue;
+        }
+        for (int dist = 0; dist < NUM_DISTRIBUCIONES; ++dist)
+        {
+            double mejorMs = 0;
+            int mejor = -1;
+            for (int alg = 0; alg < NUM_ALGORITMOS; ++alg)
+            {
+                vector<Cita> citas;
+
+                // Corrida de conteo (sin cronometrar)
+                long long comparaciones = 0, movimientos = 0;
+                CitaComparator contando = [&comparaciones](const Cita& a, const Cita& b)
+                {
+                    comparaciones++;
+                    return globalComparator(a, b);
+                };
+                if (alg == ALG_STD_SORT || alg == ALG_STD_STABLE)
+                {
+                    vector<CitaContada> contadas(n);
+                    uint64_t estado = 88172645463325252ULL;
+                    for (size_t i = 0; i < n; ++i)
+                        contadas[i].cita = citaParaOrdenar(i, n, dist, estado, fechas, horas);
+                    auto menor = [&contando](const CitaContada& a, const CitaContada& b) { return contando(a.cita, b.cita); };
+                    CitaContada::movimientos = 0;
+                    if (alg == ALG_STD_SORT)
+                        sort(contadas.begin(), contadas.end(), menor);
+                    else
+                        stable_sort(contadas.begin(), contadas.end(), menor);
+                    movimientos = CitaContada::movimientos;
+                }
+                else
+                {
+                    generar(citas, n, dist);
+                    if (alg == ALG_QUICK)
+                    {
+                        estadisticasQuickSort = EstadisticasQuickSort();
+                        quickSort(citas, 0, static_cast<int>(n) - 1, contando);
+                        movimientos = CONTADORES_ORDENAMIENTO ? estadisticasQuickSort.movimientos : -1;
+                    }
+                    else if (alg == ALG_MERGE)
+                    {
+                        mergeSort(citas, 0, static_cast<int>(n) - 1, contando);
+                        movimientos = CONTADORES_ORDENAMIENTO ? motorMergeSort.estadisticas().movimientos : -1;
+                    }
+                    else
+                    {
+                        movimientos = static_cast<long long>(radixSortCitas(citas));
+                    }
+                }
+
+                vector<double> tiempos;
+                for (int rep = 0; rep < repeticiones; ++rep)
+                {
+                    generar(citas, n, dist);
+                    motorMergeSort.liberarBuffers(); // cada corrida paga su buffer auxiliar
+                    long long reservasAntes = reservasDelHilo;
+                    auto t0 = chrono::steady_clock::now();
+                    switch (alg)
+                    {
+                    case ALG_QUICK:
+                        quickSort(citas, 0, static_cast<int>(n) - 1, globalComparator);
+                        break;
+                    case ALG_MERGE:
+                        mergeSort(citas, 0, static_cast<int>(n) - 1, globalComparator);
+                        break;
+                    case ALG_STD_SORT:
+                        sort(citas.begin(), citas.end(), enOrden);
+                        break;
+                    case ALG_STD_STABLE:
+                        stable_sort(citas.begin(), citas.end(), enOrden);
+                        break;
+                    default:
+                        radixSortCitas(citas);
+                    }
+                    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+                    long long reservas = CONTADORES_ORDENAMIENTO ? reservasDelHilo - reservasAntes : -1;
+                    bool ordenado = is_sorted(citas.begin(), citas.end(), enOrden);
+                    if (!ordenado)
+                        resultado = 1;
+                    tiempos.push_back(ms);
+
+                    if (json)
+                        salida << "{\"marca\":\"" << marca << "\",\"algoritmo\":\"" << nombresAlgoritmo[alg]
+                               << "\",\"distribucion\":\"" << NOMBRES_DISTRIBUCION[dist] << "\",\"n\":" << n
+                               << ",\"repeticion\":" << rep << ",\"ms\":" << fixed << setprecision(3) << ms
+                               << ",\"comparaciones\":" << comparaciones << ",\"movimientos\":" << movimientos
+                               << ",\"reservas\":" << reservas << ",\"ordenado\":" << (ordenado ? "true" : "false") << "}\n";
+                    else
+                        salida << marca << "," << nombresAlgoritmo[alg] << "," << NOMBRES_DISTRIBUCION[dist] << "," << n
+                               << "," << rep << "," << fixed << setprecision(3) << ms << "," << comparaciones << ","
+                               << movimientos << "," << reservas << "," << (ordenado ? 1 : 0) << "\n";
+                }
+                salida.flush();
+                sort(tiempos.begin(), tiempos.end());
+                double mediana = tiempos.empty() ? 0 : tiempos[tiempos.size() / 2];
+                if (mejor < 0 || mediana < mejorMs)
+                {
+                    mejor = alg;
+                    mejorMs = mediana;
+                }
+            }
+            resumen << fixed << setprecision(2) << "n=" << setw(9) << left << n << setw(18) << NOMBRES_DISTRIBUCION[dist]
+                    << right << " mas rapido: " << nombresAlgoritmo[mejor] << " (" << mejorMs << " ms, mediana)\n";
+        }
+    }
+    resumen << "======================================================\n";
+    resumen.unsetf(ios::floatfield);
+    salida.unsetf(ios::floatfield);
+    if (resultado != 0)
+        cerr << "[ERROR] Algun ordenamiento no dejo la agenda en orden." << endl;
+    return resultado;
+}
+
+// --- 4. FUNCIONES DEL MÓDULO (Siguiendo el Diagrama de Flujo) ---
+
+int siguienteIdCita = 1;
+
+/**
+ * Inserta una cita nueva en la agenda manteniendo indices y calendario.
+ * Rechaza ids repetidos y choques de horario del medico (O(1) con el bitmap).
+ */
+bool programarCita(Cita c)
+{
+    if (!idCitaValido(c.idCita) || indiceCitas.buscarPosicion(c.idCita) != -1)
+        return false;
+    uint32_t dia;
+    int slot;
+    bool tieneSlot = slotDeCita(c, dia, slot);
+    if (tieneSlot && !c.cancelada && !calendarioMedicos.reservar(c.idMedico, dia, slot))
+        return false;
+    if (c.claveOrden == 0)
+        asignarClaveOrden(c);
+    siguienteIdCita = max(siguienteIdCita, c.idCita + 1);
+    if (!c.cancelada)
+        disponibilidadMedicos.sumarCarga(c.idMedico, 1);
+    uint32_t instante;
+    if (instanteDe(c.fecha, c.hora, instante))
+        indiceTemporal.insertar(c, instante);
+    citasProgramadas.push_back(std::move(c));
+    indiceCitas.insertar(citasProgramadas.back(), static_cast<int>(citasProgramadas.size() - 1));
+    return true;
+}
+
+/**
+ * Cargar citas del día y cargar información de pacientes y medicos (Inicio)
+ */
+void cargarDatos()
+{
+    // Simulación de carga de pacientes (Hashing)
+    tablaPacientes.asignar({ 101, "23127181", "Carlos Quispe" });
+    tablaPacientes.asignar({ 102, "21200622", "Moises Sacsara" });
+    indiceNombres.reconstruir(tablaPacientes);
+
+    // Simulación de carga de médicos (Hashing)
+    tablaMedicos["Dioses Zarate"] = { 501, "Dioses Zarate", "Cardiología", true };
+    tablaMedicos["Terrel Santos"] = { 502, "Terrel Santos", "Pediatría", true };
+
+    // Simulación de carga de citas
+    citasProgramadas = {
+        {1, 101, 501, "23127181", "Dioses Zarate", "2025-12-01", "10:00", "Cardiología", 2},
+        {2, 102, 502, "21200622", "Terrel Santos", "2025-12-01", "09:00", "Pediatría", 1},
+        {3, 101, 501, "23127181", "Dioses Zarate", "2025-12-02", "08:00", "Cardiología", 3} };
+    for (Cita& c : citasProgramadas)
+        asignarClaveOrden(c);
+    indiceCitas.reconstruir(citasProgramadas);
+    for (const Cita& c : citasProgramadas)
+        siguienteIdCita = max(siguienteIdCita, c.idCita + 1);
+    int choques = reconstruirCalendarioMedicos();
+    if (choques > 0)
+        consola() << "[ADVERTENCIA] " << choques << " citas chocan con otra del mismo medico y horario." << endl;
+    listaEspera.limpiar();
+    listaEspera.agregar({ 4, 999, 0, "33445566", "N/A", "N/A", "N/A", "Medicina General", 1 }); // Prioridad Alta (1)
+    consola() << "\n[INFO] Datos iniciales cargados." << endl;
+}
+
+/**
+ * Lógica de Ordenamiento y Fusión (¿Citas provienen de una sola área?)
+ */
+void iniciarProcesamiento(bool multiplesAreas)
+{
+    consola() << "\n--- INICIO DEL PROCESAMIENTO DE CITAS ---" << endl;
+    if (multiplesAreas)
+    { // Diagrama: No -> Fusionar todas las listas de citas
+        consola() << "[MERGE SORT] Consolidando y ordenando citas de multiples areas (estable)..." << endl;
+        // Cada area se ordena por separado (si hace falta) y luego se fusionan en O(n log k)
+        vector<vector<Cita>> agendasPorArea;
+        int ordenadas = separarAgendasPorArea(agendasPorArea);
+        if (ordenadas > 0)
+            consola() << "[INFO] Merge Sort: " << ordenadas << " de " << agendasPorArea.size()
+                      << " areas llegaron desordenadas y se ordenaron por separado." << endl;
+        consolidarAgendasPorArea(agendasPorArea);
+    }
+    else
+    { // Diagrama: Sí -> Ordenar citas
+        consola() << "[QUICK SORT] Ordenando citas del dia por prioridad y hora (rapido)..." << endl;
+        // Se ejecuta Quick Sort para ordenamiento rápido
+        quickSort(citasProgramadas, 0, citasProgramadas.size() - 1, globalComparator);
+    }
+    sincronizarIndiceCitas();
+    consola() << "[INFO] Citas procesadas correctamente." << endl;
+}
+
+/**
+ * Procesamiento por clave empaquetada: mismo orden que Merge Sort (prioridad,
+ * fecha, hora y orden de ingreso) pero sin comparar strings. Pensado para
+ * agendas de millones de citas.
+ */
+void iniciarProcesamientoRadix()
+{
+    consola() << "\n--- INICIO DEL PROCESAMIENTO DE CITAS ---" << endl;
+    consola() << "[RADIX SORT] Ordenando citas por clave empaquetada de 64 bits..." << endl;
+    radixSortCitas(citasProgramadas);
+    sincronizarIndiceCitas();
+    consola() << "[INFO] Citas procesadas correctamente." << endl;
+}
+
+/**
+ * Buscar paciente (Diagrama: Buscar paciente -> Mostrar datos de paciente)
+ * Usa Hashing O(1) promedio.
+ */
+bool consultarPacientePorDNI(const string& dni)
+{
+    const Paciente* p = tablaPacientes.buscar(dni); // Búsqueda O(1) sobre la tabla plana
+    if (p)
+    {
+        consola() << "  > ENCONTRADO: " << p->nombreCompleto << endl;
+        consola() << "  > DNI: " << p->dni << ", ID: " << p->idPaciente << endl;
+        return true;
+    }
+    consola() << "  > ERROR: Paciente con DNI " << dni << " no encontrado." << endl;
+    return false;
+}
+
+void buscarPacientePorDNI()
+{
+    string dni;
+    consola() << "\n[BUSCAR PACIENTE] Ingrese DNI: ";
+    cin >> dni;
+    consultarPacientePorDNI(dni);
+}
+
+/**
+ * Autocompletado por nombre (indice de trigramas, seccion 2D): prefijos de
+ * palabra y errores de tipeo, sin recorrer la tabla de pacientes.
+ */
+bool buscarPacientesPorNombre(const string& consulta, size_t k)
+{
+    auto inicio = chrono::steady_clock::now();
+    vector<ResultadoNombre> resultados = indiceNombres.buscar(consulta, k, tablaPacientes);
+    double us = chrono::duration<double, micro>(chrono::steady_clock::now() - inicio).count();
+    if (resultados.empty())
+    {
+        consola() << "  > Sin coincidencias para \"" << consulta << "\"." << endl;
+        return false;
+    }
+    consola() << "  > " << resultados.size() << " coincidencia(s) en " << fixed << setprecision(1) << us
+              << " us:" << endl;
+    consola().unsetf(ios::floatfield);
+    for (const ResultadoNombre& r : resultados)
+    {
+        consola() << "    - " << r.paciente->nombreCompleto << " (DNI: " << r.paciente->dni << ", ID: "
+                  << r.paciente->idPaciente << ")";
+        if (r.distancia > 0)
+            consola() << " [aproximado, " << r.distancia << " error(es)]";
+        consola() << endl;
+    }
+    return true;
+}
+
+void buscarPacientePorNombreInteractivo()
+{
+    string consulta;
+    consola() << "\n[BUSCAR PACIENTE] Nombre o parte del nombre: ";
+    cin.ignore();
+    getline(cin, consulta);
+    buscarPacientesPorNombre(consulta, 10);
+}
+
+// Alta de un paciente nuevo (tabla por DNI + indice de nombres)
+bool registrarPaciente(const string& dni, const string& nombre)
+{
+    if (dni.empty() || nombre.empty())
+    {
+        consola() << "  > ERROR: DNI y nombre son obligatorios." << endl;
+        return false;
+    }
+    Paciente p = { tablaPacientes.siguienteId(), dni, nombre };
+    if (!tablaPacientes.insertar(p))
+    {
+        consola() << "  > ERROR: Ya existe un paciente con DNI " << dni << "." << endl;
+        return false;
+    }
+    indiceNombres.agregar(static_cast<uint32_t>(tablaPacientes.size() - 1), nombre);
+    registrarMutacion(Mutacion(MUT_REGISTRAR_PACIENTE).texto(dni).texto(nombre));
+    consola() << "  > EXITO: Paciente " << nombre << " registrado con ID " << p.idPaciente << "." << endl;
+    return true;
+}
+
+void registrarPacienteInteractivo()
+{
+    string dni, nombre;
+    consola() << "\n[REGISTRAR PACIENTE] Ingrese DNI: ";
+    cin >> dni;
+    consola() << "  > Nombre completo: ";
+    cin.ignore();
+    getline(cin, nombre);
+    registrarPaciente(dni, nombre);
+}
+
+/**
+ * Modificar disponibilidad (Diagrama: Modificar disponibilidad -> Actualizar estado del médico)
+ * Usa Hashing O(1) promedio.
+ */
+bool actualizarDisponibilidadMedico(const string& nombreMedico, bool disponible)
+{
+    auto it = tablaMedicos.find(nombreMedico); // Búsqueda O(1)
+
+    if (it != tablaMedicos.end())
+    {
+        it->second.disponible = disponible;
+        disponibilidadMedicos.cambiarDisponibilidad(it->second.idMedico, disponible);
+        consola() << "  > EXITO: Disponibilidad de " << nombreMedico
+            << " actualizada a " << (it->second.disponible ? "DISPONIBLE" : "NO DISPONIBLE") << "." << endl;
+        registrarMutacion(Mutacion(MUT_DISPONIBILIDAD).texto(nombreMedico).entero(disponible ? 1 : 0));
+        return true;
+    }
+    consola() << "  > ERROR: Medico " << nombreMedico << " no encontrado." << endl;
+    return false;
+}
+
+/**
+ * Medicos disponibles de una especialidad (bitset por especialidad, O(k)) con
+ * su carga; marca al menos cargado, que es al que conviene asignar la cita.
+ */
+bool consultarMedicosDisponibles(const string& especialidad)
+{
+    vector<int> ids = disponibilidadMedicos.disponibles(especialidad);
+    if (ids.empty())
+    {
+        consola() << "  > INFO: No hay medicos disponibles de " << especialidad << "." << endl;
+        return false;
+    }
+    int menosCargado = disponibilidadMedicos.menosCargado(especialidad);
+    consola() << "\n--- MEDICOS DISPONIBLES DE " << especialidad << " ---" << endl;
+    for (int id : ids)
+    {
+        consola() << "  #" << id << " " << calendarioMedicos.nombreMedico(id) << " (" << disponibilidadMedicos.carga(id)
+                  << " citas activas)" << (id == menosCargado ? "  <- menos cargado" : "") << endl;
+    }
+    return true;
+}
+
+void consultarMedicosDisponiblesInteractivo()
+{
+    string especialidad;
+    consola() << "\n[MEDICOS DISPONIBLES] Ingrese especialidad: ";
+    cin.ignore();
+    getline(cin, especialidad);
+    consultarMedicosDisponibles(especialidad);
+}
+
+void modificarDisponibilidadMedico()
+{
+    string nombreMedico;
+    int estado;
+    consola() << "\n[MODIFICAR DISPONIBILIDAD] Ingrese nombre del Medico: ";
+    cin.ignore();
+    getline(cin, nombreMedico);
+    consola() << "  > Ingrese nuevo estado (1: DISPONIBLE, 0: NO DISPONIBLE): ";
+    cin >> estado;
+    actualizarDisponibilidadMedico(nombreMedico, estado == 1);
+}
+
+// Entrega una cita cancelada (su slot sigue libre) a un paciente de la lista de espera y la reactiva
+static void reasignarCita(Cita& cita, const Cita& paciente)
+{
+    uint32_t dia;
+    int slot;
+    indiceCitas.cambiarPaciente(cita.idCita, cita.dniPaciente, paciente.dniPaciente);
+    cita.idPaciente = paciente.idPaciente;
+    cita.dniPaciente = paciente.dniPaciente;
+    cita.cancelada = false; // La cita está nuevamente activa
+    disponibilidadMedicos.sumarCarga(cita.idMedico, 1);
+    if (slotDeCita(cita, dia, slot))
+        calendarioMedicos.reservar(cita.idMedico, dia, slot);
+}
+
+/**
+ * Cancelar cita (Diagrama: Cancelar cita -> Actualizar agenda -> Mostrar cita como cancelada)
+ * Incluye Reasignación Automática, salvo con reasignar = false (cancelacion en
+ * lote: los slots se llenan juntos con llenarHuecosEnLote).
+ */
+bool cancelarCitaPorId(int idCita, bool reasignar = true)
+{
+    Cita* citaCancelada = nullptr;
+    uint32_t dia;
+    int slot;
+    // 1. Actualizar agenda/Mostrar cita como cancelada (indice denso por id: O(1))
+    int posicion = indiceCitas.buscarPosicion(idCita);
+    if (posicion != -1 && !citasProgramadas[posicion].cancelada)
+    {
+        citaCancelada = &citasProgramadas[posicion];
+        citaCancelada->cancelada = true;
+        disponibilidadMedicos.sumarCarga(citaCancelada->idMedico, -1);
+        if (slotDeCita(*citaCancelada, dia, slot))
+            calendarioMedicos.liberar(citaCancelada->idMedico, dia, slot);
+        consola() << "  > EXITO: Cita #" << idCita << " marcada como cancelada." << endl;
+    }
+
+    Cita pacientePrioritario;
+    // 2. Reasignación automática: la cola de la especialidad entrega al más prioritario en O(log n)
+    //    (extraerlo también lo elimina de la lista de espera)
+    if (citaCancelada && !reasignar)
+    {
+        registrarMutacion(Mutacion(MUT_CANCELAR_SIN_REASIGNAR).entero(idCita));
+        return true;
+    }
+    if (citaCancelada && listaEspera.extraerMejor(citaCancelada->especialidad, pacientePrioritario))
+    {
+        // 3. Asignar el slot liberado al paciente prioritario
+        reasignarCita(*citaCancelada, pacientePrioritario);
+        consola() << "  > REASIGNACIÓN: Cita reasignada a paciente prioritario (DNI: "
+            << citaCancelada->dniPaciente << ") en el slot liberado." << endl;
+    }
+    else if (citaCancelada)
+    {
+        consola() << "  > INFO: No hay pacientes en lista de espera de " << citaCancelada->especialidad
+            << " para reasignar el slot." << endl;
+    }
+    else
+    {
+        consola() << "  > ERROR: Cita #" << idCita << " no encontrada o ya estaba cancelada." << endl;
+    }
+    if (citaCancelada)
+        registrarMutacion(Mutacion(MUT_CANCELAR_CITA).entero(idCita)); // incluye la reasignacion
+    return citaCancelada != nullptr;
+}
+
+void cancelarCita()
+{
+    int idCita;
+    consola() << "\n[CANCELAR CITA] Ingrese ID de la cita a cancelar: ";
+    if (!(cin >> idCita))
+        return;
+    cancelarCitaPorId(idCita);
+}
+
+// Agrega un paciente a la lista de espera de una especialidad
+bool agregarAListaEspera(const string& dni, const string& especialidad, int prioridad)
+{
+    if (!prioridadValida(prioridad))
+    {
+        consola() << "  > ERROR: Prioridad invalida (use " << PRIORIDAD_MAS_ALTA << " a " << PRIORIDAD_MAS_BAJA
+                  << ")." << endl;
+        return false;
+    }
+    Cita c;
+    const Paciente* p = tablaPacientes.buscar(dni);
+    c.idCita = 0;
+    c.idPaciente = p ? p->idPaciente : -1;
+    c.idMedico = 0;
+    c.dniPaciente = dni;
+    c.nombreMedico = "N/A";
+    c.fecha = "N/A";
+    c.hora = "N/A";
+    c.especialidad = especialidad;
+    c.prioridad = prioridad;
+    listaEspera.agregar(c);
+    registrarMutacion(Mutacion(MUT_AGREGAR_ESPERA).texto(dni).texto(especialidad).entero(prioridad));
+    consola() << "  > EXITO: Paciente (DNI: " << dni << ") en espera para " << especialidad
+        << " con prioridad " << prioridad << ". En espera: " << listaEspera.size() << "." << endl;
+    return true;
+}
+
+// Retira a un paciente de la lista de espera (todas sus especialidades)
+bool retirarDeListaEspera(const string& dni)
+{
+    int eliminadas = listaEspera.eliminarPorDni(dni);
+    if (eliminadas == 0)
+    {
+        consola() << "  > ERROR: El paciente con DNI " << dni << " no esta en lista de espera." << endl;
+        return false;
+    }
+    registrarMutacion(Mutacion(MUT_RETIRAR_ESPERA).texto(dni));
+    consola() << "  > EXITO: " << eliminadas << " entrada(s) del DNI " << dni
+              << " retiradas de la lista de espera." << endl;
+    return true;
+}
+
+/*
+ * Llenado en lote de horarios liberados. Cuando se cancelan muchas citas a la
+ * vez, cada especialidad tiene H slots libres y su cola de espera. El beneficio
+ * de dar el slot s al paciente p es b(p, s) = urgencia(p) * adelanto(s): la
+ * urgencia crece con la prioridad y el adelanto es mayor cuanto antes es el
+ * slot. Como b es positivo y creciente en ambos factores, un matching de
+ * beneficio maximo usa a los H pacientes mas urgentes, y por la desigualdad del
+ * reordenamiento los empareja en el mismo orden: el slot mas temprano para el
+ * mas urgente, y asi sucesivamente (la matriz de beneficios es de Monge, asi que
+ * el greedy coincide con el matching bipartito optimo). Eso es recorrer los
+ * slots por fecha y hora entregando cada uno al siguiente de la cola, que ya
+ * esta ordenada por prioridad e ingreso.
+ * La unica restriccion extra es no darle a un paciente dos citas a la misma
+ * hora: si el siguiente ya tiene una, el slot pasa al que le sigue (mirando
+ * hasta VENTANA_CHOQUES pacientes) y el primero conserva su lugar para el
+ * slot siguiente. Costo: O(H log n) para extraer de las colas, sin matriz H x P.
+ */
+const size_t VENTANA_CHOQUES = 64;
+
+struct ResultadoLlenado
+{
+    size_t huecos = 0;     // citas canceladas con el slot libre y el medico disponible
+    size_t asignados = 0;
+    size_t choques = 0;    // pacientes salteados por tener otra cita a esa hora
+};
+
+// true si el paciente ya tiene una cita activa en esa fecha y hora
+static bool pacienteOcupado(const string& dni, const string& fecha, const string& hora)
+{
+    for (int id : indiceCitas.idsDePaciente(dni))
+    {
+        int pos = indiceCitas.buscarPosicion(id);
+        if (pos != -1 && !citasProgramadas[pos].cancelada && citasProgramadas[pos].hora == hora &&
+            citasProgramadas[pos].fecha == fecha)
+            return true;
+    }
+    return false;
+}
+
+// true si el slot de una cita cancelada se puede volver a ocupar: medico disponible y slot libre
+static bool huecoLlenable(const Cita& c)
+{
+    auto itMed = tablaMedicos.find(c.nombreMedico);
+    uint32_t dia;
+    int slot;
+    return itMed != tablaMedicos.end() && itMed->second.disponible && slotDeCita(c, dia, slot) &&
+           !calendarioMedicos.estaOcupado(c.idMedico, dia, slot);
+}
+
+// Reparte la lista de espera entre los huecos dados (posiciones en citasProgramadas, por fecha y hora)
+static void repartirHuecos(const vector<int>& posiciones, ResultadoLlenado& res)
+{
+    // 1. Slots libres por especialidad, conservando el orden temporal
+    vector<string> especialidades;
+    unordered_map<string, vector<int>> huecosPorEspecialidad;
+    for (int pos : posiciones)
+    {
+        vector<int>& huecos = huecosPorEspecialidad[citasProgramadas[pos].especialidad];
+        if (huecos.empty())
+            especialidades.push_back(citasProgramadas[pos].especialidad);
+        huecos.push_back(pos);
+    }
+    res.huecos += posiciones.size();
+
+    // 2. Por especialidad: el k-esimo slot para el k-esimo paciente de la cola
+    for (const string& especialidad : especialidades)
+    {
+        const vector<int>& huecos = huecosPorEspecialidad[especialidad];
+        vector<uint32_t> candidatos = listaEspera.primeros(especialidad, huecos.size() + VENTANA_CHOQUES);
+        vector<char> usado(candidatos.size(), 0);
+        size_t primero = 0;
+        for (int pos : huecos)
+        {
+            Cita& cita = citasProgramadas[pos];
+            uint32_t dia;
+            int slot;
+            if (!slotDeCita(cita, dia, slot) || calendarioMedicos.estaOcupado(cita.idMedico, dia, slot))
+                continue; // otra cita cancelada del mismo slot ya lo tomo
+            while (primero < candidatos.size() && usado[primero])
+                primero++;
+            size_t elegido = candidatos.size();
+            for (size_t k = primero, mirados = 0; k < candidatos.size() && mirados < VENTANA_CHOQUES; ++k)
+            {
+                if (usado[k])
+                    continue;
+                mirados++;
+                if (!pacienteOcupado(listaEspera.entrada(candidatos[k]).dniPaciente, cita.fecha, cita.hora))
+                {
+                    elegido = k;
+                    break;
+                }
+                res.choques++;
+            }
+            if (elegido == candidatos.size())
+                continue;
+            usado[elegido] = 1;
+            Cita paciente;
+            listaEspera.extraer(candidatos[elegido], paciente);
+            reasignarCita(cita, paciente);
+            res.asignados++;
+        }
+    }
+}
+
+// Asigna la lista de espera a todos los horarios liberados desde 'desde' (minutos desde 1970)
+ResultadoLlenado llenarHuecosEnLote(uint32_t desde)
+{
+    ResultadoLlenado res;
+    vector<int> posiciones; // ya en orden de fecha y hora (indice temporal)
+    indiceTemporal.secuencia(-1, "")->recorrer({ desde, INT32_MIN }, UINT32_MAX, [&](const EntradaTemporal& e)
+    {
+        int pos = indiceCitas.buscarPosicion(e.idCita);
+        if (pos != -1 && citasProgramadas[pos].cancelada && huecoLlenable(citasProgramadas[pos]))
+            posiciones.push_back(pos);
+        return true;
+    });
+    repartirHuecos(posiciones, res);
+    if (res.asignados > 0)
+        registrarMutacion(Mutacion(MUT_LLENAR_HUECOS).entero(static_cast<int32_t>(desde)));
+    return res;
+}
+
+// Igual, pero solo con los horarios de las citas dadas (las recien canceladas en un lote)
+ResultadoLlenado llenarHuecosDeCitas(const vector<int>& ids)
+{
+    ResultadoLlenado res;
+    vector<pair<EntradaTemporal, int>> huecos;
+    for (int id : ids)
+    {
+        int pos = indiceCitas.buscarPosicion(id);
+        uint32_t instante;
+        if (pos == -1 || !citasProgramadas[pos].cancelada || !huecoLlenable(citasProgramadas[pos]) ||
+            !instanteDe(citasProgramadas[pos].fecha, citasProgramadas[pos].hora, instante))
+            continue;
+        huecos.push_back({ { instante, id }, pos });
+    }
+    // El mismo orden que el indice temporal; un id repetido en el lote cuenta una vez
+    sort(huecos.begin(), huecos.end(), [](const pair<EntradaTemporal, int>& a, const pair<EntradaTemporal, int>& b)
+    {
+        return a.first < b.first;
+    });
+    vector<int> posiciones;
+    for (size_t i = 0; i < huecos.size(); ++i)
+        if (i == 0 || huecos[i].second != huecos[i - 1].second)
+            posiciones.push_back(huecos[i].second);
+    repartirHuecos(posiciones, res);
+    if (res.asignados > 0)
+    {
+        Mutacion m(MUT_LLENAR_HUECOS_CITAS);
+        m.entero(static_cast<int32_t>(ids.size()));
+        for (int id : ids)
+            m.entero(id);
+        registrarMutacion(m);
+    }
+    return res;
+}
+
+// Informe comun de los llenados en lote
+static void informarLlenado(const ResultadoLlenado& res, size_t enEspera, chrono::steady_clock::time_point inicio)
+{
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - inicio).count();
+    consola() << "  > LLENADO EN LOTE: " << res.asignados << " de " << res.huecos << " horarios liberados asignados ("
+              << enEspera << " pacientes en espera, " << res.choques << " salteados por choque de horario) en " << fixed
+              << setprecision(1) << ms << " ms." << endl;
+    consola().unsetf(ios::floatfield);
+}
+
+bool llenarHuecos(uint32_t desde)
+{
+    auto inicio = chrono::steady_clock::now();
+    size_t enEspera = listaEspera.size();
+    ResultadoLlenado res = llenarHuecosEnLote(desde);
+    informarLlenado(res, enEspera, inicio);
+    return res.asignados > 0;
+}
+
+/*
+ * Cancela varias citas sin reasignarlas una por una y llena juntos los horarios
+ * que este lote libero. Las cancelaciones anteriores que quedaron sin cubrir no
+ * se tocan: para esas esta llenar_huecos, que recorre desde una fecha dada.
+ */
+bool cancelarCitasEnLote(const vector<int>& ids)
+{
+    vector<int> liberadas;
+    for (int id : ids)
+        if (cancelarCitaPorId(id, false))
+            liberadas.push_back(id);
+    consola() << "  > EXITO: " << liberadas.size() << " de " << ids.size() << " citas canceladas." << endl;
+    if (liberadas.empty())
+        return false;
+    auto inicio = chrono::steady_clock::now();
+    size_t enEspera = listaEspera.size();
+    informarLlenado(llenarHuecosDeCitas(liberadas), enEspera, inicio);
+    return true;
+}
+
+void llenarHuecosInteractivo()
+{
+    string fecha, hora;
+    uint32_t desde = 0;
+    consola() << "\n[LLENAR HORARIOS LIBERADOS] Desde (YYYY-MM-DD HH:MM, o 0 para todos): ";
+    cin >> fecha;
+    if (fecha != "0" && (!(cin >> hora) || !instanteDe(fecha, hora, desde)))
+    {
+        consola() << "  > ERROR: Fecha u hora invalida (use YYYY-MM-DD y HH:MM)." << endl;
+        return;
+    }
+    llenarHuecos(desde);
+}
+
+// Horizonte (en dias) de la busqueda de horarios libres
+const int DIAS_BUSQUEDA_HUECO = 30;
+
+static bool mostrarHueco(const HuecoLibre& h)
+{
+    if (h.slot == -1)
+    {
+        consola() << "  > INFO: No hay horarios libres en los proximos " << DIAS_BUSQUEDA_HUECO << " dias." << endl;
+        return false;
+    }
+    consola() << "  > HORARIO LIBRE: " << calendarioMedicos.nombreMedico(h.idMedico) << " (ID " << h.idMedico
+        << ") el " << formatearFecha(h.dia) << " a las " << formatearHoraSlot(h.slot) << "." << endl;
+    return true;
+}
+
+// Proximo horario libre de un medico desde fecha/hora (bitmap: O(dias * palabras))
+bool buscarHuecoMedico(int idMedico, const string& fecha, const string& hora)
+{
+    uint64_t dia = diasDesdeEpoca(fecha);
+    if (dia == MAX_DIA)
+    {
+        consola() << "  > ERROR: Fecha invalida (use YYYY-MM-DD)." << endl;
+        return false;
+    }
+    uint64_t minuto = minutoDelDia(hora);
+    int slotDesde = (minuto == MAX_MINUTO) ? 0 : static_cast<int>(minuto) / MINUTOS_POR_SLOT;
+    return mostrarHueco(calendarioMedicos.siguienteLibreMedico(idMedico, static_cast<uint32_t>(dia), slotDesde,
+                                                               DIAS_BUSQUEDA_HUECO));
+}
+
+// Proximo horario libre de cualquier medico disponible de la especialidad
+bool buscarHuecoEspecialidad(const string& especialidad, const string& fecha, const string& hora)
+{
+    uint64_t dia = diasDesdeEpoca(fecha);
+    if (dia == MAX_DIA)
+    {
+        consola() << "  > ERROR: Fecha invalida (use YYYY-MM-DD)." << endl;
+        return false;
+    }
+    uint64_t minuto = minutoDelDia(hora);
+    int slotDesde = (minuto == MAX_MINUTO) ? 0 : static_cast<int>(minuto) / MINUTOS_POR_SLOT;
+    return mostrarHueco(calendarioMedicos.siguienteLibreEspecialidad(especialidad, static_cast<uint32_t>(dia),
+                                                                     slotDesde, DIAS_BUSQUEDA_HUECO));
+}
+
+// Agenda una cita nueva validando el horario del medico
+bool agendarCita(const string& dni, int idMedico, const string& fecha, const string& hora, int prioridad)
+{
+    if (!prioridadValida(prioridad))
+    {
+        consola() << "  > ERROR: Prioridad invalida (use " << PRIORIDAD_MAS_ALTA << " a " << PRIORIDAD_MAS_BAJA
+                  << ")." << endl;
+        return false;
+    }
+    auto itMed = tablaMedicos.find(calendarioMedicos.nombreMedico(idMedico));
+    if (itMed == tablaMedicos.end())
+    {
+        consola() << "  > ERROR: Medico #" << idMedico << " no encontrado." << endl;
+        return false;
+    }
+    Cita c;
+    c.idCita = siguienteIdCita;
+    const Paciente* pac = tablaPacientes.buscar(dni);
+    c.idPaciente = pac ? pac->idPaciente : -1;
+    c.idMedico = idMedico;
+    c.dniPaciente = dni;
+    c.nombreMedico = itMed->second.nombreCompleto;
+    c.fecha = fecha;
+    c.hora = hora;
+    c.especialidad = itMed->second.especialidad;
+    c.prioridad = prioridad;
+
+    uint32_t dia;
+    int slot;
+    if (!slotDeCita(c, dia, slot))
+    {
+        consola() << "  > ERROR: Fecha u hora invalida (use YYYY-MM-DD y HH:MM)." << endl;
+        return false;
+    }
+    if (!programarCita(c))
+    {
+        consola() << "  > ERROR: " << c.nombreMedico << " ya tiene una cita el " << fecha << " a las "
+            << formatearHoraSlot(slot) << "." << endl;
+        return false;
+    }
+    consola() << "  > EXITO: Cita #" << c.idCita << " agendada con " << c.nombreMedico << " el " << fecha
+        << " a las " << hora << "." << endl;
+    registrarMutacion(Mutacion(MUT_AGENDAR_CITA).texto(dni).entero(idMedico).texto(fecha).texto(hora).entero(prioridad));
+    return true;
+}
+
+void buscarHuecoInteractivo()
+{
+    int criterio;
+    string fecha, hora;
+    consola() << "\n[HORARIO LIBRE] Buscar por (1: ID Medico, 2: Especialidad): ";
+    cin >> criterio;
+    if (criterio == 1)
+    {
+        int idMedico;
+        consola() << "  > ID del medico: ";
+        cin >> idMedico;
+        consola() << "  > Desde fecha (YYYY-MM-DD) y hora (HH:MM): ";
+        cin >> fecha >> hora;
+        buscarHuecoMedico(idMedico, fecha, hora);
+    }
+    else if (criterio == 2)
+    {
+        string especialidad;
+        consola() << "  > Especialidad: ";
+        cin.ignore();
+        getline(cin, especialidad);
+        consola() << "  > Desde fecha (YYYY-MM-DD) y hora (HH:MM): ";
+        cin >> fecha >> hora;
+        buscarHuecoEspecialidad(especialidad, fecha, hora);
+    }
+    else
+    {
+        consola() << "  > ERROR: Criterio no valido." << endl;
+    }
+}
+
+void agendarCitaInteractivo()
+{
+    string dni, fecha, hora;
+    int idMedico, prioridad;
+    consola() << "\n[AGENDAR CITA] DNI del paciente: ";
+    cin >> dni;
+    consola() << "  > ID del medico: ";
+    cin >> idMedico;
+    consola() << "  > Fecha (YYYY-MM-DD) y hora (HH:MM): ";
+    cin >> fecha >> hora;
+    consola() << "  > Prioridad (1: Alta - 5: Baja): ";
+    cin >> prioridad;
+    agendarCita(dni, idMedico, fecha, hora, prioridad);
+}
+
+void agregarAListaEsperaInteractivo()
+{
+    string dni, especialidad;
+    int prioridad;
+    consola() << "\n[LISTA DE ESPERA] Ingrese DNI: ";
+    cin >> dni;
+    consola() << "  > Especialidad requerida: ";
+    cin.ignore();
+    getline(cin, especialidad);
+    consola() << "  > Prioridad (1: Alta - 5: Baja): ";
+    cin >> prioridad;
+    agregarAListaEspera(dni, especialidad, prioridad);
+}
+
+void retirarDeListaEsperaInteractivo()
+{
+    string dni;
+    consola() << "\n[LISTA DE ESPERA] Ingrese DNI del paciente a retirar: ";
+    cin >> dni;
+    retirarDeListaEspera(dni);
+}
+
+void imprimirFilaCita(const Cita& cita)
+{
+    string estado = cita.cancelada ? "CANCELADA" : "ACTIVA";
+    consola() << std::left << setw(5) << "ID:" << setw(5) << cita.idCita
+        << setw(15) << "Medico:" << setw(20) << cita.nombreMedico
+        << setw(12) << "Fecha:" << setw(12) << cita.fecha
+        << setw(10) << "Hora:" << setw(6) << cita.hora
+        << setw(15) << "Prioridad:" << setw(3) << cita.prioridad
+        << setw(10) << "Estado:" << estado << endl;
+}
+
+// Muestra la agenda completa (opcion 4 del menu principal)
+void mostrarCitasProgramadas()
+{
+    consola() << "\n--- LISTA DE CITAS PROGRAMADAS ---" << endl;
+    for (const auto& cita : citasProgramadas)
+        imprimirFilaCita(cita);
+}
+
+// Muestra las citas de una lista de ids usando el indice denso. Devuelve cuantas se mostraron.
+size_t mostrarCitasPorIds(const vector<int>& ids)
+{
+    for (int id : ids)
+    {
+        int pos = indiceCitas.buscarPosicion(id);
+        if (pos != -1)
+            imprimirFilaCita(citasProgramadas[pos]);
+    }
+    if (ids.empty())
+        consola() << "  > INFO: No hay citas para el criterio indicado." << endl;
+    return ids.size();
+}
+
+// Consultas indexadas: O(1) promedio para ubicar la lista + O(k) para mostrarla
+size_t consultarCitasPorMedico(int idMedico)
+{
+    consola() << "\n--- CITAS DEL MEDICO #" << idMedico << " ---" << endl;
+    return mostrarCitasPorIds(indiceCitas.idsDeMedico(idMedico));
+}
+
+size_t consultarCitasPorFecha(const string& fecha)
+{
+    consola() << "\n--- CITAS DEL " << fecha << " ---" << endl;
+    return mostrarCitasPorIds(indiceCitas.idsEnFecha(fecha));
+}
+
+size_t consultarCitasPorPaciente(const string& dni)
+{
+    consola() << "\n--- CITAS DEL PACIENTE " << dni << " ---" << endl;
+    return mostrarCitasPorIds(indiceCitas.idsDePaciente(dni));
+}
+
+// Ventana de la agenda: [desde, hasta] con filtro opcional y paginada por (instante, idCita)
+struct ConsultaRango
+{
+    uint32_t desde = 0;
+    uint32_t hasta = UINT32_MAX;
+    int idMedico = -1;          // -1: sin filtro por medico
+    string especialidad;        // vacio: sin filtro por especialidad
+    size_t limite = 50;         // filas por pagina
+    int tras = INT32_MIN;       // en el instante 'desde', saltear ids <= tras (pagina siguiente)
+};
+
+/**
+ * Lee "<fecha> <hora> <fecha> <hora> [limite N] [tras idCita] [medico id | especialidad nombre]".
+ * Para pedir la pagina siguiente se repite la consulta desde la fecha y hora de
+ * la ultima cita recibida con "tras <su id>".
+ */
+bool leerConsultaRango(istringstream& args, ConsultaRango& q)
+{
+    string f1, h1, f2, h2, opcion;
+    if (!(args >> f1 >> h1 >> f2 >> h2) || !instanteDe(f1, h1, q.desde) || !instanteDe(f2, h2, q.hasta))
+        return false;
+    while (args >> opcion)
+    {
+        if (opcion == "limite" && args >> q.limite)
+            continue;
+        if (opcion == "tras" && args >> q.tras)
+            continue;
+        if (opcion == "medico" && args >> q.idMedico)
+            continue;
+        if (opcion == "especialidad")
+        {
+            args >> ws;
+            getline(args, q.especialidad);
+            continue;
+        }
+        return false;
+    }
+    return q.limite > 0;
+}
+
+/**
+ * Entrega a 'visitar' las citas activas de la ventana en orden de fecha y hora,
+ * hasta 'limite' (O(log n + k) sobre el indice temporal). Devuelve true si la
+ * pagina se lleno, es decir, si puede haber mas.
+ */
+template <typename Visitar>
+bool recorrerAgendaPorRango(const ConsultaRango& q, Visitar visitar)
+{
+    const SecuenciaTemporal* secuencia = indiceTemporal.secuencia(q.idMedico, q.especialidad);
+    if (!secuencia || q.desde > q.hasta)
+        return false;
+    size_t entregadas = 0;
+    secuencia->recorrer({ q.desde, q.tras }, q.hasta, [&](const EntradaTemporal& e)
+    {
+        int pos = indiceCitas.buscarPosicion(e.idCita);
+        if (pos == -1 || citasProgramadas[pos].cancelada)
+            return true;
+        visitar(citasProgramadas[pos]);
+        return ++entregadas < q.limite;
+    });
+    return entregadas == q.limite;
+}
+
+// Muestra una pagina de la ventana; devuelve en 'siguiente' la consulta de la pagina que sigue
+size_t consultarAgendaPorRango(const ConsultaRango& q, ConsultaRango& siguiente)
+{
+    size_t filas = 0;
+    const Cita* ultima = nullptr;
+    bool hayMas = recorrerAgendaPorRango(q, [&](const Cita& c)
+    {
+        imprimirFilaCita(c);
+        ultima = &c;
+        filas++;
+    });
+    if (filas == 0)
+        consola() << "  > INFO: No hay citas activas en el rango indicado." << endl;
+    siguiente = q;
+    siguiente.limite = hayMas ? q.limite : 0;
+    if (hayMas)
+    {
+        instanteDe(ultima->fecha, ultima->hora, siguiente.desde);
+        siguiente.tras = ultima->idCita;
+        consola() << "  > Pagina completa; continua desde " << ultima->fecha << " " << ultima->hora << " tras la cita #"
+                  << ultima->idCita << "." << endl;
+    }
+    return filas;
+}
+
+void consultarAgendaPorRangoInteractivo()
+{
+    string f1, h1, f2, h2;
+    int filtro;
+    consola() << "\n[AGENDA POR RANGO] Desde (YYYY-MM-DD HH:MM): ";
+    cin >> f1 >> h1;
+    consola() << "  > Hasta (YYYY-MM-DD HH:MM): ";
+    cin >> f2 >> h2;
+    ConsultaRango q;
+    if (!instanteDe(f1, h1, q.desde) || !instanteDe(f2, h2, q.hasta))
+    {
+        consola() << "  > ERROR: Fecha u hora invalida (use YYYY-MM-DD y HH:MM)." << endl;
+        return;
+    }
+    consola() << "  > Filtro (0: Ninguno, 1: ID Medico, 2: Especialidad): ";
+    cin >> filtro;
+    if (filtro == 1)
+    {
+        consola() << "  > ID Medico: ";
+        cin >> q.idMedico;
+    }
+    else if (filtro == 2)
+    {
+        consola() << "  > Especialidad: ";
+        cin.ignore();
+        getline(cin, q.especialidad);
+    }
+    consola() << "  > Citas por pagina: ";
+    if (!(cin >> q.limite) || q.limite == 0)
+        return;
+
+    consola() << "\n--- CITAS DEL " << f1 << " " << h1 << " AL " << f2 << " " << h2 << " ---" << endl;
+    char seguir = 's';
+    while (q.limite > 0 && (seguir == 's' || seguir == 'S'))
+    {
+        ConsultaRango siguiente;
+        consultarAgendaPorRango(q, siguiente);
+        q = siguiente;
+        if (q.limite > 0)
+        {
+            consola() << "  > Siguiente pagina? (s/n): ";
+            cin >> seguir;
+        }
+    }
+}
+
+void consultarCitasInteractivo()
+{
+    int criterio;
+    consola() << "\n[CONSULTAR CITAS] Criterio (1: ID Medico, 2: Fecha YYYY-MM-DD, 3: DNI Paciente): ";
+    cin >> criterio;
+    consola() << "  > Valor: ";
+    if (criterio == 1)
+    {
+        int idMedico;
+        cin >> idMedico;
+        consultarCitasPorMedico(idMedico);
+        return;
+    }
+    string valor;
+    cin >> valor;
+    if (criterio == 2)
+        consultarCitasPorFecha(valor);
+    else if (criterio == 3)
+        consultarCitasPorPaciente(valor);
+    else
+        consola() << "  > ERROR: Criterio no valido." << endl;
+}
+
+// --- 4B. OPTIMIZACIÓN DE RUTA DE AMBULANCIA (GRAFO + BFS) ---
+
+struct AristaAmbulancia
+{
+    int u;     // nodo origen
+    int v;     // nodo destino
+    int peso;  // tiempo estimado (minutos). Puede ser negativo como penalización.
+};
+
+int numNodosAmbulancia = 0;
+
+/*
+ * Red vial en formato CSR (compressed sparse row): los arcos que salen de u son
+ * [inicio[u], inicio[u+1]) en los arreglos contiguos destino/peso, ordenados por
+ * destino. inverso[a] es el arco de la misma calle en sentido contrario, asi un
+ * cambio de trafico escribe exactamente dos pesos sin reconstruir nada. Los arcos
+ * paralelos (una calle repetida) se funden al construir con el menor peso, el
+ * unico que ve una ruta minima; de todos modos un cambio los igualaba.
+ */
+class GrafoCSR
+{
+private:
+    int nodos = 0;
+    vector<int> inicio;
+    vector<int> destino;
+    vector<int> peso;
+    vector<int> inverso;
+    int negativos = 0;
+    int asimetricos = 0;   // arcos sin inverso o con un peso distinto al de su inverso
+    long long versionPesos = 0; // sube con cada construccion o cambio de peso
+
+    bool esAsimetrico(int a) const
+    {
+        return inverso[a] < 0 || peso[inverso[a]] != peso[a];
+    }
+
+    void fijarPeso(int a, int nuevo)
+    {
+        negativos += (nuevo < 0) - (peso[a] < 0);
+        peso[a] = nuevo;
+    }
+
+public:
+    void construir(int numNodos, vector<AristaAmbulancia> arcos)
+    {
+        sort(arcos.begin(), arcos.end(), [](const AristaAmbulancia& a, const AristaAmbulancia& b)
+             { return tie(a.u, a.v, a.peso) < tie(b.u, b.v, b.peso); });
+        arcos.erase(unique(arcos.begin(), arcos.end(), [](const AristaAmbulancia& a, const AristaAmbulancia& b)
+                           { return a.u == b.u && a.v == b.v; }),
+                    arcos.end());
+        nodos = numNodos;
+        versionPesos++;
+        inicio.assign(nodos + 1, 0);
+        destino.resize(arcos.size());
+        peso.resize(arcos.size());
+        negativos = 0;
+        for (size_t a = 0; a < arcos.size(); ++a)
+        {
+            inicio[arcos[a].u + 1]++;
+            destino[a] = arcos[a].v;
+            peso[a] = arcos[a].peso;
+            negativos += arcos[a].peso < 0;
+        }
+        for (int v = 0; v < nodos; ++v)
+            inicio[v + 1] += inicio[v];
+        inverso.resize(arcos.size());
+        for (size_t a = 0; a < arcos.size(); ++a)
+            inverso[a] = arco(arcos[a].v, arcos[a].u);
+        asimetricos = 0;
+        for (size_t a = 0; a < arcos.size(); ++a)
+            asimetricos += esAsimetrico(static_cast<int>(a));
+    }
+
+    int numNodos() const
+    {
+        return nodos;
+    }
+
+    size_t numArcos() const
+    {
+        return destino.size();
+    }
+
+    int arcosNegativos() const
+    {
+        return negativos;
+    }
+
+    // Las estructuras derivadas del mapa (tabla de tiempos) comparan esta version para saber si siguen vigentes
+    long long version() const
+    {
+        return versionPesos;
+    }
+
+    // Todo arco tiene su inverso con el mismo peso: el tiempo de u a v es el de v a u
+    bool esSimetrico() const
+    {
+        return asimetricos == 0;
+    }
+
+    int primerArco(int u) const
+    {
+        return inicio[u];
+    }
+
+    int finArcos(int u) const
+    {
+        return inicio[u + 1];
+    }
+
+    int destinoDe(int a) const
+    {
+        return destino[a];
+    }
+
+    int pesoDe(int a) const
+    {
+        return peso[a];
+    }
+
+    // Arco u->v, o -1. Busqueda binaria en la fila de u: el grado de un cruce es chico, en la practica O(1)
+    int arco(int u, int v) const
+    {
+        if (u < 0 || u >= nodos)
+            return -1;
+        auto fin = destino.begin() + inicio[u + 1];
+        auto it = lower_bound(destino.begin() + inicio[u], fin, v);
+        return (it != fin && *it == v) ? static_cast<int>(it - destino.begin()) : -1;
+    }
+
+    // Nuevo peso de la calle u-v en ambos sentidos; false si no existe
+    bool cambiarPeso(int u, int v, int nuevo)
+    {
+        int a = arco(u, v);
+        if (a < 0)
+            a = arco(v, u);
+        if (a < 0)
+            return false;
+        int b = inverso[a];
+        asimetricos -= esAsimetrico(a) + (b >= 0 && esAsimetrico(b));
+        fijarPeso(a, nuevo);
+        if (b >= 0)
+            fijarPeso(b, nuevo);
+        asimetricos += esAsimetrico(a) + (b >= 0 && esAsimetrico(b));
+        versionPesos++;
+        return true;
+    }
+
+    // Lista plana de arcos (snapshot y algoritmos de referencia)
+    vector<AristaAmbulancia> arcos() const
+    {
+        vector<AristaAmbulancia> lista;
+        lista.reserve(destino.size());
+        for (int u = 0; u < nodos; ++u)
+            for (int a = inicio[u]; a < inicio[u + 1]; ++a)
+                lista.push_back({ u, destino[a], peso[a] });
+        return lista;
+    }
+};
+
+GrafoCSR grafoVial;
+
+// Modelo simple de ambulancias y emergencias
+struct Ambulancia
+{
+    int idAmbulancia;
+    int nodoActual;
+    bool disponible;
+};
+
+struct EmergenciaRuta
+{
+    int idEmergencia;
+    int nodoDestino;
+    bool atendida;
+    int idAmbulanciaAsignada;
+    vector<int> ruta;
+    int tiempoEstimado; // en minutos
+};
+
+vector<Ambulancia> ambulancias;
+vector<EmergenciaRuta> emergencias;
+int contadorEmergencias = 1;
+
+const int INF_TIEMPO = 1000000000;
+
+/*
+ * Motor de rutas. Casi todos los pesos son tiempos positivos; solo una
+ * "penalizacion" ingresada con actualizarPesoArista puede ser negativa, asi que
+ * el grafo lleva la cuenta de arcos negativos: sin ninguno se usa Dijkstra con heap
+ * binario, O((V + E) log V); con alguna, Bellman-Ford en su variante SPFA, que
+ * detecta ciclos negativos. Mientras no haya arcos negativos los dos desempatan
+ * igual (entre predecesores con la misma distancia gana el de menor id, salvo por
+ * aristas de peso 0), por lo que reconstruirRuta devuelve la misma ruta con
+ * cualquiera de ellos. Con arcos negativos solo corre SPFA y no desempata: queda
+ * el predecesor de la ultima mejora estricta. Desempatar ahi podria cerrar un
+ * ciclo de tiempo 0 entre predecesores (a->b con +1 y b->a con -1), y la ruta
+ * reconstruida nunca llegaria al origen.
+ */
+
+// Inicializa grafo urbano ponderado y ambulancias de ejemplo
+void cargarGrafoAmbulancia()
+{
+    // Modelo urbano simple de 6 nodos
+    // 0: Hospital Central
+    // 1: Cruce Norte
+    // 2: Cruce Sur
+    // 3: Avenida Rapida
+    // 4: Zona Residencial
+    // 5: Zona Industrial
+    numNodosAmbulancia = 6;
+
+    vector<AristaAmbulancia> aristas;
+
+    auto addEdge = [&aristas](int u, int v, int peso)
+    {
+        aristas.push_back({u, v, peso});
+        aristas.push_back({v, u, peso}); // grafo no dirigido: se agrega en ambos sentidos
+    };
+
+    addEdge(0, 1, 5);   // Hospital -> Cruce Norte (5 min)
+    addEdge(0, 2, 7);   // Hospital -> Cruce Sur (7 min)
+    addEdge(1, 3, 3);   // Cruce Norte -> Av. Rapida (3 min)
+    addEdge(2, 3, 2);   // Cruce Sur -> Av. Rapida (2 min)
+    addEdge(3, 4, 6);   // Av. Rapida -> Zona Residencial (6 min)
+    addEdge(3, 5, 4);   // Av. Rapida -> Zona Industrial (4 min)
+    addEdge(4, 5, 5);   // Residencial <-> Industrial
+    grafoVial.construir(numNodosAmbulancia, std::move(aristas));
+
+    // Ambulancias disponibles en diferentes nodos de la ciudad
+    ambulancias.clear();
+    ambulancias.push_back({1, 0, true}); // Ambulancia 1 en Hospital Central
+    ambulancias.push_back({2, 1, true}); // Ambulancia 2 en Cruce Norte
+    ambulancias.push_back({3, 5, true}); // Ambulancia 3 en Zona Industrial
+
+    consola() << "\n[INFO] Grafo urbano ponderado de ambulancias cargado." << endl;
+}
+
+/**
+ * Carga un mapa vial desde un archivo de texto (p. ej. el de main --generar):
+ *   nodos,<N>
+ *   via,<u>,<v>,<minutos>              (calle no dirigida)
+ *   ambulancia,<id>,<nodo>[,<0|1>]     (disponible por defecto)
+ * Las lineas vacias y las que empiezan con '#' se ignoran. Si el archivo es
+ * invalido no se modifica el grafo actual.
+ */
+bool cargarGrafoDesdeArchivo(const string& ruta)
+{
+    ifstream archivo(ruta);
+    if (!archivo)
+    {
+        consola() << "[ERROR] No se pudo abrir el mapa vial " << ruta << ".\n";
+        return false;
+    }
+    int nodos = -1;
+    vector<AristaAmbulancia> aristas;
+    vector<Ambulancia> flota;
+    string linea;
+    for (long long numLinea = 1; getline(archivo, linea); ++numLinea)
+    {
+        if (!linea.empty() && linea.back() == '\r')
+            linea.pop_back();
+        if (linea.empty() || linea[0] == '#')
+            continue;
+        string_view campos[5];
+        size_t n = separarCamposCSV(linea, campos, 5);
+        int a = 0, b = 0, c = 0;
+        bool ok;
+        if (campos[0] == "nodos")
+            ok = n == 2 && aristas.empty() && leerEnteroCSV(campos[1], nodos) && nodos > 0;
+        else if (campos[0] == "via")
+            ok = n == 4 && leerEnteroCSV(campos[1], a) && leerEnteroCSV(campos[2], b) && leerEnteroCSV(campos[3], c) &&
+                 a >= 0 && a < nodos && b >= 0 && b < nodos;
+        else if (campos[0] == "ambulancia")
+            ok = (n == 3 || n == 4) && leerEnteroCSV(campos[1], a) && leerEnteroCSV(campos[2], b) && b >= 0 &&
+                 b < nodos && (n == 3 || leerEnteroCSV(campos[3], c));
+        else
+            ok = false;
+        if (!ok)
+        {
+            consola() << "[ERROR] Linea " << numLinea << " invalida en el mapa vial " << ruta << ".\n";
+            return false;
+        }
+        if (campos[0] == "via")
+        {
+            aristas.push_back({ a, b, c });
+            aristas.push_back({ b, a, c });
+        }
+        else if (campos[0] == "ambulancia")
+            flota.push_back({ a, b, n == 3 || c != 0 });
+    }
+    if (nodos <= 0)
+    {
+        consola() << "[ERROR] El mapa vial " << ruta << " no indica el numero de nodos.\n";
+        return false;
+    }
+    numNodosAmbulancia = nodos;
+    grafoVial.construir(nodos, std::move(aristas));
+    ambulancias.swap(flota);
+    consola() << "\n[INFO] Mapa vial cargado: " << numNodosAmbulancia << " nodos, " << grafoVial.numArcos() / 2
+              << " vias, " << ambulancias.size() << " ambulancias." << endl;
+    return true;
+}
+
+/*
+ * Relaja u->v; true si mejoro la distancia. Con 'desempatar', en un empate por una
+ * arista de peso > 0 queda el predecesor de menor id; quien busca lo decide una vez
+ * por consulta (solo sin arcos negativos, ver arriba).
+ */
+static inline bool relajarArista(int u, int v, int peso, vector<int>& dist, vector<int>& padre, bool desempatar)
+{
+    int nueva = dist[u] + peso;
+    if (nueva < dist[v])
+    {
+        dist[v] = nueva;
+        padre[v] = u;
+        return true;
+    }
+    if (desempatar && nueva == dist[v] && peso > 0 && u < padre[v])
+        padre[v] = u;
+    return false;
+}
+
+// Dijkstra con heap binario (requiere pesos no negativos)
+bool dijkstra(int origen, vector<int>& dist, vector<int>& padre)
+{
+    dist.assign(numNodosAmbulancia, INF_TIEMPO);
+    padre.assign(numNodosAmbulancia, -1);
+    dist[origen] = 0;
+
+    priority_queue<pair<int, int>, vector<pair<int, int>>, greater<pair<int, int>>> heap;
+    heap.push({ 0, origen });
+    while (!heap.empty())
+    {
+        auto [d, u] = heap.top();
+        heap.pop();
+        if (d > dist[u])
+            continue; // entrada vieja: u ya salio con una distancia menor
+        for (int a = grafoVial.primerArco(u); a < grafoVial.finArcos(u); ++a)
+        {
+            int v = grafoVial.destinoDe(a);
+            if (relajarArista(u, v, grafoVial.pesoDe(a), dist, padre, true))
+                heap.push({ dist[v], v });
+        }
+    }
+    return true;
+}
+
+// Bellman-Ford (SPFA): solo se vuelven a relajar los nodos cuya distancia cambio
+bool bellmanFord(int origen, vector<int>& dist, vector<int>& padre)
+{
+    dist.assign(numNodosAmbulancia, INF_TIEMPO);
+    padre.assign(numNodosAmbulancia, -1);
+    dist[origen] = 0;
+
+    bool desempatar = grafoVial.arcosNegativos() == 0;
+    vector<int> aristasEnRuta(numNodosAmbulancia, 0);
+    vector<char> enCola(numNodosAmbulancia, 0);
+    deque<int> cola = { origen };
+    enCola[origen] = 1;
+    while (!cola.empty())
+    {
+        int u = cola.front();
+        cola.pop_front();
+        enCola[u] = 0;
+        for (int a = grafoVial.primerArco(u); a < grafoVial.finArcos(u); ++a)
+        {
+            int v = grafoVial.destinoDe(a);
+            if (!relajarArista(u, v, grafoVial.pesoDe(a), dist, padre, desempatar))
+                continue;
+            // Un camino minimo tiene a lo mas V-1 aristas; si no, hay un ciclo negativo
+            aristasEnRuta[v] = aristasEnRuta[u] + 1;
+            if (aristasEnRuta[v] >= numNodosAmbulancia)
+            {
+                consola() << "[ALERTA] Se detecto un posible ciclo negativo en el mapa urbano.\n";
+                return false;
+            }
+            if (!enCola[v])
+            {
+                enCola[v] = 1;
+                cola.push_back(v);
+            }
+        }
+    }
+    return true;
+}
+
+// Distancias minimas desde un origen a todos los nodos, con el algoritmo que admita los pesos actuales
+bool calcularRutas(int origen, vector<int>& dist, vector<int>& padre)
+{
+    if (grafoVial.arcosNegativos() == 0)
+        return dijkstra(origen, dist, padre);
+    return bellmanFord(origen, dist, padre);
+}
+
+// Construye la ruta desde origen a destino usando el vector padre (vacia si no llega al origen)
+vector<int> reconstruirRuta(int origen, int destino, const vector<int>& padre)
+{
+    vector<int> ruta;
+    int nodo = destino;
+    // Una ruta simple tiene a lo mas padre.size() nodos; mas pasos serian un ciclo en los predecesores
+    while (nodo != -1 && ruta.size() < padre.size())
+    {
+        ruta.push_back(nodo);
+        if (nodo == origen)
+            break;
+        nodo = padre[nodo];
+    }
+    if (ruta.empty() || ruta.back() != origen)
+    {
+        ruta.clear(); // no hay ruta posible
+        return ruta;
+    }
+    reverse(ruta.begin(), ruta.end());
+    return ruta;
+}
+
+/*
+ * Tabla opcional de tiempos entre todos los pares de nodos (distritos chicos y
+ * medianos): el ETA de un cruce a otro es una lectura. Por cada origen guarda la
+ * distancia y el siguiente salto hacia cada destino, en dos matrices n x n por
+ * filas. Una fila sale de calcularRutas desde su origen, y las filas se reparten
+ * entre los nucleos. Un cambio de trafico se repara sin reconstruir: si la via
+ * baja, solo se corrigen los pares que mejoran al pasar por ella; si sube, solo
+ * se recalculan los pares cuya ruta en la tabla la usaba. Las distancias quedan
+ * iguales a las de una tabla nueva; entre rutas empatadas la tabla puede
+ * conservar otra. Si el mapa se reemplaza o cambia sin pasar por
+ * la tabla, la version del grafo ya no coincide y la tabla deja de usarse.
+ */
+const int MAX_NODOS_TABLA = 4096; // dos matrices de 4096 x 4096 enteros: 128 MB
+
+class TablaTiemposRutas
+{
+private:
+    int n = 0;
+    long long version = -1; // version de grafoVial que refleja la tabla
+    vector<int> distancia;
+    vector<int> siguiente;
+    size_t filasReparadas = 0;
+    size_t paresReparados = 0;
+
+    // Distancias y primer salto de un origen, a partir del arbol de predecesores
+    bool calcularFila(int origen, vector<int>& dist, vector<int>& padre, vector<int>& pila)
+    {
+        if (!calcularRutas(origen, dist, padre))
+            return false;
+        int* filaDist = &distancia[static_cast<size_t>(origen) * n];
+        int* filaSig = &siguiente[static_cast<size_t>(origen) * n];
+        copy(dist.begin(), dist.end(), filaDist);
+        fill(filaSig, filaSig + n, -1);
+        filaSig[origen] = origen;
+        for (int t = 0; t < n; ++t)
+        {
+            if (dist[t] == INF_TIEMPO || filaSig[t] != -1)
+                continue;
+            // Se sube por el arbol hasta un nodo con salto conocido y se propaga a todo el tramo
+            int x = t;
+            while (filaSig[x] == -1)
+            {
+                pila.push_back(x);
+                x = padre[x];
+            }
+            int salto = x == origen ? pila.back() : filaSig[x];
+            for (int y : pila)
+                filaSig[y] = salto;
+            pila.clear();
+        }
+        return true;
+    }
+
+    bool calcularFilas(const vector<int>& origenes)
+    {
+        size_t hilos = min<size_t>(max(1u, thread::hardware_concurrency()), origenes.size());
+        atomic<size_t> proxima{ 0 };
+        atomic<bool> ok{ true };
+        auto trabajar = [&]()
+        {
+            vector<int> dist, padre, pila;
+            for (size_t i = proxima.fetch_add(1); i < origenes.size(); i = proxima.fetch_add(1))
+                if (!calcularFila(origenes[i], dist, padre, pila))
+                    ok = false;
+        };
+        vector<thread> trabajadores;
+        for (size_t h = 1; h < hilos; ++h)
+            trabajadores.emplace_back(trabajar);
+        trabajar();
+        for (thread& t : trabajadores)
+            t.join();
+        return ok;
+    }
+
+    /*
+     * El arco x->y bajo a w: solo mejoran los pares (s, t) con dist[s][x] + w + dist[y][t]
+     * < dist[s][t], y esos s y t se filtran antes por separado (O(n) cada uno). El nuevo
+     * primer salto de s es el que ya tenia hacia x. False si el arco cierra un ciclo negativo.
+     */
+    bool acortar(int x, int y, int w)
+    {
+        if (tiempo(y, x) != INF_TIEMPO && w + tiempo(y, x) < 0)
+            return false;
+        vector<int> origenes, destinos;
+        for (int s = 0; s < n; ++s)
+            if (tiempo(s, x) != INF_TIEMPO && tiempo(s, x) + w < tiempo(s, y))
+                origenes.push_back(s);
+        for (int t = 0; t < n; ++t)
+            if (tiempo(y, t) != INF_TIEMPO && w + tiempo(y, t) < tiempo(x, t))
+                destinos.push_back(t);
+        for (int s : origenes)
+        {
+            int hastaX = tiempo(s, x) + w;
+            int salto = s == x ? y : siguiente[static_cast<size_t>(s) * n + x];
+            for (int t : destinos)
+            {
+                size_t par = static_cast<size_t>(s) * n + t;
+                if (hastaX + tiempo(y, t) < distancia[par])
+                {
+                    distancia[par] = hastaX + tiempo(y, t);
+                    siguiente[par] = salto;
+                    paresReparados++;
+                }
+            }
+        }
+        return true;
+    }
+
+    /*
+     * Los arcos de 'subidos' (x->y) aumentaron de peso; pesos >= 0 y ninguno bajo en
+     * el mismo cambio. Para cada destino t los saltos de la columna t forman un arbol
+     * hacia t, y la ruta de s solo cambia si en ese arbol pasa por un arco subido: es
+     * el subarbol bajo x cuando el salto de x hacia t es y. Los demas pares conservan
+     * su ruta y su tiempo. Los del subarbol se recalculan con un Dijkstra hacia t
+     * limitado a el, sembrado con los vecinos de afuera (al estilo Ramalingam-Reps).
+     * Cada columna es independiente y se reparten entre los nucleos.
+     */
+    void repararSubidas(const vector<pair<int, int>>& subidos)
+    {
+        // Arcos entrantes por nodo (CSR inverso): el Dijkstra hacia t avanza desde cada nodo a sus predecesores
+        vector<int> inicioEntrantes(n + 1, 0), entrantes(grafoVial.numArcos()), origenEntrante(grafoVial.numArcos());
+        for (int x = 0; x < n; ++x)
+            for (int a = grafoVial.primerArco(x); a < grafoVial.finArcos(x); ++a)
+                inicioEntrantes[grafoVial.destinoDe(a) + 1]++;
+        for (int x = 0; x < n; ++x)
+            inicioEntrantes[x + 1] += inicioEntrantes[x];
+        vector<int> libre(inicioEntrantes.begin(), inicioEntrantes.end() - 1);
+        for (int x = 0; x < n; ++x)
+            for (int a = grafoVial.primerArco(x); a < grafoVial.finArcos(x); ++a)
+            {
+                int k = libre[grafoVial.destinoDe(a)]++;
+                entrantes[k] = a;
+                origenEntrante[k] = x;
+            }
+
+        vector<int> columnas; // destinos hacia los que algun arco subido es un salto de la tabla
+        for (int t = 0; t < n; ++t)
+            for (const auto& [x, y] : subidos)
+                if (x != t && siguiente[static_cast<size_t>(x) * n + t] == y)
+                {
+                    columnas.push_back(t);
+                    break;
+                }
+
+        atomic<size_t> proxima{ 0 }, pares{ 0 };
+        auto trabajar = [&]()
+        {
+            enum : char { SIN_VER, AFECTADO, INTACTO };
+            vector<char> estado(n);
+            vector<int> nueva(n), salto(n), pila, afectados;
+            priority_queue<pair<int, int>, vector<pair<int, int>>, greater<pair<int, int>>> heap;
+            size_t propios = 0;
+            for (size_t i = proxima.fetch_add(1); i < columnas.size(); i = proxima.fetch_add(1))
+            {
+                int t = columnas[i];
+                // 1. Subarbol afectado: cada origen sube por sus saltos hasta un nodo ya clasificado
+                fill(estado.begin(), estado.end(), SIN_VER);
+                estado[t] = INTACTO;
+                for (const auto& [x, y] : subidos)
+                    if (x != t && siguiente[static_cast<size_t>(x) * n + t] == y)
+                        estado[x] = AFECTADO;
+                afectados.clear();
+                for (int s = 0; s < n; ++s)
+                {
+                    int z = s;
+                    while (estado[z] == SIN_VER)
+                    {
+                        pila.push_back(z);
+                        z = siguiente[static_cast<size_t>(z) * n + t];
+                        if (z < 0 || pila.size() > static_cast<size_t>(n))
+                        {
+                            z = t; // sin camino, o un ciclo de tiempo 0 en los saltos: la ruta no cambia
+                            break;
+                        }
+                    }
+                    for (int p : pila)
+                        estado[p] = estado[z];
+                    pila.clear();
+                    if (estado[s] == AFECTADO)
+                        afectados.push_back(s);
+                }
+                // 2. Dijkstra hacia t dentro del subarbol; los vecinos de afuera aportan su tiempo ya correcto
+                for (int a : afectados)
+                {
+                    nueva[a] = INF_TIEMPO;
+                    salto[a] = -1;
+                    for (int e = grafoVial.primerArco(a); e < grafoVial.finArcos(a); ++e)
+                    {
+                        int b = grafoVial.destinoDe(e);
+                        int db = tiempo(b, t);
+                        if (estado[b] != AFECTADO && db != INF_TIEMPO && grafoVial.pesoDe(e) + db < nueva[a])
+                        {
+                            nueva[a] = grafoVial.pesoDe(e) + db;
+                            salto[a] = b;
+                        }
+                    }
+                    if (nueva[a] != INF_TIEMPO)
+                        heap.push({ nueva[a], a });
+                }
+                while (!heap.empty())
+                {
+                    auto [d, a] = heap.top();
+                    heap.pop();
+                    if (d != nueva[a])
+                        continue;
+                    for (int k = inicioEntrantes[a]; k < inicioEntrantes[a + 1]; ++k)
+                    {
+                        int c = origenEntrante[k];
+                        int dc = d + grafoVial.pesoDe(entrantes[k]);
+                        if (estado[c] == AFECTADO && dc < nueva[c])
+                        {
+                            nueva[c] = dc;
+                            salto[c] = a;
+                            heap.push({ dc, c });
+                        }
+                    }
+                }
+                for (int a : afectados)
+                {
+                    size_t par = static_cast<size_t>(a) * n + t;
+                    distancia[par] = nueva[a];
+                    siguiente[par] = salto[a];
+                }
+                propios += afectados.size();
+            }
+            pares += propios;
+        };
+        size_t hilos = min<size_t>(max(1u, thread::hardware_concurrency()), max<size_t>(columnas.size(), 1));
+        vector<thread> trabajadores;
+        for (size_t h = 1; h < hilos; ++h)
+            trabajadores.emplace_back(trabajar);
+        trabajar();
+        for (thread& h : trabajadores)
+            h.join();
+        paresReparados += pares.load();
+    }
+
+public:
+    // Construye la tabla para el mapa actual; false si es muy grande o hay un ciclo negativo
+    bool construir()
+    {
+        descartar();
+        if (numNodosAmbulancia <= 0 || numNodosAmbulancia > MAX_NODOS_TABLA)
+            return false;
+        n = numNodosAmbulancia;
+        distancia.assign(static_cast<size_t>(n) * n, INF_TIEMPO);
+        siguiente.assign(static_cast<size_t>(n) * n, -1);
+        vector<int> origenes(n);
+        for (int s = 0; s < n; ++s)
+            origenes[s] = s;
+        if (!calcularFilas(origenes))
+        {
+            descartar();
+            return false;
+        }
+        version = grafoVial.version();
+        return true;
+    }
+
+    void descartar()
+    {
+        n = 0;
+        version = -1;
+        vector<int>().swap(distancia);
+        vector<int>().swap(siguiente);
+    }
+
+    bool vigente() const
+    {
+        return n > 0 && version == grafoVial.version();
+    }
+
+    int tiempo(int origen, int destino) const
+    {
+        return distancia[static_cast<size_t>(origen) * n + destino];
+    }
+
+    // Ruta siguiendo los saltos; vacia si no hay camino (o si un ciclo de tiempo 0 la hace circular)
+    vector<int> ruta(int origen, int destino) const
+    {
+        vector<int> camino;
+        if (tiempo(origen, destino) == INF_TIEMPO)
+            return camino;
+        camino.push_back(origen);
+        for (int x = origen; x != destino;)
+        {
+            x = siguiente[static_cast<size_t>(x) * n + destino];
+            camino.push_back(x);
+            if (static_cast<int>(camino.size()) > n)
+                return {};
+        }
+        return camino;
+    }
+
+    // Cambia el peso de la via u-v (ambos sentidos) y repara la tabla; false si la via no existe
+    bool cambiarPeso(int u, int v, int nuevo)
+    {
+        const pair<int, int> sentidos[2] = { { u, v }, { v, u } };
+        int anterior[2];
+        for (int i = 0; i < 2; ++i)
+        {
+            int a = grafoVial.arco(sentidos[i].first, sentidos[i].second);
+            anterior[i] = a < 0 ? nuevo : grafoVial.pesoDe(a);
+        }
+        if (!grafoVial.cambiarPeso(u, v, nuevo))
+            return false;
+        filasReparadas = 0;
+        paresReparados = 0;
+        vector<pair<int, int>> subidos;
+        bool baja = false;
+        for (int i = 0; i < 2; ++i)
+        {
+            if (nuevo > anterior[i])
+                subidos.push_back(sentidos[i]);
+            baja = baja || nuevo < anterior[i];
+        }
+        bool ok = true;
+        if (!subidos.empty() && !baja && grafoVial.arcosNegativos() == 0)
+            repararSubidas(subidos);
+        else if (!subidos.empty())
+        {
+            // Con pesos negativos, o si un sentido sube y el otro baja, se recalculan completas las filas
+            // en las que un arco subido era parte de un camino minimo (o empataba); la tabla aun es la anterior
+            vector<int> origenes;
+            for (int s = 0; s < n; ++s)
+                for (int i = 0; i < 2; ++i)
+                {
+                    int ds = tiempo(s, sentidos[i].first);
+                    if (nuevo > anterior[i] && ds != INF_TIEMPO && ds + anterior[i] == tiempo(s, sentidos[i].second))
+                    {
+                        origenes.push_back(s);
+                        break;
+                    }
+                }
+            filasReparadas = origenes.size();
+            ok = origenes.empty() || calcularFilas(origenes);
+        }
+        for (int i = 0; i < 2 && ok; ++i)
+            if (nuevo < anterior[i])
+                ok = acortar(sentidos[i].first, sentidos[i].second, nuevo);
+        if (!ok)
+        {
+            descartar();
+            consola() << "[ADVERTENCIA] Tabla de tiempos descartada: el mapa tiene un ciclo negativo.\n";
+            return true;
+        }
+        version = grafoVial.version();
+        return true;
+    }
+
+    size_t ultimasFilasReparadas() const
+    {
+        return filasReparadas;
+    }
+
+    size_t ultimosParesReparados() const
+    {
+        return paresReparados;
+    }
+
+    int numNodos() const
+    {
+        return n;
+    }
+};
+
+TablaTiemposRutas tablaTiempos;
+
+// Activa (construyendo la tabla en paralelo) o desactiva la tabla de tiempos entre todos los pares
+bool activarTablaTiempos(bool activar)
+{
+    if (!activar)
+    {
+        tablaTiempos.descartar();
+        consola() << "[INFO] Tabla de tiempos desactivada; las rutas se calculan por consulta.\n";
+        return true;
+    }
+    if (numNodosAmbulancia > MAX_NODOS_TABLA)
+    {
+        consola() << "[ERROR] La tabla de tiempos admite hasta " << MAX_NODOS_TABLA << " nodos (el mapa tiene "
+                  << numNodosAmbulancia << ").\n";
+        return false;
+    }
+    auto inicio = chrono::steady_clock::now();
+    if (!tablaTiempos.construir())
+    {
+        consola() << "[ERROR] No se pudo construir la tabla de tiempos (ciclo negativo en el mapa).\n";
+        return false;
+    }
+    consola() << "[INFO] Tabla de tiempos lista: " << numNodosAmbulancia << " x " << numNodosAmbulancia << " en "
+              << chrono::duration<double, milli>(chrono::steady_clock::now() - inicio).count() << " ms.\n";
+    return true;
+}
+
+/*
+ * Jerarquia de contraccion personalizable para mapas grandes (cientos de miles de
+ * cruces), donde ni una busqueda completa por consulta ni la tabla de todos los
+ * pares son viables. Se prepara en dos etapas:
+ *  1. Orden y contraccion, independientes de los pesos: diseccion anidada con
+ *     separadores por corte minimo sobre los niveles BFS (los separadores quedan
+ *     arriba) y luego eliminacion simbolica: al contraer x, sus vecinos mas altos
+ *     quedan unidos entre si (atajos). Es la parte cara y es la que se guarda en
+ *     disco.
+ *  2. Personalizacion con los pesos actuales: cada atajo {y, z} toma el mejor de
+ *     su via original y de los triangulos y->x->z con x mas bajo, en orden de
+ *     contraccion. Un cambio de trafico solo repersonaliza los atajos que
+ *     dependen de la via, sin volver a contraer.
+ * La consulta sube desde el origen y desde el destino por el arbol de
+ * eliminacion (sus ancestros son todo su espacio de busqueda), se encuentra en
+ * el mejor ancestro comun y desempaca los atajos hasta las vias reales. Da las
+ * mismas distancias que calcularRutas. La ruta es de tiempo minimo, pero si hay
+ * empates no es necesariamente la de calcularRutas: aquella elige el predecesor
+ * de menor id entre los empatados, y repetirlo exigiria la distancia desde el
+ * origen a cada vecino de la ruta (una consulta por vecino). Con pesos negativos
+ * no se usa.
+ * El costo de una consulta es la suma de las aristas hacia arriba de los dos
+ * caminos de ancestros, que crece con el tamaño de los separadores. En una
+ * cuadricula (el mapa de --comparar-rutas, el peor caso: separadores de ~raiz de
+ * n nodos) son unas 84 mil aristas con 20 mil nodos (~0,15 ms) y 440 mil con 100
+ * mil (~0,8 ms): decenas de veces menos que Dijkstra, pero no microsegundos. En
+ * mapas reales los separadores son mas chicos. El corte de las busquedas al
+ * superar la mejor distancia ya conocida ayuda poco porque los caminos recien se
+ * unen arriba; el "stall on demand" de las jerarquias clasicas cuesta una pasada
+ * mas por las mismas aristas y aqui no paga.
+ */
+const char MAGIA_JERARQUIA[8] = { 'H', 'O', 'S', 'P', 'J', 'E', 'R', 'Q' };
+const uint32_t VERSION_JERARQUIA = 2;
+const uint32_t MARCA_ORDEN_JERARQUIA = 0x01020304;
+
+struct CabeceraJerarquia
+{
+    char magia[8];
+    uint32_t version;
+    uint32_t marcaOrdenBytes;
+    int32_t nodos;
+    uint32_t huellaMapa; // crc32 de los arcos (u, v) del mapa: la topologia debe coincidir
+    uint32_t crcDatos;   // crc32 de orden, inicio y destino tal como se escriben
+    uint32_t reservado;
+    uint64_t arcosMapa;
+    uint64_t atajos;
+};
+
+class JerarquiaContraccion
+{
+private:
+    int n = 0;
+    long long version = -1;
+    uint32_t huella = 0;
+    vector<int> orden; // orden[r]: nodo del mapa contraido en la posicion r
+    vector<int> rango; // inversa de orden
+    // Aristas {x, y} con x < y en orden de contraccion, en CSR por x; 'destino' ordenado
+    vector<int> inicio, destino, inferior;
+    // Por nodo y: los x < y vecinos, ordenados, con el id de la arista {x, y}
+    vector<int> inicioAbajo, vecinoAbajo, aristaAbajo;
+    vector<int> baseSube, baseBaja; // peso de la via original x->y / y->x (INF si no hay)
+    vector<int> sube, baja;         // pesos personalizados
+    vector<int> medioSube, medioBaja; // nodo intermedio del mejor triangulo (-1: via original)
+    vector<char> enCola;
+    // Estado de consulta, reutilizado
+    vector<int> distSube, distBaja, predSube, predBaja;
+
+    static uint32_t huellaDe(const GrafoCSR& grafo)
+    {
+        uint32_t crc = 0;
+        for (int u = 0; u < grafo.numNodos(); ++u)
+            for (int a = grafo.primerArco(u); a < grafo.finArcos(u); ++a)
+            {
+                int32_t par[2] = { u, grafo.destinoDe(a) };
+                crc = crc32(reinterpret_cast<const char*>(par), sizeof(par), crc);
+            }
+        return crc;
+    }
+
+    uint32_t crcDatos() const
+    {
+        uint32_t crc = crc32(reinterpret_cast<const char*>(orden.data()), orden.size() * sizeof(int));
+        crc = crc32(reinterpret_cast<const char*>(inicio.data()), inicio.size() * sizeof(int), crc);
+        return crc32(reinterpret_cast<const char*>(destino.data()), destino.size() * sizeof(int), crc);
+    }
+
+    static int sumar(int a, int b)
+    {
+        return a == INF_TIEMPO || b == INF_TIEMPO ? INF_TIEMPO : a + b;
+    }
+
+    int arista(int x, int y) const
+    {
+        auto fin = destino.begin() + inicio[x + 1];
+        auto it = lower_bound(destino.begin() + inicio[x], fin, y);
+        return (it != fin && *it == y) ? static_cast<int>(it - destino.begin()) : -1;
+    }
+
+    int padreArbol(int x) const
+    {
+        return inicio[x] < inicio[x + 1] ? destino[inicio[x]] : -1;
+    }
+
+    // Vecindad no dirigida del mapa (la contraccion ignora sentido y peso)
+    void vecindad(vector<int>& ini, vector<int>& vec) const
+    {
+        ini.assign(n + 1, 0);
+        vector<AristaAmbulancia> arcos = grafoVial.arcos();
+        for (const AristaAmbulancia& e : arcos)
+            if (e.u != e.v)
+            {
+                ini[e.u + 1]++;
+                ini[e.v + 1]++;
+            }
+        for (int v = 0; v < n; ++v)
+            ini[v + 1] += ini[v];
+        vec.assign(ini[n], 0);
+        vector<int> pos(ini.begin(), ini.end() - 1);
+        for (const AristaAmbulancia& e : arcos)
+            if (e.u != e.v)
+            {
+                vec[pos[e.u]++] = e.v;
+                vec[pos[e.v]++] = e.u;
+            }
+    }
+
+    /*
+     * Separador por flujo sobre los niveles BFS de un trozo conexo: los niveles que
+     * caen enteros en el primer tercio del trozo son la fuente, los que empiezan
+     * despues de los dos tercios el sumidero, y en la franja del medio se busca el
+     * menor conjunto de nodos que los desconecta (corte minimo de vertices con
+     * Edmonds-Karp, cada nodo partido en entrada y salida de capacidad 1). Nunca es
+     * mayor que el mejor nivel de la franja y puede seguir las calles en vez del
+     * frente del BFS. Devuelve false, sin tocar los lados, si un lado queda vacio.
+     */
+    bool separarPorFlujo(const vector<int>& ini, const vector<int>& vec, const vector<int>& cola,
+                         const vector<int>& nivel, const vector<int>& trozoDe, int id, vector<int>& local,
+                         vector<int>& ladoA, vector<int>& ladoB, vector<int>& separador) const
+    {
+        const char FUENTE = 0, FRANJA = 1, SUMIDERO = 2;
+        size_t total = cola.size();
+        vector<size_t> porNivel(nivel[cola.back()] + 1, 0);
+        for (int v : cola)
+            porNivel[nivel[v]]++;
+        vector<char> zona(porNivel.size());
+        size_t debajo = 0;
+        for (size_t l = 0; l < porNivel.size(); ++l)
+        {
+            zona[l] = (debajo + porNivel[l]) * 3 <= total ? FUENTE : debajo * 3 >= total * 2 ? SUMIDERO : FRANJA;
+            debajo += porNivel[l];
+        }
+        if (zona.back() != SUMIDERO)
+            return false;
+        vector<int> franja;
+        for (int v : cola)
+            if (zona[nivel[v]] == FRANJA)
+            {
+                local[v] = static_cast<int>(franja.size());
+                franja.push_back(v);
+            }
+
+        // Red residual: entrada 2i, salida 2i+1, fuente 2B y sumidero 2B+1; el arco a y su reverso a^1
+        const int B = static_cast<int>(franja.size()), S = 2 * B, T = 2 * B + 1, SIN_LIMITE = B + 1;
+        vector<int> primero(2 * B + 2, -1), cabeza, sigArco, capacidad;
+        auto agregar = [&](int desde, int hasta, int cap)
+        {
+            for (auto [x, y, c] : { tuple<int, int, int>{ desde, hasta, cap }, { hasta, desde, 0 } })
+            {
+                cabeza.push_back(y);
+                capacidad.push_back(c);
+                sigArco.push_back(primero[x]);
+                primero[x] = static_cast<int>(cabeza.size()) - 1;
+            }
+        };
+        for (int i = 0; i < B; ++i)
+        {
+            int v = franja[i];
+            agregar(2 * i, 2 * i + 1, 1);
+            bool deFuente = false, aSumidero = false;
+            for (int k = ini[v]; k < ini[v + 1]; ++k)
+            {
+                int w = vec[k];
+                if (trozoDe[w] != id)
+                    continue;
+                char z = zona[nivel[w]];
+                if (z == FRANJA)
+                    agregar(2 * i + 1, 2 * local[w], SIN_LIMITE);
+                deFuente = deFuente || z == FUENTE;
+                aSumidero = aSumidero || z == SUMIDERO;
+            }
+            if (deFuente)
+                agregar(S, 2 * i, SIN_LIMITE);
+            if (aSumidero)
+                agregar(2 * i + 1, T, SIN_LIMITE);
+        }
+        for (int v : franja)
+            local[v] = -1;
+
+        // Caminos de aumento por BFS; el ultimo BFS (sin camino) deja marcado el lado de la fuente
+        vector<int> llegada(2 * B + 2), pendiente;
+        auto buscar = [&]()
+        {
+            fill(llegada.begin(), llegada.end(), -1);
+            llegada[S] = -2;
+            pendiente.assign(1, S);
+            for (size_t i = 0; i < pendiente.size() && llegada[T] == -1; ++i)
+                for (int a = primero[pendiente[i]]; a >= 0; a = sigArco[a])
+                    if (capacidad[a] > 0 && llegada[cabeza[a]] == -1)
+                    {
+                        llegada[cabeza[a]] = a;
+                        pendiente.push_back(cabeza[a]);
+                    }
+            return llegada[T] != -1;
+        };
+        while (buscar())
+            for (int x = T; x != S; x = cabeza[llegada[x] ^ 1])
+            {
+                capacidad[llegada[x]]--;
+                capacidad[llegada[x] ^ 1]++;
+            }
+        size_t enA = 0, enB = 0;
+        for (int i = 0; i < B; ++i)
+        {
+            bool entra = llegada[2 * i] != -1, sale = llegada[2 * i + 1] != -1;
+            enA += sale;
+            enB += !entra;
+        }
+        for (size_t l = 0; l < porNivel.size(); ++l)
+            (zona[l] == FUENTE ? enA : enB) += zona[l] == FRANJA ? 0 : porNivel[l];
+        if (enA == 0 || enB == 0)
+            return false;
+        for (int v : cola)
+            if (zona[nivel[v]] != FRANJA)
+                (zona[nivel[v]] == FUENTE ? ladoA : ladoB).push_back(v);
+        for (int i = 0; i < B; ++i)
+        {
+            bool entra = llegada[2 * i] != -1, sale = llegada[2 * i + 1] != -1;
+            (sale ? ladoA : entra ? separador : ladoB).push_back(franja[i]);
+        }
+        return true;
+    }
+
+    /*
+     * Diseccion anidada: BFS desde un nodo pseudo-periferico del trozo y, sobre sus
+     * niveles, el separador por flujo (o, si no se puede, el nivel mas chico que deja
+     * de 1/3 a 2/3 de los nodos debajo; solo hay aristas entre niveles vecinos). Los
+     * dos lados se ordenan por separado debajo de el. Un trozo desconexo se parte en
+     * su componente y el resto, sin separador.
+     */
+    void ordenarPorDiseccion(const vector<int>& ini, const vector<int>& vec)
+    {
+        const size_t TROZO_MINIMO = 32;
+        orden.assign(n, -1);
+        vector<int> trozoDe(n, 0), nivel(n, -1), local(n, -1);
+        struct Trozo
+        {
+            vector<int> nodos;
+            int desde; // primera posicion del orden que le toca
+            int id;
+        };
+        vector<Trozo> pendientes;
+        int siguienteId = 1;
+        {
+            Trozo todo{ vector<int>(n), 0, 0 };
+            for (int v = 0; v < n; ++v)
+                todo.nodos[v] = v;
+            pendientes.push_back(std::move(todo));
+        }
+        vector<int> cola;
+        auto bfs = [&](int origen, int id)
+        {
+            cola.assign(1, origen);
+            nivel[origen] = 0;
+            for (size_t i = 0; i < cola.size(); ++i)
+            {
+                int u = cola[i];
+                for (int k = ini[u]; k < ini[u + 1]; ++k)
+                {
+                    int v = vec[k];
+                    if (trozoDe[v] == id && nivel[v] < 0)
+                    {
+                        nivel[v] = nivel[u] + 1;
+                        cola.push_back(v);
+                    }
+                }
+            }
+        };
+        while (!pendientes.empty())
+        {
+            Trozo t = std::move(pendientes.back());
+            pendientes.pop_back();
+            if (t.nodos.size() <= TROZO_MINIMO)
+            {
+                for (size_t i = 0; i < t.nodos.size(); ++i)
+                    orden[t.desde + static_cast<int>(i)] = t.nodos[i];
+                continue;
+            }
+            for (int v : t.nodos)
+                nivel[v] = -1;
+            bfs(t.nodos[0], t.id);
+            int lejano = cola.back();
+            for (int v : cola)
+                nivel[v] = -1;
+            bfs(lejano, t.id);
+
+            Trozo a{ {}, t.desde, siguienteId++ }, b{ {}, 0, siguienteId++ };
+            vector<int> separador;
+            if (cola.size() < t.nodos.size())
+            {
+                // Desconexo: la componente alcanzada y el resto
+                for (int v : t.nodos)
+                    (nivel[v] >= 0 ? a : b).nodos.push_back(v);
+            }
+            else if (!separarPorFlujo(ini, vec, cola, nivel, trozoDe, t.id, local, a.nodos, b.nodos, separador))
+            {
+                int niveles = nivel[cola.back()] + 1;
+                vector<size_t> porNivel(niveles, 0);
+                for (int v : cola)
+                    porNivel[nivel[v]]++;
+                // El nivel mas chico entre los que dejan de 1/3 a 2/3 de los nodos debajo
+                int corte = -1;
+                size_t debajo = 0;
+                for (int l = 0; l < niveles; ++l)
+                {
+                    bool balanceado = debajo * 3 >= cola.size() && (debajo + porNivel[l]) * 3 <= cola.size() * 2;
+                    if (balanceado && (corte < 0 || porNivel[l] < porNivel[corte]))
+                        corte = l;
+                    debajo += porNivel[l];
+                }
+                if (corte < 0) // ningun nivel balanceado: el de la mediana
+                    for (debajo = 0, corte = 0; corte < niveles - 1; ++corte)
+                    {
+                        debajo += porNivel[corte];
+                        if (debajo * 2 >= cola.size())
+                            break;
+                    }
+                for (int v : cola)
+                {
+                    bool tocaLadoB = false;
+                    for (int k = ini[v]; k < ini[v + 1] && !tocaLadoB && nivel[v] == corte; ++k)
+                        tocaLadoB = trozoDe[vec[k]] == t.id && nivel[vec[k]] == corte + 1;
+                    if (nivel[v] > corte)
+                        b.nodos.push_back(v);
+                    else if (tocaLadoB)
+                        separador.push_back(v);
+                    else // sin vecinos del otro lado no necesita estar en el separador
+                        a.nodos.push_back(v);
+                }
+            }
+            int fin = t.desde + static_cast<int>(t.nodos.size());
+            for (size_t i = 0; i < separador.size(); ++i)
+                orden[fin - static_cast<int>(separador.size()) + static_cast<int>(i)] = separador[i];
+            b.desde = a.desde + static_cast<int>(a.nodos.size());
+            for (Trozo* hijo : { &a, &b })
+            {
+                for (int v : hijo->nodos)
+                    trozoDe[v] = hijo->id;
+                if (!hijo->nodos.empty())
+                    pendientes.push_back(std::move(*hijo));
+            }
+        }
+        rango.assign(n, 0);
+        for (int r = 0; r < n; ++r)
+            rango[orden[r]] = r;
+    }
+
+    // Eliminacion simbolica: los vecinos altos de x, salvo el primero, pasan a ser vecinos de ese primero
+    void contraer(const vector<int>& ini, const vector<int>& vec)
+    {
+        vector<vector<int>> arriba(n);
+        for (int u = 0; u < n; ++u)
+            for (int k = ini[u]; k < ini[u + 1]; ++k)
+                if (rango[u] < rango[vec[k]])
+                    arriba[rango[u]].push_back(rango[vec[k]]);
+        vector<int> mezcla;
+        for (int x = 0; x < n; ++x)
+        {
+            vector<int>& vx = arriba[x];
+            sort(vx.begin(), vx.end());
+            vx.erase(unique(vx.begin(), vx.end()), vx.end());
+            if (vx.size() < 2)
+                continue;
+            vector<int>& vp = arriba[vx[0]];
+            mezcla.clear();
+            merge(vp.begin(), vp.end(), vx.begin() + 1, vx.end(), back_inserter(mezcla));
+            vp.swap(mezcla);
+        }
+        inicio.assign(n + 1, 0);
+        for (int x = 0; x < n; ++x)
+        {
+            vector<int>& vx = arriba[x];
+            sort(vx.begin(), vx.end());
+            vx.erase(unique(vx.begin(), vx.end()), vx.end());
+            inicio[x + 1] = inicio[x] + static_cast<int>(vx.size());
+        }
+        destino.clear();
+        destino.reserve(inicio[n]);
+        for (int x = 0; x < n; ++x)
+        {
+            destino.insert(destino.end(), arriba[x].begin(), arriba[x].end());
+            vector<int>().swap(arriba[x]);
+        }
+    }
+
+    // Estructuras derivadas de la topologia (tras contraer o cargar de disco)
+    void indexar()
+    {
+        size_t m = destino.size();
+        inferior.resize(m);
+        inicioAbajo.assign(n + 1, 0);
+        for (int x = 0; x < n; ++x)
+            for (int e = inicio[x]; e < inicio[x + 1]; ++e)
+            {
+                inferior[e] = x;
+                inicioAbajo[destino[e] + 1]++;
+            }
+        for (int y = 0; y < n; ++y)
+            inicioAbajo[y + 1] += inicioAbajo[y];
+        vecinoAbajo.resize(m);
+        aristaAbajo.resize(m);
+        vector<int> pos(inicioAbajo.begin(), inicioAbajo.end() - 1);
+        for (int x = 0; x < n; ++x) // x creciente: cada lista queda ordenada
+            for (int e = inicio[x]; e < inicio[x + 1]; ++e)
+            {
+                int p = pos[destino[e]]++;
+                vecinoAbajo[p] = x;
+                aristaAbajo[p] = e;
+            }
+        enCola.assign(m, 0);
+        distSube.assign(n, INF_TIEMPO);
+        distBaja.assign(n, INF_TIEMPO);
+        predSube.assign(n, -1);
+        predBaja.assign(n, -1);
+    }
+
+    // Peso de la via original u->v (si existe) en la arista que le corresponde
+    void fijarBase(int u, int v)
+    {
+        int a = grafoVial.arco(u, v);
+        int x = rango[u], y = rango[v];
+        int e = arista(min(x, y), max(x, y));
+        if (e < 0) // contraer crea una arista por via y cargar rechaza archivos a los que les falte alguna
+            return;
+        int peso = a < 0 ? INF_TIEMPO : grafoVial.pesoDe(a);
+        (x < y ? baseSube : baseBaja)[e] = peso;
+    }
+
+    // Peso personalizado de {y, z} desde cero: su via original y los triangulos por debajo
+    bool recalcularArista(int e)
+    {
+        int y = inferior[e], z = destino[e];
+        int s = baseSube[e], b = baseBaja[e], ms = -1, mb = -1;
+        int i = inicioAbajo[y], j = inicioAbajo[z];
+        while (i < inicioAbajo[y + 1] && j < inicioAbajo[z + 1])
+        {
+            if (vecinoAbajo[i] < vecinoAbajo[j])
+                ++i;
+            else if (vecinoAbajo[i] > vecinoAbajo[j])
+                ++j;
+            else
+            {
+                int exy = aristaAbajo[i], exz = aristaAbajo[j];
+                int porX = sumar(baja[exy], sube[exz]);
+                if (porX < s)
+                {
+                    s = porX;
+                    ms = vecinoAbajo[i];
+                }
+                porX = sumar(baja[exz], sube[exy]);
+                if (porX < b)
+                {
+                    b = porX;
+                    mb = vecinoAbajo[i];
+                }
+                ++i;
+                ++j;
+            }
+        }
+        bool cambio = s != sube[e] || b != baja[e];
+        sube[e] = s;
+        baja[e] = b;
+        medioSube[e] = ms;
+        medioBaja[e] = mb;
+        return cambio;
+    }
+
+    void personalizar()
+    {
+        size_t m = destino.size();
+        baseSube.assign(m, INF_TIEMPO);
+        baseBaja.assign(m, INF_TIEMPO);
+        for (int u = 0; u < n; ++u)
+            for (int a = grafoVial.primerArco(u); a < grafoVial.finArcos(u); ++a)
+                if (grafoVial.destinoDe(a) != u)
+                    fijarBase(u, grafoVial.destinoDe(a));
+        sube = baseSube;
+        baja = baseBaja;
+        medioSube.assign(m, -1);
+        medioBaja.assign(m, -1);
+        // Triangulos por su nodo mas bajo x: {x,y} y {x,z} ya son definitivos
+        for (int x = 0; x < n; ++x)
+            for (int i = inicio[x]; i < inicio[x + 1]; ++i)
+            {
+                int y = destino[i];
+                int k = inicio[y];
+                for (int j = i + 1; j < inicio[x + 1]; ++j)
+                {
+                    int z = destino[j];
+                    while (destino[k] < z) // {y, z} existe: la lista de y contiene la de x
+                        ++k;
+                    int porX = sumar(baja[i], sube[j]);
+                    if (porX < sube[k])
+                    {
+                        sube[k] = porX;
+                        medioSube[k] = x;
+                    }
+                    porX = sumar(baja[j], sube[i]);
+                    if (porX < baja[k])
+                    {
+                        baja[k] = porX;
+                        medioBaja[k] = x;
+                    }
+                }
+            }
+        version = grafoVial.version();
+    }
+
+    // Agrega a ruta los nodos de la arista e recorrida hacia arriba (x->y) o hacia abajo (y->x), sin el primero
+    void desempacar(int e, bool haciaArriba, vector<int>& ruta) const
+    {
+        vector<pair<int, bool>> pila = { { e, haciaArriba } };
+        while (!pila.empty())
+        {
+            auto [a, arriba] = pila.back();
+            pila.pop_back();
+            int x = inferior[a], y = destino[a];
+            int medio = arriba ? medioSube[a] : medioBaja[a];
+            if (medio < 0)
+            {
+                ruta.push_back(orden[arriba ? y : x]);
+                continue;
+            }
+            int emx = arista(medio, x), emy = arista(medio, y);
+            if (arriba) // x->medio->y
+            {
+                pila.push_back({ emy, true });
+                pila.push_back({ emx, false });
+            }
+            else // y->medio->x
+            {
+                pila.push_back({ emx, true });
+                pila.push_back({ emy, false });
+            }
+        }
+    }
+
+    // Relaja las aristas hacia arriba de x en un sentido, salvo que x ya no pueda mejorar 'mejor'
+    void subirDesde(int x, vector<int>& dist, vector<int>& pred, const vector<int>& peso, int mejor)
+    {
+        if (dist[x] >= mejor)
+            return;
+        for (int e = inicio[x]; e < inicio[x + 1]; ++e)
+        {
+            int nueva = sumar(dist[x], peso[e]);
+            if (nueva < dist[destino[e]])
+            {
+                dist[destino[e]] = nueva;
+                pred[destino[e]] = e;
+            }
+        }
+    }
+
+public:
+    // Ordena, contrae y personaliza para el mapa actual
+    bool preparar()
+    {
+        n = numNodosAmbulancia;
+        if (n <= 0)
+            return false;
+        vector<int> ini, vec;
+        vecindad(ini, vec);
+        ordenarPorDiseccion(ini, vec);
+        contraer(ini, vec);
+        indexar();
+        huella = huellaDe(grafoVial);
+        personalizar();
+        return true;
+    }
+
+    bool vigente() const
+    {
+        return n > 0 && version == grafoVial.version();
+    }
+
+    size_t numAtajos() const
+    {
+        return destino.size();
+    }
+
+    /*
+     * Tras grafoVial.cambiarPeso(u, v, ...): repersonaliza solo los atajos que dependen
+     * de la via. Cuando cambia {x, y}, cada {y, z} con z vecino alto de x vuelve a mirar
+     * su triangulo por x: si mejora se corrige en O(1); si empeora y su mejor valor venia
+     * de x, se recalcula desde cero al salir de la cola. La cola va por nodo bajo
+     * creciente, asi que al salir una arista todas sus entradas ya estan al dia.
+     */
+    void actualizarPeso(int u, int v)
+    {
+        if (n == 0)
+            return;
+        const char EN_COLA = 1, CAMBIO = 2, RECALCULAR = 4;
+        priority_queue<pair<int, int>, vector<pair<int, int>>, greater<pair<int, int>>> pendientes;
+        auto encolar = [&](int e, char marca)
+        {
+            if (!(enCola[e] & EN_COLA))
+                pendientes.push({ inferior[e], e });
+            enCola[e] |= EN_COLA | marca;
+        };
+        int x = rango[u], y = rango[v];
+        int e = arista(min(x, y), max(x, y));
+        if (e >= 0)
+        {
+            fijarBase(u, v);
+            fijarBase(v, u);
+            encolar(e, RECALCULAR);
+        }
+        while (!pendientes.empty())
+        {
+            int a = pendientes.top().second;
+            pendientes.pop();
+            char marca = enCola[a];
+            enCola[a] = 0;
+            bool cambio = (marca & CAMBIO) != 0;
+            if (marca & RECALCULAR)
+                cambio = recalcularArista(a) || cambio;
+            if (!cambio)
+                continue;
+            // {bajo, alto} es lado inferior de los triangulos de 'bajo': afecta a {alto, z}
+            int bajo = inferior[a], alto = destino[a];
+            for (int k = inicio[bajo]; k < inicio[bajo + 1]; ++k)
+            {
+                int z = destino[k];
+                if (z == alto)
+                    continue;
+                int lo = min(alto, z), hi = max(alto, z);
+                int dep = arista(lo, hi);
+                int eLo = lo == alto ? a : k, eHi = lo == alto ? k : a;
+                int porBajoSube = sumar(baja[eLo], sube[eHi]), porBajoBaja = sumar(baja[eHi], sube[eLo]);
+                bool empeora = (medioSube[dep] == bajo && porBajoSube > sube[dep]) ||
+                               (medioBaja[dep] == bajo && porBajoBaja > baja[dep]);
+                if (empeora)
+                {
+                    encolar(dep, RECALCULAR);
+                    continue;
+                }
+                bool mejora = false;
+                if (porBajoSube < sube[dep])
+                {
+                    sube[dep] = porBajoSube;
+                    medioSube[dep] = bajo;
+                    mejora = true;
+                }
+                if (porBajoBaja < baja[dep])
+                {
+                    baja[dep] = porBajoBaja;
+                    medioBaja[dep] = bajo;
+                    mejora = true;
+                }
+                if (mejora)
+                    encolar(dep, CAMBIO);
+            }
+        }
+        version = grafoVial.version();
+    }
+
+    /*
+     * Tiempo minimo de origen a destino (INF si no hay camino) y su ruta en nodos del mapa.
+     * Las dos cadenas de ancestros se recorren juntas en orden de contraccion; desde la
+     * primera comun se conoce una cota y no se relaja desde nodos que ya la superan.
+     */
+    int consultar(int origen, int destinoRuta, vector<int>& ruta)
+    {
+        ruta.clear();
+        int a = rango[origen], b = rango[destinoRuta];
+        distSube[a] = 0;
+        distBaja[b] = 0;
+        int mejor = INF_TIEMPO, encuentro = -1;
+        for (int x = a, y = b; x != -1 || y != -1;)
+        {
+            if (x == y)
+            {
+                int total = sumar(distSube[x], distBaja[x]);
+                if (total < mejor)
+                {
+                    mejor = total;
+                    encuentro = x;
+                }
+                subirDesde(x, distSube, predSube, sube, mejor);
+                subirDesde(x, distBaja, predBaja, baja, mejor);
+                x = y = padreArbol(x);
+            }
+            else if (y == -1 || (x != -1 && x < y))
+            {
+                subirDesde(x, distSube, predSube, sube, mejor);
+                x = padreArbol(x);
+            }
+            else
+            {
+                subirDesde(y, distBaja, predBaja, baja, mejor);
+                y = padreArbol(y);
+            }
+        }
+        if (encuentro >= 0)
+        {
+            vector<int> subida;
+            for (int x = encuentro; x != a; x = inferior[predSube[x]])
+                subida.push_back(predSube[x]);
+            ruta.push_back(origen);
+            for (auto it = subida.rbegin(); it != subida.rend(); ++it)
+                desempacar(*it, true, ruta);
+            for (int x = encuentro; x != b; x = inferior[predBaja[x]])
+                desempacar(predBaja[x], false, ruta);
+        }
+        for (int x = a; x != -1; x = padreArbol(x))
+            distSube[x] = INF_TIEMPO;
+        for (int x = b; x != -1; x = padreArbol(x))
+            distBaja[x] = INF_TIEMPO;
+        return mejor;
+    }
+
+    // Guarda orden y contraccion (lo que no depende de los pesos)
+    bool guardar(const string& ruta) const
+    {
+        if (n == 0)
+            return false;
+        CabeceraJerarquia cab;
+        memcpy(cab.magia, MAGIA_JERARQUIA, sizeof(cab.magia));
+        cab.version = VERSION_JERARQUIA;
+        cab.marcaOrdenBytes = MARCA_ORDEN_JERARQUIA;
+        cab.nodos = n;
+        cab.huellaMapa = huella;
+        cab.arcosMapa = static_cast<uint64_t>(grafoVial.numArcos());
+        cab.atajos = destino.size();
+        string rutaTemporal = ruta + ".tmp";
+        ofstream out(rutaTemporal, ios::binary | ios::trunc);
+        if (!out)
+        {
+            consola() << "[ERROR] No se pudo crear la jerarquia: " << rutaTemporal << endl;
+            return false;
+        }
+        cab.crcDatos = crcDatos();
+        cab.reservado = 0;
+        out.write(reinterpret_cast<const char*>(&cab), sizeof(cab));
+        out.write(reinterpret_cast<const char*>(orden.data()), static_cast<streamsize>(orden.size() * sizeof(int)));
+        out.write(reinterpret_cast<const char*>(inicio.data()), static_cast<streamsize>(inicio.size() * sizeof(int)));
+        out.write(reinterpret_cast<const char*>(destino.data()), static_cast<streamsize>(destino.size() * sizeof(int)));
+        out.close();
+        if (!out || rename(rutaTemporal.c_str(), ruta.c_str()) != 0)
+        {
+            consola() << "[ERROR] No se pudo escribir la jerarquia en " << ruta << endl;
+            return false;
+        }
+        return true;
+    }
+
+    // Carga una jerarquia preparada para este mismo mapa y la personaliza con los pesos actuales
+    bool cargar(const string& ruta)
+    {
+        ifstream in(ruta, ios::binary);
+        CabeceraJerarquia cab;
+        if (!in || !in.read(reinterpret_cast<char*>(&cab), sizeof(cab)) ||
+            memcmp(cab.magia, MAGIA_JERARQUIA, sizeof(cab.magia)) != 0 || cab.version != VERSION_JERARQUIA ||
+            cab.marcaOrdenBytes != MARCA_ORDEN_JERARQUIA)
+        {
+            consola() << "[ERROR] " << ruta << " no es una jerarquia de rutas valida.\n";
+            return false;
+        }
+        if (cab.nodos != numNodosAmbulancia || cab.arcosMapa != static_cast<uint64_t>(grafoVial.numArcos()) ||
+            cab.huellaMapa != huellaDe(grafoVial))
+        {
+            consola() << "[ERROR] La jerarquia de " << ruta << " se preparo para otro mapa vial.\n";
+            return false;
+        }
+        error_code ec;
+        uint64_t bytes = filesystem::file_size(ruta, ec);
+        if (ec || bytes != sizeof(cab) + (2 * static_cast<uint64_t>(cab.nodos) + 1 + cab.atajos) * sizeof(int))
+        {
+            consola() << "[ERROR] La jerarquia de " << ruta << " esta incompleta o dañada.\n";
+            return false;
+        }
+        n = cab.nodos;
+        orden.resize(n);
+        inicio.resize(n + 1);
+        destino.resize(cab.atajos);
+        in.read(reinterpret_cast<char*>(orden.data()), static_cast<streamsize>(orden.size() * sizeof(int)));
+        in.read(reinterpret_cast<char*>(inicio.data()), static_cast<streamsize>(inicio.size() * sizeof(int)));
+        in.read(reinterpret_cast<char*>(destino.data()), static_cast<streamsize>(destino.size() * sizeof(int)));
+        bool valida = static_cast<bool>(in) && crcDatos() == cab.crcDatos && inicio[0] == 0 &&
+                      inicio[n] == static_cast<int>(cab.atajos);
+        rango.assign(n, -1);
+        for (int r = 0; valida && r < n; ++r)
+        {
+            valida = orden[r] >= 0 && orden[r] < n && rango[orden[r]] < 0;
+            if (valida)
+                rango[orden[r]] = r;
+        }
+        for (int x = 0; valida && x < n; ++x)
+            for (int e = inicio[x]; valida && e < inicio[x + 1]; ++e)
+                valida = destino[e] > x && destino[e] < n && (e == inicio[x] || destino[e] > destino[e - 1]);
+        // Grafo lleno: los vecinos altos de x, salvo el primero, son vecinos de ese primero (personalizar lo supone)
+        for (int x = 0; valida && x < n; ++x)
+        {
+            int k = inicio[x] < inicio[x + 1] ? inicio[destino[inicio[x]]] : 0;
+            for (int e = inicio[x] + 1; valida && e < inicio[x + 1]; ++e)
+            {
+                int fin = inicio[destino[inicio[x]] + 1];
+                while (k < fin && destino[k] < destino[e])
+                    ++k;
+                valida = k < fin && destino[k] == destino[e];
+            }
+        }
+        // Cada via del mapa tiene su arista: si faltara, su peso no llegaria a la personalizacion
+        for (int u = 0; valida && u < n; ++u)
+            for (int a = grafoVial.primerArco(u); valida && a < grafoVial.finArcos(u); ++a)
+            {
+                int x = rango[u], y = rango[grafoVial.destinoDe(a)];
+                valida = x == y || arista(min(x, y), max(x, y)) >= 0;
+            }
+        if (!valida)
+        {
+            n = 0;
+            version = -1;
+            consola() << "[ERROR] La jerarquia de " << ruta << " esta incompleta o dañada.\n";
+            return false;
+        }
+        huella = cab.huellaMapa;
+        indexar();
+        personalizar();
+        return true;
+    }
+};
+
+JerarquiaContraccion jerarquiaRutas;
+
+// Carga la jerarquia de disco; si el archivo no existe, la prepara para el mapa actual y la guarda ahi
+bool prepararJerarquiaRutas(const string& ruta)
+{
+    auto inicio = chrono::steady_clock::now();
+    bool existe = ifstream(ruta).good();
+    if (existe ? !jerarquiaRutas.cargar(ruta) : (!jerarquiaRutas.preparar() || !jerarquiaRutas.guardar(ruta)))
+        return false;
+    consola() << "[INFO] Jerarquia de rutas " << (existe ? "cargada de " : "preparada y guardada en ") << ruta << ": "
+              << numNodosAmbulancia << " nodos, " << jerarquiaRutas.numAtajos() << " aristas, "
+              << chrono::duration<double, milli>(chrono::steady_clock::now() - inicio).count() << " ms.\n";
+    return true;
+}
+
+/*
+ * Despacho con una sola busqueda en lugar de una por ambulancia. Como las calles
+ * son de doble sentido con el mismo tiempo (grafo simetrico), se hace Dijkstra
+ * desde la emergencia hacia afuera y se corta al fijar el primer nodo con una
+ * ambulancia disponible: solo se explora la zona hasta la ambulancia mas
+ * cercana, sin importar el tamaño de la flota. A igual tiempo gana la que
+ * aparece primero en la flota, como al buscar ambulancia por ambulancia: antes
+ * de cortar se terminan de fijar los nodos a ese mismo tiempo, que con calles de
+ * tiempo 0 pueden tener otra ambulancia. La ruta de la elegida sale de una
+ * segunda busqueda desde ella hasta la emergencia, con el mismo desempate que
+ * calcularRutas, asi que coincide con la de recalcularRutaEmergencia cuando esta
+ * no usa la tabla ni la jerarquia (que entre rutas empatadas pueden dar otra).
+ * Si el grafo deja de ser simetrico se usa Dijkstra multi-origen sembrado con las
+ * ambulancias (hasta fijar la emergencia), y con pesos negativos SPFA
+ * multi-origen. Los arreglos se reutilizan y solo se limpian los nodos tocados.
+ */
+class DespachoAmbulancias
+{
+private:
+    vector<int> dist, padre, fuente, aristasEnRuta;
+    vector<char> enCola;
+    vector<int> tocados;
+    vector<int> ambulanciaEn; // por nodo: primera ambulancia disponible ahi (INT32_MAX si ninguna)
+    vector<int> nodosConAmbulancia;
+
+    void preparar()
+    {
+        if (dist.size() != static_cast<size_t>(numNodosAmbulancia))
+        {
+            dist.assign(numNodosAmbulancia, INF_TIEMPO);
+            padre.assign(numNodosAmbulancia, -1);
+            fuente.assign(numNodosAmbulancia, INT32_MAX);
+            aristasEnRuta.assign(numNodosAmbulancia, 0);
+            enCola.assign(numNodosAmbulancia, 0);
+            ambulanciaEn.assign(numNodosAmbulancia, INT32_MAX);
+        }
+        else
+        {
+            for (int v : nodosConAmbulancia)
+                ambulanciaEn[v] = INT32_MAX;
+            for (int v : tocados)
+            {
+                dist[v] = INF_TIEMPO;
+                padre[v] = -1;
+                fuente[v] = INT32_MAX;
+                aristasEnRuta[v] = 0;
+                enCola[v] = 0;
+            }
+        }
+        tocados.clear();
+        nodosConAmbulancia.clear();
+    }
+
+    // Camino a v por u si es mas corto, o igual de corto desde una ambulancia anterior en la flota
+    bool relajar(int u, int v, int peso)
+    {
+        int nueva = dist[u] + peso;
+        if (nueva > dist[v] || (nueva == dist[v] && fuente[u] >= fuente[v]))
+            return false;
+        if (dist[v] == INF_TIEMPO)
+            tocados.push_back(v);
+        dist[v] = nueva;
+        padre[v] = u;
+        fuente[v] = fuente[u];
+        return true;
+    }
+
+    // Desde la emergencia (grafo simetrico): hasta fijar un nodo con ambulancia; devuelve su indice o -1
+    int dijkstraDesdeEmergencia(int destino)
+    {
+        for (size_t i = 0; i < ambulancias.size(); ++i)
+        {
+            int nodo = ambulancias[i].nodoActual;
+            if (!ambulancias[i].disponible || nodo < 0 || nodo >= numNodosAmbulancia)
+                continue;
+            if (ambulanciaEn[nodo] == INT32_MAX)
+                nodosConAmbulancia.push_back(nodo);
+            ambulanciaEn[nodo] = min(ambulanciaEn[nodo], static_cast<int>(i));
+        }
+        if (nodosConAmbulancia.empty())
+            return -1;
+
+        priority_queue<pair<int, int>, vector<pair<int, int>>, greater<pair<int, int>>> heap;
+        dist[destino] = 0;
+        tocados.push_back(destino);
+        heap.push({ 0, destino });
+        int mejor = INT32_MAX, nodoMejor = -1, tiempoMejor = INF_TIEMPO;
+        while (!heap.empty())
+        {
+            auto [d, u] = heap.top();
+            heap.pop();
+            if (d != dist[u])
+                continue;
+            if (d > tiempoMejor)
+                break; // ya no hay empates posibles
+            if (ambulanciaEn[u] < mejor)
+            {
+                mejor = ambulanciaEn[u];
+                nodoMejor = u;
+                tiempoMejor = d;
+            }
+            for (int a = grafoVial.primerArco(u); a < grafoVial.finArcos(u); ++a)
+            {
+                int v = grafoVial.destinoDe(a);
+                int nueva = d + grafoVial.pesoDe(a);
+                // Ya con ganadora solo interesan las calles de tiempo 0 (nodos al mismo tiempo)
+                if (nueva < dist[v] && nueva <= tiempoMejor)
+                {
+                    if (dist[v] == INF_TIEMPO)
+                        tocados.push_back(v);
+                    dist[v] = nueva;
+                    padre[v] = u;
+                    heap.push({ nueva, v });
+                }
+            }
+        }
+        return nodoMejor;
+    }
+
+    // Ruta de origen a destino como la deja calcularRutas (Dijkstra con desempate por id), cortando al fijar destino
+    void rutaDesde(int origen, int destino, vector<int>& ruta)
+    {
+        preparar();
+        priority_queue<pair<int, int>, vector<pair<int, int>>, greater<pair<int, int>>> heap;
+        dist[origen] = 0;
+        tocados.push_back(origen);
+        heap.push({ 0, origen });
+        while (!heap.empty())
+        {
+            auto [d, u] = heap.top();
+            heap.pop();
+            if (d != dist[u])
+                continue;
+            if (u == destino)
+                break; // con pesos >= 0 los predecesores del camino ya no cambian
+            for (int a = grafoVial.primerArco(u); a < grafoVial.finArcos(u); ++a)
+            {
+                int v = grafoVial.destinoDe(a);
+                bool nuevo = dist[v] == INF_TIEMPO;
+                if (relajarArista(u, v, grafoVial.pesoDe(a), dist, padre, true))
+                {
+                    if (nuevo)
+                        tocados.push_back(v);
+                    heap.push({ dist[v], v });
+                }
+            }
+        }
+        ruta = reconstruirRuta(origen, destino, padre);
+    }
+
+    void sembrar()
+    {
+        for (size_t i = 0; i < ambulancias.size(); ++i)
+        {
+            int nodo = ambulancias[i].nodoActual;
+            if (!ambulancias[i].disponible || nodo < 0 || nodo >= numNodosAmbulancia || dist[nodo] == 0)
+                continue;
+            dist[nodo] = 0;
+            fuente[nodo] = static_cast<int>(i);
+            tocados.push_back(nodo);
+        }
+    }
+
+    void dijkstraHasta(int destino)
+    {
+        using Entrada = tuple<int, int, int>; // (tiempo, ambulancia, nodo)
+        priority_queue<Entrada, vector<Entrada>, greater<Entrada>> heap;
+        for (int v : tocados)
+            heap.push({ 0, fuente[v], v });
+        while (!heap.empty())
+        {
+            auto [d, f, u] = heap.top();
+            heap.pop();
+            if (d != dist[u] || f != fuente[u])
+                continue;
+            if (u == destino)
+                return;
+            for (int a = grafoVial.primerArco(u); a < grafoVial.finArcos(u); ++a)
+            {
+                int v = grafoVial.destinoDe(a);
+                if (relajar(u, v, grafoVial.pesoDe(a)))
+                    heap.push({ dist[v], fuente[v], v });
+            }
+        }
+    }
+
+    bool spfa()
+    {
+        deque<int> cola(tocados.begin(), tocados.end());
+        for (int v : cola)
+            enCola[v] = 1;
+        while (!cola.empty())
+        {
+            int u = cola.front();
+            cola.pop_front();
+            enCola[u] = 0;
+            for (int a = grafoVial.primerArco(u); a < grafoVial.finArcos(u); ++a)
+            {
+                int v = grafoVial.destinoDe(a);
+                if (!relajar(u, v, grafoVial.pesoDe(a)))
+                    continue;
+                aristasEnRuta[v] = aristasEnRuta[u] + 1;
+                if (aristasEnRuta[v] >= numNodosAmbulancia)
+                {
+                    consola() << "[ALERTA] Se detecto un posible ciclo negativo en el mapa urbano.\n";
+                    return false;
+                }
+                if (!enCola[v])
+                {
+                    enCola[v] = 1;
+                    cola.push_back(v);
+                }
+            }
+        }
+        return true;
+    }
+
+public:
+    // Indice en 'ambulancias' de la disponible mas cercana a destino (o -1), con su tiempo y ruta
+    int masCercana(int destino, int& tiempo, vector<int>& ruta)
+    {
+        preparar();
+        ruta.clear();
+        tiempo = INF_TIEMPO;
+        if (destino < 0 || destino >= numNodosAmbulancia)
+            return -1;
+        if (tablaTiempos.vigente())
+        {
+            int mejor = -1;
+            for (size_t i = 0; i < ambulancias.size(); ++i)
+            {
+                int nodo = ambulancias[i].nodoActual;
+                if (ambulancias[i].disponible && nodo >= 0 && nodo < numNodosAmbulancia &&
+                    tablaTiempos.tiempo(nodo, destino) < tiempo)
+                {
+                    tiempo = tablaTiempos.tiempo(nodo, destino);
+                    mejor = static_cast<int>(i);
+                }
+            }
+            if (mejor < 0)
+                return -1;
+            ruta = tablaTiempos.ruta(ambulancias[mejor].nodoActual, destino);
+            if (!ruta.empty())
+                return mejor;
+            tiempo = INF_TIEMPO; // ciclo de tiempo 0 en los saltos: se busca como sin tabla
+        }
+        if (grafoVial.arcosNegativos() == 0 && grafoVial.esSimetrico())
+        {
+            int nodo = dijkstraDesdeEmergencia(destino);
+            if (nodo < 0)
+                return -1;
+            int idx = ambulanciaEn[nodo];
+            tiempo = dist[nodo];
+            rutaDesde(nodo, destino, ruta);
+            return idx;
+        }
+        sembrar();
+        if (tocados.empty())
+            return -1;
+        if (grafoVial.arcosNegativos() == 0)
+            dijkstraHasta(destino);
+        else if (!spfa())
+            return -1;
+        if (dist[destino] == INF_TIEMPO)
+            return -1;
+        int idx = fuente[destino];
+        tiempo = dist[destino];
+        if (grafoVial.arcosNegativos() == 0)
+            rutaDesde(ambulancias[idx].nodoActual, destino, ruta);
+        else
+            ruta = reconstruirRuta(ambulancias[idx].nodoActual, destino, padre); // SPFA no desempata
+        return ruta.empty() ? -1 : idx;
+    }
+};
+
+DespachoAmbulancias despachoAmbulancias;
+
+// Actualizar peso de una calle (para simular trafico, desvio, bloqueo, etc.). O(1): dos pesos del CSR,
+// mas los pares afectados de la tabla de tiempos y los atajos de la jerarquia que dependen de ella
+bool actualizarPesoArista(int u, int v, int nuevoPeso)
+{
+    bool conJerarquia = jerarquiaRutas.vigente();
+    bool cambiada = tablaTiempos.vigente() ? tablaTiempos.cambiarPeso(u, v, nuevoPeso) : grafoVial.cambiarPeso(u, v, nuevoPeso);
+    if (!cambiada)
+    {
+        consola() << "[ADVERTENCIA] No se encontro una via entre " << u << " y " << v << ".\n";
+        return false;
+    }
+    if (conJerarquia)
+        jerarquiaRutas.actualizarPeso(u, v);
+    registrarMutacion(Mutacion(MUT_PESO_ARISTA).entero(u).entero(v).entero(nuevoPeso));
+    consola() << "[INFO] Peso de la arista (" << u << "," << v << ") actualizado a " << nuevoPeso << " minutos.\n";
+    return true;
+}
+
+struct CambioPesoVia
+{
+    int u;
+    int v;
+    int peso;
+};
+
+// Reporte de trafico en lote: cada cambio escribe sus dos pesos en el CSR, sin reconstruirlo
+int actualizarPesosEnLote(const vector<CambioPesoVia>& cambios)
+{
+    int aplicados = 0;
+    for (const CambioPesoVia& c : cambios)
+    {
+        bool conJerarquia = jerarquiaRutas.vigente();
+        bool cambiada = tablaTiempos.vigente() ? tablaTiempos.cambiarPeso(c.u, c.v, c.peso)
+                                               : grafoVial.cambiarPeso(c.u, c.v, c.peso);
+        if (!cambiada)
+        {
+            consola() << "[ADVERTENCIA] No se encontro una via entre " << c.u << " y " << c.v << ".\n";
+            continue;
+        }
+        if (conJerarquia)
+            jerarquiaRutas.actualizarPeso(c.u, c.v);
+        registrarMutacion(Mutacion(MUT_PESO_ARISTA).entero(c.u).entero(c.v).entero(c.peso));
+        aplicados++;
+    }
+    consola() << "[INFO] " << aplicados << " de " << cambios.size() << " vias actualizadas.\n";
+    return aplicados;
+}
+
+// Registrar una nueva emergencia en el sistema
+bool registrarEmergenciaEnNodo(int nodo)
+{
+    if (nodo < 0 || nodo >= numNodosAmbulancia)
+    {
+        consola() << "[ERROR] Nodo fuera de rango.\n";
+        return false;
+    }
+
+    EmergenciaRuta e;
+    e.idEmergencia = contadorEmergencias++;
+    e.nodoDestino = nodo;
+    e.atendida = false;
+    e.idAmbulanciaAsignada = -1;
+    e.tiempoEstimado = INF_TIEMPO;
+
+    emergencias.push_back(e);
+
+    consola() << "[INFO] Emergencia #" << e.idEmergencia
+              << " registrada en nodo " << e.nodoDestino << ".\n";
+    return true;
+}
+
+void registrarEmergencia()
+{
+    int nodo;
+    consola() << "\n[EMERGENCIA] Ingrese nodo de la emergencia (0-" << (numNodosAmbulancia - 1) << "): ";
+    cin >> nodo;
+    registrarEmergenciaEnNodo(nodo);
+}
+
+// Asignar la ambulancia mas cercana a una emergencia especifica
+void asignarAmbulanciaMasCercana(int idEmergencia)
+{
+    if (emergencias.empty())
+    {
+        consola() << "[INFO] No hay emergencias registradas.\n";
+        return;
+    }
+
+    EmergenciaRuta* objetivo = nullptr;
+    for (auto& e : emergencias)
+    {
+        if (e.idEmergencia == idEmergencia)
+        {
+            objetivo = &e;
+            break;
+        }
+    }
+
+    if (!objetivo)
+    {
+        consola() << "[ERROR] Emergencia con ID " << idEmergencia << " no encontrada.\n";
+        return;
+    }
+    if (objetivo->atendida)
+    {
+        consola() << "[INFO] La emergencia #" << idEmergencia << " ya fue atendida.\n";
+        return;
+    }
+
+    int mejorTiempo;
+    vector<int> mejorRuta;
+    int idxMejorAmb = despachoAmbulancias.masCercana(objetivo->nodoDestino, mejorTiempo, mejorRuta);
+
+    if (idxMejorAmb == -1)
+    {
+        consola() << "[ALERTA] No hay ambulancias disponibles para esta emergencia.\n";
+        return;
+    }
+
+    // Asignacion final
+    objetivo->atendida = true;
+    objetivo->idAmbulanciaAsignada = ambulancias[idxMejorAmb].idAmbulancia;
+    objetivo->ruta = mejorRuta;
+    objetivo->tiempoEstimado = mejorTiempo;
+    ambulancias[idxMejorAmb].disponible = false;
+
+    consola() << "\n[ASIGNACION] Emergencia #" << objetivo->idEmergencia
+              << " atendida por Ambulancia #" << objetivo->idAmbulanciaAsignada << ".\n";
+    consola() << "Ruta optima: ";
+    for (int nodo : objetivo->ruta)
+        consola() << nodo << " ";
+    consola() << "\nTiempo estimado de llegada: " << objetivo->tiempoEstimado << " minutos.\n";
+}
+
+// Asignar ambulancias a todas las emergencias pendientes (emergencias simultaneas)
+void asignarEmergenciasSimultaneas()
+{
+    if (emergencias.empty())
+    {
+        consola() << "[INFO] No hay emergencias registradas.\n";
+        return;
+    }
+
+    consola() << "\n[EMERGENCIAS] Asignando ambulancias a todas las emergencias pendientes...\n";
+
+    bool huboAsignaciones = false;
+
+    // Estrategia greedy: siempre buscar la mejor ambulancia para cada emergencia pendiente (una busqueda por emergencia)
+    for (auto& e : emergencias)
+    {
+        if (e.atendida)
+            continue;
+
+        int mejorTiempo;
+        vector<int> mejorRuta;
+        int idxMejorAmb = despachoAmbulancias.masCercana(e.nodoDestino, mejorTiempo, mejorRuta);
+
+        if (idxMejorAmb != -1)
+        {
+            e.atendida = true;
+            e.idAmbulanciaAsignada = ambulancias[idxMejorAmb].idAmbulancia;
+            e.ruta = mejorRuta;
+            e.tiempoEstimado = mejorTiempo;
+            ambulancias[idxMejorAmb].disponible = false;
+            huboAsignaciones = true;
+
+            consola() << "[ASIGNACION] Emergencia #" << e.idEmergencia
+                      << " -> Ambulancia #" << e.idAmbulanciaAsignada
+                      << " (ETA: " << e.tiempoEstimado << " min)\n";
+        }
+    }
+
+    if (!huboAsignaciones)
+        consola() << "[INFO] No se pudo asignar ninguna ambulancia (todas ocupadas o sin ruta).\n";
+}
+
+// Recalcula la ruta de una emergencia ya asignada (tras un cambio de trafico)
+bool recalcularRutaEmergencia(int idEmerg)
+{
+    EmergenciaRuta* e = nullptr;
+    for (auto& em : emergencias)
+    {
+        if (em.idEmergencia == idEmerg)
+        {
+            e = &em;
+            break;
+        }
+    }
+
+    if (!e)
+    {
+        consola() << "[ERROR] Emergencia no encontrada.\n";
+        return false;
+    }
+
+    if (e->idAmbulanciaAsignada == -1)
+    {
+        consola() << "[INFO] La emergencia seleccionada aun no tiene ambulancia asignada.\n";
+        return false;
+    }
+
+    // Buscamos la ambulancia que tiene ese ID
+    Ambulancia* amb = nullptr;
+    for (auto& a : ambulancias)
+    {
+        if (a.idAmbulancia == e->idAmbulanciaAsignada)
+        {
+            amb = &a;
+            break;
+        }
+    }
+
+    if (!amb)
+    {
+        consola() << "[ERROR] No se encontro la ambulancia asignada.\n";
+        return false;
+    }
+
+    vector<int> nuevaRuta;
+    int nuevoTiempo = INF_TIEMPO;
+    if (tablaTiempos.vigente())
+    {
+        nuevaRuta = tablaTiempos.ruta(amb->nodoActual, e->nodoDestino);
+        nuevoTiempo = tablaTiempos.tiempo(amb->nodoActual, e->nodoDestino);
+    }
+    else if (jerarquiaRutas.vigente() && grafoVial.arcosNegativos() == 0)
+        nuevoTiempo = jerarquiaRutas.consultar(amb->nodoActual, e->nodoDestino, nuevaRuta);
+    if (nuevaRuta.empty()) // sin tabla ni jerarquia, o saltos que no llegan (ciclo de tiempo 0)
+    {
+        vector<int> dist, padre;
+        if (!calcularRutas(amb->nodoActual, dist, padre))
+        {
+            consola() << "[ERROR] No se pudo recalcular la ruta.\n";
+            return false;
+        }
+        nuevaRuta = reconstruirRuta(amb->nodoActual, e->nodoDestino, padre);
+        nuevoTiempo = dist[e->nodoDestino];
+    }
+    if (nuevaRuta.empty())
+    {
+        consola() << "[ALERTA] Tras el cambio de trafico ya no existe ruta valida hacia la emergencia.\n";
+        return false;
+    }
+
+    e->ruta = nuevaRuta;
+    e->tiempoEstimado = nuevoTiempo;
+
+    consola() << "\n[NUEVA RUTA] Emergencia #" << e->idEmergencia
+              << " atendida por Ambulancia #" << e->idAmbulanciaAsignada << ".\n";
+    consola() << "Ruta recalculada: ";
+    for (int nodo : e->ruta)
+        consola() << nodo << " ";
+    consola() << "\nNuevo tiempo estimado de llegada: " << e->tiempoEstimado << " minutos.\n";
+    return true;
+}
+
+// Permite actualizar el trafico y recalcular la ruta de una emergencia ya asignada
+void actualizarTraficoYRecalcular()
+{
+    if (emergencias.empty())
+    {
+        consola() << "[INFO] No hay emergencias registradas.\n";
+        return;
+    }
+
+    int u, v, nuevoPeso;
+    consola() << "\n[TRAFICO] Actualizar peso de una via.\n";
+    consola() << "Nodo origen: ";
+    cin >> u;
+    consola() << "Nodo destino: ";
+    cin >> v;
+    consola() << "Nuevo tiempo estimado (minutos, puede ser negativo como penalizacion): ";
+    cin >> nuevoPeso;
+
+    actualizarPesoArista(u, v, nuevoPeso);
+
+    int idEmerg;
+    consola() << "\n[RECALCULO] Ingrese ID de la emergencia a recalcular: ";
+    cin >> idEmerg;
+    recalcularRutaEmergencia(idEmerg);
+}
+
+// Mostrar resumen de emergencias registradas y tiempos estimados
+void mostrarResumenEmergencias()
+{
+    if (emergencias.empty())
+    {
+        consola() << "\n[INFO] No hay emergencias registradas.\n";
+        return;
+    }
+
+    consola() << "\n========== RESUMEN DE EMERGENCIAS ==========\n";
+    for (const auto& e : emergencias)
+    {
+        consola() << "Emergencia #" << e.idEmergencia
+                  << " | Nodo: " << e.nodoDestino
+                  << " | Estado: " << (e.atendida ? "ATENDIDA" : "PENDIENTE");
+
+        if (e.atendida)
+        {
+            consola() << " | Ambulancia #" << e.idAmbulanciaAsignada
+                      << " | ETA: " << e.tiempoEstimado << " min";
+        }
+        consola() << "\n";
+    }
+    consola() << "===========================================\n";
+}
+
+// Las ambulancias ocupadas terminan su servicio y quedan disponibles donde atendieron la emergencia
+int liberarAmbulancias()
+{
+    unordered_map<int, int> ultimoDestino;
+    for (const auto& e : emergencias)
+        if (e.atendida)
+            ultimoDestino[e.idAmbulanciaAsignada] = e.nodoDestino;
+    int liberadas = 0;
+    for (auto& a : ambulancias)
+    {
+        if (a.disponible)
+            continue;
+        auto it = ultimoDestino.find(a.idAmbulancia);
+        if (it != ultimoDestino.end())
+            a.nodoActual = it->second;
+        a.disponible = true;
+        liberadas++;
+    }
+    consola() << "[INFO] " << liberadas << " ambulancia(s) de vuelta en servicio.\n";
+    return liberadas;
+}
+
+// Sub-menu principal del modulo de rutas de ambulancia
+void optimizarRutaAmbulancia()
+{
+    int opcion = -1;
+    do
+    {
+        consola() << "\n---------------- MODULO DE RUTAS DE AMBULANCIAS ----------------\n";
+        consola() << "1. Registrar nueva emergencia\n";
+        consola() << "2. Asignar ambulancia mas cercana a una emergencia\n";
+        consola() << "3. Asignar ambulancias a todas las emergencias pendientes\n";
+        consola() << "4. Actualizar trafico y recalcular ruta de una emergencia\n";
+        consola() << "5. Ver resumen de emergencias y tiempos estimados\n";
+        consola() << "6. Liberar ambulancias que terminaron su servicio\n";
+        consola() << "7. Activar/desactivar tabla de tiempos entre todos los nodos\n";
+        consola() << "8. Preparar o cargar jerarquia de rutas (mapas grandes)\n";
+        consola() << "0. Volver al menu principal\n";
+        consola() << "Seleccione una opcion: ";
+        cin >> opcion;
+
+        switch (opcion)
+        {
+        case 1:
+            registrarEmergencia();
+            break;
+        case 2:
+        {
+            int id;
+            consola() << "Ingrese ID de la emergencia a asignar: ";
+            cin >> id;
+            asignarAmbulanciaMasCercana(id);
+            break;
+        }
+        case 3:
+            asignarEmergenciasSimultaneas();
+            break;
+        case 4:
+            actualizarTraficoYRecalcular();
+            break;
+        case 5:
+            mostrarResumenEmergencias();
+            break;
+        case 6:
+            liberarAmbulancias();
+            break;
+        case 7:
+            activarTablaTiempos(!tablaTiempos.vigente());
+            break;
+        case 8:
+        {
+            string ruta;
+            consola() << "Archivo de la jerarquia (se crea si no existe): ";
+            cin >> ruta;
+            prepararJerarquiaRutas(ruta);
+            break;
+        }
+        case 0:
+            consola() << "[INFO] Volviendo al menu principal...\n";
+            break;
+        default:
+            consola() << "[ERROR] Opcion no valida en modulo de ambulancias.\n";
+            break;
+        }
+
+    } while (opcion != 0);
+}
+
+// --- 4C. IMPORTACION MASIVA PARALELA DESDE CSV ---
+
+/*
+ * Formatos (una fila por linea; se admite un encabezado en la primera linea):
+ *   pacientes: idPaciente,dni,nombreCompleto
+ *   medicos:   idMedico,nombreCompleto,especialidad[,disponible 0/1]
+ *   citas:     el formato de la seccion 3C
+ * El archivo se mapea en memoria y se divide en bloques que terminan en un
+ * salto de linea; cada hilo parsea su bloque con vistas (string_view) sobre
+ * el mapeo, sin copiar lineas ni campos intermedios.
+ */
+
+// Archivo completo de solo lectura (mmap; en Windows se lee a memoria)
+class ArchivoMapeado
+{
+private:
+    const char* base = nullptr;
+    size_t tamano = 0;
+#ifdef _WIN32
+    vector<char> copia;
+#endif
+
+public:
+    ArchivoMapeado() {}
+    ArchivoMapeado(const ArchivoMapeado&) = delete;
+    ArchivoMapeado& operator=(const ArchivoMapeado&) = delete;
+
+    ~ArchivoMapeado()
+    {
+#ifndef _WIN32
+        if (base && tamano > 0)
+            munmap(const_cast<char*>(base), tamano);
+#endif
+    }
+
+    bool abrir(const string& ruta)
+    {
+#ifdef _WIN32
+        ifstream in(ruta, ios::binary);
+        if (!in)
+            return false;
+        copia.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+        base = copia.data();
+        tamano = copia.size();
+        return true;
+#else
+        int fd = open(ruta.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat info;
+        if (fstat(fd, &info) != 0)
+        {
+            close(fd);
+            return false;
+        }
+        tamano = static_cast<size_t>(info.st_size);
+        if (tamano == 0)
+        {
+            close(fd);
+            base = "";
+            return true;
+        }
+        void* p = mmap(nullptr, tamano, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (p == MAP_FAILED)
+        {
+            tamano = 0;
+            return false;
+        }
+        madvise(p, tamano, MADV_SEQUENTIAL);
+        base = static_cast<const char*>(p);
+        return true;
+#endif
+    }
+
+    string_view contenido() const
+    {
+        return string_view(base, tamano);
+    }
+};
+
+struct ConfigImportacion
+{
+    string rutaPacientes;
+    string rutaMedicos;
+    string rutaCitas;
+    string rutaGrafo; // mapa vial (ver cargarGrafoDesdeArchivo); no cuenta en vacia()
+    int hilos = 0; // 0: uno por nucleo
+
+    bool vacia() const
+    {
+        return rutaPacientes.empty() && rutaMedicos.empty() && rutaCitas.empty();
+    }
+};
+
+struct ResultadoImportacion
+{
+    size_t filas = 0;
+    long long filasInvalidas = 0;
+    size_t bytes = 0;
+    int hilos = 0;
+    double msParseo = 0;
+};
+
+/**
+ * Parsea 'ruta' en paralelo. 'parsear(linea, registro)' convierte una linea;
+ * las que fallan se cuentan como invalidas (salvo un encabezado en la linea 1).
+ * Cada hilo llena su propio vector y al final los bloques se mueven, en
+ * paralelo, a su posicion en 'salida', conservando el orden del archivo.
+ */
+template <typename T, typename Parser>
+bool importarArchivoEnParalelo(const string& ruta, int hilos, Parser parsear, vector<T>& salida,
+                               ResultadoImportacion& res)
+{
+    auto inicio = chrono::steady_clock::now();
+    ArchivoMapeado archivo;
+    if (!archivo.abrir(ruta))
+    {
+        consola() << "[ERROR] No se pudo abrir " << ruta << endl;
+        return false;
+    }
+    string_view datos = archivo.contenido();
+    res.bytes = datos.size();
+
+    // Bloques de al menos 1 MB, cortados justo despues de un salto de linea
+    const size_t minimoBloque = 1 << 20;
+    size_t numBloques = max<size_t>(1, min<size_t>(static_cast<size_t>(hilos), datos.size() / minimoBloque));
+    vector<size_t> cortes(numBloques + 1, datos.size());
+    cortes[0] = 0;
+    for (size_t b = 1; b < numBloques; ++b)
+    {
+        size_t pos = max(cortes[b - 1], datos.size() * b / numBloques);
+        size_t salto = datos.find('\n', pos);
+        cortes[b] = (salto == string_view::npos) ? datos.size() : salto + 1;
+    }
+    res.hilos = static_cast<int>(numBloques);
+
+    vector<vector<T>> parciales(numBloques);
+    vector<long long> invalidas(numBloques, 0);
+    auto trabajar = [&](size_t b)
+    {
+        string_view bloque = datos.substr(cortes[b], cortes[b + 1] - cortes[b]);
+        vector<T>& destino = parciales[b];
+        destino.reserve(bloque.size() / 48 + 1); // estimacion: ~48 bytes por fila
+        bool primeraLinea = (b == 0);
+        size_t pos = 0;
+        while (pos < bloque.size())
+        {
+            size_t fin = bloque.find('\n', pos);
+            if (fin == string_view::npos)
+                fin = bloque.size();
+            string_view linea = bloque.substr(pos, fin - pos);
+            pos = fin + 1;
+            if (linea.empty() || linea == "\r")
+                continue;
+            destino.emplace_back();
+            if (!parsear(linea, destino.back()))
+            {
+                destino.pop_back();
+                if (!primeraLinea) // la primera linea invalida del archivo es el encabezado
+                    invalidas[b]++;
+            }
+            primeraLinea = false;
+        }
+    };
+
+    vector<thread> trabajadores;
+    for (size_t b = 1; b < numBloques; ++b)
+        trabajadores.emplace_back(trabajar, b);
+    trabajar(0);
+    for (thread& t : trabajadores)
+        t.join();
+    trabajadores.clear();
+
+    vector<size_t> desplazamiento(numBloques + 1, 0);
+    for (size_t b = 0; b < numBloques; ++b)
+    {
+        desplazamiento[b + 1] = desplazamiento[b] + parciales[b].size();
+        res.filasInvalidas += invalidas[b];
+    }
+    res.filas = desplazamiento[numBloques];
+    salida.clear();
+    salida.resize(res.filas);
+    auto mover = [&](size_t b)
+    {
+        move(parciales[b].begin(), parciales[b].end(), salida.begin() + static_cast<ptrdiff_t>(desplazamiento[b]));
+        vector<T>().swap(parciales[b]);
+    };
+    for (size_t b = 1; b < numBloques; ++b)
+        trabajadores.emplace_back(mover, b);
+    mover(0);
+    for (thread& t : trabajadores)
+        t.join();
+
+    res.msParseo = chrono::duration<double, milli>(chrono::steady_clock::now() - inicio).count();
+    return true;
+}
+
+static bool leerPacienteCSV(string_view linea, Paciente& p)
+{
+    string_view campos[3];
+    if (separarCamposCSV(linea, campos, 3) < 3 || !leerEnteroCSV(campos[0], p.idPaciente) || campos[1].empty())
+        return false;
+    p.dni.assign(campos[1].data(), campos[1].size());
+    asignarCampoCSV(p.nombreCompleto, campos[2]);
+    return true;
+}
+
+static bool leerMedicoCSV(string_view linea, Medico& m)
+{
+    string_view campos[4];
+    size_t n = separarCamposCSV(linea, campos, 4);
+    if (n < 3 || !leerEnteroCSV(campos[0], m.idMedico) || campos[1].empty())
+        return false;
+    asignarCampoCSV(m.nombreCompleto, campos[1]);
+    asignarCampoCSV(m.especialidad, campos[2]);
+    m.disponible = (n < 4 || campos[3] != "0");
+    return true;
+}
+
+static void reportarImportacion(const string& que, const string& ruta, const ResultadoImportacion& res)
+{
+    double segundos = res.msParseo / 1000.0;
+    consola() << "[IMPORTACION] " << que << " (" << ruta << "): " << res.filas << " filas";
+    if (res.filasInvalidas > 0)
+        consola() << ", " << res.filasInvalidas << " invalidas";
+    consola() << " en " << fixed << setprecision(1) << res.msParseo << " ms con " << res.hilos << " hilo(s) -> "
+              << setprecision(2) << (segundos > 0 ? res.filas / segundos / 1e6 : 0.0) << " M filas/s, "
+              << (segundos > 0 ? res.bytes / segundos / (1 << 20) : 0.0) << " MB/s" << endl;
+    consola().unsetf(ios::floatfield);
+}
+
+// Inserta en la tabla hash ya dimensionada; ante claves repetidas conserva la primera
+template <typename T>
+static size_t volcarEnTabla(vector<T>& filas, unordered_map<string, T>& tabla, string T::*clave)
+{
+    tabla.clear();
+    tabla.reserve(filas.size());
+    size_t repetidas = 0;
+    for (T& fila : filas)
+    {
+        string k = fila.*clave;
+        if (!tabla.emplace(move(k), move(fila)).second)
+            repetidas++;
+    }
+    vector<T>().swap(filas);
+    return repetidas;
+}
+
+static size_t volcarEnTabla(vector<Paciente>& filas, TablaPacientes& tabla, int hilos)
+{
+    size_t repetidas = tabla.cargarEnParalelo(filas, hilos);
+    vector<Paciente>().swap(filas);
+    return repetidas;
+}
+
+/**
+ * Reemplaza los datos de ejemplo por los CSV indicados (los que no se indican
+ * quedan vacios). Grafo de ambulancias e inventario usan la configuracion por defecto.
+ */
+bool importarDatosCSV(const ConfigImportacion& cfg)
+{
+    auto inicio = chrono::steady_clock::now();
+    int hilos = cfg.hilos > 0 ? cfg.hilos : max(1, static_cast<int>(thread::hardware_concurrency()));
+    ResultadoImportacion res;
+
+    vector<Paciente> pacientes;
+    if (!cfg.rutaPacientes.empty())
+    {
+        if (!importarArchivoEnParalelo(cfg.rutaPacientes, hilos, leerPacienteCSV, pacientes, res))
+            return false;
+        reportarImportacion("Pacientes", cfg.rutaPacientes, res);
+    }
+    vector<Medico> medicos;
+    if (!cfg.rutaMedicos.empty())
+    {
+        res = ResultadoImportacion();
+        if (!importarArchivoEnParalelo(cfg.rutaMedicos, hilos, leerMedicoCSV, medicos, res))
+            return false;
+        reportarImportacion("Medicos", cfg.rutaMedicos, res);
+    }
+    vector<Cita> citas;
+    if (!cfg.rutaCitas.empty())
+    {
+        res = ResultadoImportacion();
+        if (!importarArchivoEnParalelo(cfg.rutaCitas, hilos, [](string_view l, Cita& c) { return leerCitaCSV(l, c); },
+                                       citas, res))
+            return false;
+        reportarImportacion("Citas", cfg.rutaCitas, res);
+    }
+
+    auto inicioIndices = chrono::steady_clock::now();
+    size_t repetidos = volcarEnTabla(pacientes, tablaPacientes, hilos);
+    indiceNombres.reconstruir(tablaPacientes);
+    repetidos += volcarEnTabla(medicos, tablaMedicos, &Medico::nombreCompleto);
+    if (repetidos > 0)
+        consola() << "[ADVERTENCIA] " << repetidos
+                  << " pacientes/medicos repetidos; se conservo la primera fila." << endl;
+
+    // Secuencia de ingesta en el orden del archivo, igual que asignarClaveOrden; la
+    // importacion reemplaza la agenda y vacia la lista de espera, asi que empieza en 0
+    citasProgramadas.swap(citas);
+    vector<Cita>().swap(citas);
+    siguienteIdCita = 1;
+    contadorIngestaCitas = 0;
+    for (Cita& c : citasProgramadas)
+    {
+        c.claveOrden = empaquetarClaveCita(c, contadorIngestaCitas++);
+        siguienteIdCita = max(siguienteIdCita, c.idCita + 1);
+    }
+    indiceCitas.reconstruir(citasProgramadas);
+    int choques = reconstruirCalendarioMedicos();
+    if (choques > 0)
+        consola() << "[ADVERTENCIA] " << choques << " citas chocan con otra del mismo medico y horario." << endl;
+    listaEspera.limpiar();
+
+    auto fin = chrono::steady_clock::now();
+    consola() << "[IMPORTACION] Tablas e indices construidos en " << fixed << setprecision(1)
+              << chrono::duration<double, milli>(fin - inicioIndices).count() << " ms; total "
+              << chrono::duration<double, milli>(fin - inicio).count() << " ms (" << tablaPacientes.size()
+              << " pacientes, " << tablaMedicos.size() << " medicos, " << citasProgramadas.size() << " citas)." << endl;
+    consola().unsetf(ios::floatfield);
+    return true;
+}
+
+// --- 6. ASIGNACIÓN DE RECURSOS HOSPITALARIOS (GREEDY + SKEW HEAP) ---
+
+// Niveles de urgencia ESI 1-5 (1 = más urgente)
+enum class UrgenciaESI
+{
+    ESI1 = 1,
+    ESI2 = 2,
+    ESI3 = 3,
+    ESI4 = 4,
+    ESI5 = 5
+};
+
+// Paciente crítico para asignación de UCI/ventiladores
+struct PacienteCritico
+{
+    int idPaciente;
+    string dni;
+    string nombre;
+    UrgenciaESI urgencia;
+    bool necesitaUCI;
+    bool necesitaVentilador;
+    bool necesitaMedCritica;
+    long long ordenLlegada; // para desempatar por orden de llegada
+};
+
+// Comparador de prioridad: menor ESI -> más prioridad; si empatan, menor ordenLlegada
+bool tieneMayorPrioridad(const PacienteCritico& a, const PacienteCritico& b)
+{
+    if (static_cast<int>(a.urgencia) != static_cast<int>(b.urgencia))
+        return static_cast<int>(a.urgencia) < static_cast<int>(b.urgencia);
+    return a.ordenLlegada < b.ordenLlegada;
+}
+
+// Nodo de Skew Heap
+struct NodoSkew
+{
+    PacienteCritico valor;
+    NodoSkew* izq;
+    NodoSkew* der;
+
+    NodoSkew(const PacienteCritico& p) : valor(p), izq(nullptr), der(nullptr) {}
+};
+
+// Skew Heap para cola de prioridad de pacientes críticos
+class SkewHeapCritico
+{
+private:
+    NodoSkew* raiz;
+
+    static NodoSkew* fusionar(NodoSkew* a, NodoSkew* b)
+    {
+        if (!a)
+            return b;
+        if (!b)
+            return a;
+
+        // El nodo con mayor prioridad (más urgente) debe ir en la raíz
+        if (!tieneMayorPrioridad(a->valor, b->valor))
+        {
+            std::swap(a, b);
+        }
+
+        // Fusión en subárbol derecho
+        a->der = fusionar(a->der, b);
+
+        // Propiedad del skew heap: se intercambian hijos
+        std::swap(a->izq, a->der);
+        return a;
+    }
+
+    static void limpiar(NodoSkew* n)
+    {
+        if (!n)
+            return;
+        limpiar(n->izq);
+        limpiar(n->der);
+        delete n;
+    }
+
+public:
+    SkewHeapCritico() : raiz(nullptr) {}
+
+    ~SkewHeapCritico()
+    {
+        limpiar(raiz);
+    }
+
+    bool estaVacio() const
+    {
+        return raiz == nullptr;
+    }
+
+    const PacienteCritico& obtenerMaxPrioridad() const
+    {
+        return raiz->valor; // se asume que no está vacío
+    }
+
+    void insertar(const PacienteCritico& p)
+    {
+        NodoSkew* n = new NodoSkew(p);
+        raiz = fusionar(raiz, n);
+    }
+
+    void eliminarMaxPrioridad()
+    {
+        if (!raiz)
+            return;
+        NodoSkew* viejaRaiz = raiz;
+        raiz = fusionar(raiz->izq, raiz->der);
+        delete viejaRaiz;
+    }
+
+    // Copia de los pacientes en espera, sin orden particular (la conserva ordenLlegada)
+    vector<PacienteCritico> contenido() const
+    {
+        vector<PacienteCritico> resultado;
+        vector<const NodoSkew*> pila;
+        if (raiz)
+            pila.push_back(raiz);
+        while (!pila.empty())
+        {
+            const NodoSkew* n = pila.back();
+            pila.pop_back();
+            resultado.push_back(n->valor);
+            if (n->izq)
+                pila.push_back(n->izq);
+            if (n->der)
+                pila.push_back(n->der);
+        }
+        return resultado;
+    }
+
+    void vaciar()
+    {
+        limpiar(raiz);
+        raiz = nullptr;
+    }
+};
+
+// Inventario de medicamentos críticos
+struct StockMedicamento
+{
+    string nombre;
+    int cantidad;
+    int umbralMinimo;
+};
+
+class InventarioMedicamentos
+{
+private:
+    map<string, StockMedicamento> inventario;
+
+public:
+    void agregarTipoMedicamento(const string& nombre, int cantidadInicial, int umbralMinimo)
+    {
+        inventario[nombre] = { nombre, cantidadInicial, umbralMinimo };
+    }
+
+    bool consumir(const string& nombre, int cantidad)
+    {
+        auto it = inventario.find(nombre);
+        if (it == inventario.end())
+        {
+            consola() << "[ALERTA] Medicamento '" << nombre << "' no registrado.\n";
+            return false;
+        }
+        if (cantidad > it->second.cantidad)
+        {
+            consola() << "[ALERTA] Stock insuficiente de '" << nombre
+                << "'. Solicitado: " << cantidad
+                << ", disponible: " << it->second.cantidad << "\n";
+            return false;
+        }
+        it->second.cantidad -= cantidad;
+        if (it->second.cantidad < it->second.umbralMinimo)
+        {
+            consola() << "[ALERTA CRITICA] Stock bajo de '" << nombre
+                << "'. Cantidad actual: " << it->second.cantidad << "\n";
+        }
+        return true;
+    }
+
+    void reabastecer(const string& nombre, int cantidad)
+    {
+        auto it = inventario.find(nombre);
+        if (it == inventario.end())
+        {
+            // si no existe, se crea con umbral por defecto
+            inventario[nombre] = { nombre, cantidad, max(1, cantidad / 4) };
+        }
+        else
+        {
+            it->second.cantidad += cantidad;
+        }
+        consola() << "[INFO] Nuevo stock de '" << nombre
+            << "': " << inventario[nombre].cantidad << "\n";
+    }
+
+    // Copia del inventario (ordenada por nombre), usada por el snapshot
+    vector<StockMedicamento> listar() const
+    {
+        vector<StockMedicamento> resultado;
+        for (const auto& kv : inventario)
+            resultado.push_back(kv.second);
+        return resultado;
+    }
+
+    void limpiar()
+    {
+        inventario.clear();
+    }
+
+    void reporte() const
+    {
+        consola() << "=== INVENTARIO DE MEDICAMENTOS CRITICOS ===\n";
+        for (const auto& kv : inventario)
+        {
+            const auto& m = kv.second;
+            consola() << " - " << m.nombre
+                << " | Cant: " << m.cantidad
+                << " | Umbral min: " << m.umbralMinimo << "\n";
+        }
+        consola() << "===========================================\n";
+    }
+};
+
+// Gestor de recursos hospitalarios (UCI, ventiladores, meds)
+class GestorRecursosHospitalarios
+{
+private:
+    int totalCamasUCI;
+    int camasOcupadas;
     int totalVentiladores;
     int ventiladoresOcupados;
 
-    long long contadorLlegada;
-    SkewHeapCritico colaEspera;
-    InventarioMedicamentos inventario;
+    long long contadorLlegada;
+    SkewHeapCritico colaEspera;
+    InventarioMedicamentos inventario;
+
+public:
+    GestorRecursosHospitalarios(int camasUCI, int ventiladores)
+        : totalCamasUCI(camasUCI),
+        camasOcupadas(0),
+        totalVentiladores(ventiladores),
+        ventiladoresOcupados(0),
+        contadorLlegada(0) {}
+
+    InventarioMedicamentos& obtenerInventario()
+    {
+        return inventario;
+    }
+
+    // Ocupacion y cola de espera, usadas por el snapshot
+    void exportarEstado(int& camas, int& ventiladores, long long& llegadas, vector<PacienteCritico>& pendientes) const
+    {
+        camas = camasOcupadas;
+        ventiladores = ventiladoresOcupados;
+        llegadas = contadorLlegada;
+        pendientes = colaEspera.contenido();
+    }
+
+    void restaurarEstado(int camas, int ventiladores, long long llegadas, const vector<PacienteCritico>& pendientes)
+    {
+        camasOcupadas = camas;
+        ventiladoresOcupados = ventiladores;
+        contadorLlegada = llegadas;
+        colaEspera.vaciar();
+        for (const PacienteCritico& p : pendientes)
+            colaEspera.insertar(p);
+    }
+
+    // Registro interactivo de paciente crítico
+    void registrarPacienteCriticoInteractivo()
+    {
+        string dni;
+        consola() << "\n[RECURSOS] Ingrese DNI del paciente critico: ";
+        cin >> dni;
+
+        int idPaciente = -1;
+        string nombre;
+
+        if (const Paciente* p = tablaPacientes.buscar(dni))
+        {
+            idPaciente = p->idPaciente;
+            nombre = p->nombreCompleto;
+            consola() << "  > Paciente encontrado en tabla: " << nombre << " (ID " << idPaciente << ")\n";
+        }
+        else
+        {
+            consola() << "  > Paciente no registrado en tabla. Ingrese nombre completo: ";
+            cin.ignore();
+            getline(cin, nombre);
+        }
+
+        int nivelESI;
+        char cUCI, cVent, cMed;
+        consola() << "  > Nivel de urgencia ESI (1-5): ";
+        cin >> nivelESI;
+        consola() << "  > ¿Necesita cama UCI? (s/n): ";
+        cin >> cUCI;
+        consola() << "  > ¿Necesita ventilador? (s/n): ";
+        cin >> cVent;
+        consola() << "  > ¿Requiere medicacion critica inmediata? (s/n): ";
+        cin >> cMed;
+
+        registrarPacienteCritico(idPaciente, dni, nombre, nivelESI,
+                                 cUCI == 's' || cUCI == 'S',
+                                 cVent == 's' || cVent == 'S',
+                                 cMed == 's' || cMed == 'S');
+    }
+
+    // Registro no interactivo (usado por el menu y por el modo replay)
+    void registrarPacienteCritico(int idPaciente, const string& dni, const string& nombre, int nivelESI,
+                                  bool necesitaUCI, bool necesitaVentilador, bool necesitaMedCritica)
+    {
+        UrgenciaESI urg;
+        if (nivelESI <= 1)
+            urg = UrgenciaESI::ESI1;
+        else if (nivelESI == 2)
+            urg = UrgenciaESI::ESI2;
+        else if (nivelESI == 3)
+            urg = UrgenciaESI::ESI3;
+        else if (nivelESI == 4)
+            urg = UrgenciaESI::ESI4;
+        else
+            urg = UrgenciaESI::ESI5;
+
+        PacienteCritico p;
+        p.idPaciente = idPaciente;
+        p.dni = dni;
+        p.nombre = nombre;
+        p.urgencia = urg;
+        p.necesitaUCI = necesitaUCI;
+        p.necesitaVentilador = necesitaVentilador;
+        p.necesitaMedCritica = necesitaMedCritica;
+        p.ordenLlegada = contadorLlegada++;
+
+        colaEspera.insertar(p);
+        registrarMutacion(Mutacion(MUT_PACIENTE_CRITICO)
+                              .entero(idPaciente)
+                              .texto(dni)
+                              .texto(nombre)
+                              .entero(nivelESI)
+                              .entero((necesitaUCI ? 1 : 0) | (necesitaVentilador ? 2 : 0) | (necesitaMedCritica ? 4 : 0)));
+
+        consola() << "[INFO] Paciente critico " << p.nombre
+            << " agregado a la cola de asignacion de recursos.\n";
+    }
+
+    // Asignación Greedy: siempre al paciente más urgente mientras haya recursos
+    void asignarRecursosGreedy()
+    {
+        if (colaEspera.estaVacio())
+        {
+            consola() << "\n[RECURSOS] No hay pacientes criticos en espera.\n";
+            return;
+        }
+
+        consola() << "\n[RECURSOS] Ejecutando asignacion de recursos (Greedy + Skew Heap)...\n";
+        registrarMutacion(Mutacion(MUT_ASIGNAR_RECURSOS));
+
+        while (!colaEspera.estaVacio())
+        {
+            PacienteCritico top = colaEspera.obtenerMaxPrioridad();
+
+            bool puedeUCI = (!top.necesitaUCI) || (camasOcupadas < totalCamasUCI);
+            bool puedeVent = (!top.necesitaVentilador) || (ventiladoresOcupados < totalVentiladores);
+
+            if (!puedeUCI || !puedeVent)
+            {
+                consola() << "[INFO] Recursos insuficientes para asignar al siguiente paciente de mayor prioridad.\n";
+                break;
+            }
+
+            consola() << "[ASIGNACION] Paciente " << top.nombre << " (DNI: " << top.dni << ")\n";
+            consola() << "    - Urgencia ESI: " << static_cast<int>(top.urgencia) << "\n";
+
+            if (top.necesitaUCI)
+            {
+                camasOcupadas++;
+                consola() << "    - Cama UCI asignada. (" << camasOcupadas
+                    << "/" << totalCamasUCI << " ocupadas)\n";
+            }
+
+            if (top.necesitaVentilador)
+            {
+                ventiladoresOcupados++;
+                consola() << "    - Ventilador asignado. (" << ventiladoresOcupados
+                    << "/" << totalVentiladores << " ocupados)\n";
+            }
+
+            if (top.necesitaMedCritica)
+            {
+                string med = "MedicamentoCriticoA";
+                bool ok = inventario.consumir(med, 1);
+                if (!ok)
+                {
+                    consola() << "    [ALERTA] No se pudo dispensar medicacion critica para este paciente.\n";
+                }
+            }
+
+            consola() << "---------------------------------------------\n";
+
+            colaEspera.eliminarMaxPrioridad();
+        }
+    }
+
+
+    // Liberar recursos cuando pacientes salen de UCI/ventilador
+    void darAltaPacientesInteractivo()
+    {
+        int liberarCamas, liberarVent;
+        consola() << "\n[ALTA PACIENTES] ¿Cuantas camas UCI se liberan?: ";
+        cin >> liberarCamas;
+        consola() << "[ALTA PACIENTES] ¿Cuantos ventiladores se liberan?: ";
+        cin >> liberarVent;
+        darAltaPacientes(liberarCamas, liberarVent);
+    }
+
+    void darAltaPacientes(int liberarCamas, int liberarVent)
+    {
+        registrarMutacion(Mutacion(MUT_ALTA_PACIENTES).entero(liberarCamas).entero(liberarVent));
+        camasOcupadas -= liberarCamas;
+        ventiladoresOcupados -= liberarVent;
+
+        if (camasOcupadas < 0)
+            camasOcupadas = 0;
+        if (ventiladoresOcupados < 0)
+            ventiladoresOcupados = 0;
+
+        consola() << "[INFO] Recursos actualizados tras las altas.\n";
+    }
+
+    void reporteRecursos() const
+    {
+        consola() << "\n========== ESTADO DE RECURSOS HOSPITALARIOS ==========\n";
+        consola() << "Camas UCI: " << camasOcupadas << " / " << totalCamasUCI << "\n";
+        consola() << "Ventiladores: " << ventiladoresOcupados << " / " << totalVentiladores << "\n";
+        consola() << "======================================================\n";
+        inventario.reporte();
+    }
+
+    void reabastecerMedicamentoInteractivo()
+    {
+        string nombre;
+        int cantidad;
+        consola() << "\n[REABASTECER] Nombre del medicamento critico: ";
+        cin >> nombre;
+        consola() << "  > Cantidad a agregar: ";
+        cin >> cantidad;
+        reabastecerMedicamento(nombre, cantidad);
+    }
+
+    // Movimientos de inventario solicitados desde fuera del gestor (quedan en el journal).
+    // El consumo interno de asignarRecursosGreedy no se registra: lo reproduce esa misma operacion.
+    bool consumirMedicamento(const string& nombre, int cantidad)
+    {
+        if (!inventario.consumir(nombre, cantidad))
+            return false;
+        registrarMutacion(Mutacion(MUT_CONSUMIR_MEDICAMENTO).texto(nombre).entero(cantidad));
+        return true;
+    }
+
+    void reabastecerMedicamento(const string& nombre, int cantidad)
+    {
+        inventario.reabastecer(nombre, cantidad);
+        registrarMutacion(Mutacion(MUT_REABASTECER_MEDICAMENTO).texto(nombre).entero(cantidad));
+    }
+};
+
+// Gestor global de recursos (ejemplo: 10 camas UCI y 6 ventiladores)
+GestorRecursosHospitalarios gestorRecursos(10, 6);
+
+// Configuracion inicial de inventario de medicamentos criticos
+void configurarInventarioInicial()
+{
+    InventarioMedicamentos& inv = gestorRecursos.obtenerInventario();
+    inv.agregarTipoMedicamento("MedicamentoCriticoA", 5, 2);
+    inv.agregarTipoMedicamento("MedicamentoCriticoB", 10, 3);
+}
+
+// --- 6B. SNAPSHOT BINARIO MAPEABLE EN MEMORIA ---
+
+/*
+ * Formato del snapshot (little-endian, version 2):
+ *   CabeceraSnapshot              (con el crc32 de todo lo que la sigue)
+ *   EntradaSeccion[numSecciones]  (tipo, tamaño de registro, offset, cantidad)
+ *   secciones alineadas a 8 bytes, cada una un arreglo de registros de tamaño fijo
+ * Los strings viven en una unica seccion de texto y los registros los
+ * referencian por (offset, longitud) de 32 bits, de modo que el archivo se
+ * puede mapear con mmap y leer cada registro directamente, sin parsear texto.
+ * El texto (ya sin repetidos) no puede pasar de 4 GiB: guardarSnapshot falla
+ * antes que escribir referencias truncadas.
+ * Al cargar, los registros se copian del mapeo a las estructuras en memoria
+ * (tabla de pacientes, agenda, grafo...) y los indices se reconstruyen: el
+ * arranque es O(n) en copias, sin conversiones de texto a numero ni CSV, pero
+ * no es un arranque sin trabajo por registro.
+ */
+const char MAGIA_SNAPSHOT[8] = { 'H', 'O', 'S', 'P', 'S', 'N', 'A', 'P' };
+const uint32_t VERSION_SNAPSHOT = 2;
+const uint32_t MARCA_ORDEN_BYTES = 0x01020304;
+
+enum TipoSeccionSnapshot : uint32_t
+{
+    SECCION_TEXTO = 1,
+    SECCION_META = 2,
+    SECCION_PACIENTES = 3,
+    SECCION_MEDICOS = 4,
+    SECCION_CITAS = 5,
+    SECCION_ESPERA = 6,
+    SECCION_ARISTAS = 7,
+    SECCION_AMBULANCIAS = 8,
+    SECCION_INVENTARIO = 9,
+    SECCION_RECURSOS = 10,
+    SECCION_CRITICOS = 11,
+    SECCION_JOURNAL = 12
+};
+
+struct CabeceraSnapshot
+{
+    char magia[8];
+    uint32_t version;
+    uint32_t marcaOrdenBytes;
+    uint32_t numSecciones;
+    uint32_t crcDatos; // crc32 de la tabla de secciones y las secciones (hasta bytesTotales)
+    uint64_t bytesTotales;
+};
+
+struct EntradaSeccion
+{
+    uint32_t tipo;
+    uint32_t tamanoRegistro;
+    uint64_t offset;
+    uint64_t cantidad;
+};
+
+struct RefTexto
+{
+    uint32_t offset;
+    uint32_t longitud;
+};
+
+struct MetaSnapshot
+{
+    int32_t numNodosAmbulancia;
+    int32_t siguienteIdCita;
+    uint32_t contadorIngestaCitas;
+    uint32_t reservado;
+};
+
+struct RegistroPaciente
+{
+    int32_t idPaciente;
+    RefTexto dni;
+    RefTexto nombre;
+};
+
+struct RegistroMedico
+{
+    int32_t idMedico;
+    RefTexto nombre;
+    RefTexto especialidad;
+    uint32_t disponible;
+};
+
+struct RegistroCita
+{
+    uint64_t claveOrden;
+    int32_t idCita;
+    int32_t idPaciente;
+    int32_t idMedico;
+    int32_t prioridad;
+    RefTexto dni;
+    RefTexto medico;
+    RefTexto fecha;
+    RefTexto hora;
+    RefTexto especialidad;
+    uint32_t cancelada;
+    uint32_t reservado;
+};
+
+struct RegistroArista
+{
+    int32_t u;
+    int32_t v;
+    int32_t peso;
+};
+
+struct RegistroAmbulancia
+{
+    int32_t idAmbulancia;
+    int32_t nodoActual;
+    uint32_t disponible;
+};
+
+struct RegistroStock
+{
+    RefTexto nombre;
+    int32_t cantidad;
+    int32_t umbralMinimo;
+};
+
+struct RegistroRecursos
+{
+    int32_t camasOcupadas;
+    int32_t ventiladoresOcupados;
+    int64_t contadorLlegada;
+};
+
+struct RegistroCritico
+{
+    int64_t ordenLlegada;
+    int32_t idPaciente;
+    int32_t urgencia;
+    RefTexto dni;
+    RefTexto nombre;
+    uint32_t necesidades; // bit 0: UCI, bit 1: ventilador, bit 2: medicacion critica
+    uint32_t reservado;
+};
+
+// Ultimo lsn del journal cuyo efecto ya esta incluido en el snapshot
+struct RegistroJournal
+{
+    uint64_t lsn;
+};
+
+// Lsn incluido en el ultimo snapshot cargado (0 si se partio de los datos de ejemplo)
+uint64_t lsnBaseSnapshot = 0;
+
+// Acumula strings sin repetir (nombres de medicos, fechas y especialidades se repiten mucho)
+class ConstructorTexto
+{
+private:
+    string datos;
+    unordered_map<string, RefTexto> vistos;
+    bool desbordado = false;
+
+public:
+    RefTexto agregar(const string& s)
+    {
+        auto it = vistos.find(s);
+        if (it != vistos.end())
+            return it->second;
+        if (datos.size() + s.size() > numeric_limits<uint32_t>::max())
+        {
+            desbordado = true; // el offset no cabria en RefTexto
+            return RefTexto();
+        }
+        RefTexto ref = { static_cast<uint32_t>(datos.size()), static_cast<uint32_t>(s.size()) };
+        datos += s;
+        vistos.emplace(s, ref);
+        return ref;
+    }
+
+    const string& contenido() const
+    {
+        return datos;
+    }
+
+    bool excedido() const
+    {
+        return desbordado;
+    }
+};
+
+static RegistroCita registroDeCita(const Cita& c, ConstructorTexto& texto)
+{
+    RegistroCita r = {};
+    r.claveOrden = c.claveOrden;
+    r.idCita = c.idCita;
+    r.idPaciente = c.idPaciente;
+    r.idMedico = c.idMedico;
+    r.prioridad = c.prioridad;
+    r.dni = texto.agregar(c.dniPaciente);
+    r.medico = texto.agregar(c.nombreMedico);
+    r.fecha = texto.agregar(c.fecha);
+    r.hora = texto.agregar(c.hora);
+    r.especialidad = texto.agregar(c.especialidad);
+    r.cancelada = c.cancelada ? 1 : 0;
+    return r;
+}
+
+/**
+ * Escribe el estado completo en 'ruta'. Se escribe a un archivo temporal y
+ * luego se renombra, para que un corte a mitad no deje un snapshot corrupto.
+ */
+bool guardarSnapshot(const string& ruta)
+{
+    auto inicio = chrono::steady_clock::now();
+    ConstructorTexto texto;
+
+    MetaSnapshot meta = { numNodosAmbulancia, siguienteIdCita, contadorIngestaCitas, 0 };
+
+    vector<RegistroPaciente> pacientes;
+    pacientes.reserve(tablaPacientes.size());
+    for (const Paciente& p : tablaPacientes)
+        pacientes.push_back({ p.idPaciente, texto.agregar(p.dni), texto.agregar(p.nombreCompleto) });
+
+    vector<RegistroMedico> medicos;
+    medicos.reserve(tablaMedicos.size());
+    for (const auto& kv : tablaMedicos)
+        medicos.push_back({ kv.second.idMedico, texto.agregar(kv.second.nombreCompleto),
+                            texto.agregar(kv.second.especialidad), kv.second.disponible ? 1u : 0u });
+
+    vector<RegistroCita> citas;
+    citas.reserve(citasProgramadas.size());
+    for (const Cita& c : citasProgramadas)
+        citas.push_back(registroDeCita(c, texto));
+
+    vector<RegistroCita> espera;
+    for (const Cita& c : listaEspera.aVector())
+        espera.push_back(registroDeCita(c, texto));
+
+    vector<RegistroArista> aristas;
+    aristas.reserve(grafoVial.numArcos());
+    for (const auto& e : grafoVial.arcos())
+        aristas.push_back({ e.u, e.v, e.peso });
+
+    vector<RegistroAmbulancia> flota;
+    for (const auto& a : ambulancias)
+        flota.push_back({ a.idAmbulancia, a.nodoActual, a.disponible ? 1u : 0u });
+
+    vector<RegistroStock> stock;
+    for (const auto& m : gestorRecursos.obtenerInventario().listar())
+        stock.push_back({ texto.agregar(m.nombre), m.cantidad, m.umbralMinimo });
+
+    RegistroRecursos recursos = {};
+    long long llegadas;
+    vector<PacienteCritico> pendientes;
+    int camas, ventiladores;
+    gestorRecursos.exportarEstado(camas, ventiladores, llegadas, pendientes);
+    recursos.camasOcupadas = camas;
+    recursos.ventiladoresOcupados = ventiladores;
+    recursos.contadorLlegada = llegadas;
+
+    vector<RegistroCritico> criticos;
+    for (const PacienteCritico& pc : pendientes)
+    {
+        RegistroCritico r = {};
+        r.ordenLlegada = pc.ordenLlegada;
+        r.idPaciente = pc.idPaciente;
+        r.urgencia = static_cast<int32_t>(pc.urgencia);
+        r.dni = texto.agregar(pc.dni);
+        r.nombre = texto.agregar(pc.nombre);
+        r.necesidades = (pc.necesitaUCI ? 1u : 0u) | (pc.necesitaVentilador ? 2u : 0u) | (pc.necesitaMedCritica ? 4u : 0u);
+        criticos.push_back(r);
+    }
+
+    if (texto.excedido())
+    {
+        consola() << "[ERROR] El texto del snapshot supera 4 GiB (offsets de 32 bits); no se guardo " << ruta
+                  << "." << endl;
+        return false;
+    }
+
+    // Todo lo registrado hasta aqui queda dentro del snapshot
+    RegistroJournal journal = { journalMutaciones.ultimoLsn() };
+
+    struct SeccionPendiente
+    {
+        uint32_t tipo;
+        uint32_t tamanoRegistro;
+        const void* datos;
+        uint64_t cantidad;
+    };
+    const string& blob = texto.contenido();
+    vector<SeccionPendiente> secciones = {
+        { SECCION_TEXTO, 1, blob.data(), blob.size() },
+        { SECCION_META, sizeof(MetaSnapshot), &meta, 1 },
+        { SECCION_PACIENTES, sizeof(RegistroPaciente), pacientes.data(), pacientes.size() },
+        { SECCION_MEDICOS, sizeof(RegistroMedico), medicos.data(), medicos.size() },
+        { SECCION_CITAS, sizeof(RegistroCita), citas.data(), citas.size() },
+        { SECCION_ESPERA, sizeof(RegistroCita), espera.data(), espera.size() },
+        { SECCION_ARISTAS, sizeof(RegistroArista), aristas.data(), aristas.size() },
+        { SECCION_AMBULANCIAS, sizeof(RegistroAmbulancia), flota.data(), flota.size() },
+        { SECCION_INVENTARIO, sizeof(RegistroStock), stock.data(), stock.size() },
+        { SECCION_RECURSOS, sizeof(RegistroRecursos), &recursos, 1 },
+        { SECCION_CRITICOS, sizeof(RegistroCritico), criticos.data(), criticos.size() },
+        { SECCION_JOURNAL, sizeof(RegistroJournal), &journal, 1 }
+    };
+
+    auto alinear8 = [](uint64_t x) { return (x + 7) & ~7ULL; };
+    CabeceraSnapshot cab = {};
+    memcpy(cab.magia, MAGIA_SNAPSHOT, sizeof(cab.magia));
+    cab.version = VERSION_SNAPSHOT;
+    cab.marcaOrdenBytes = MARCA_ORDEN_BYTES;
+    cab.numSecciones = static_cast<uint32_t>(secciones.size());
+
+    vector<EntradaSeccion> tabla;
+    uint64_t offset = alinear8(sizeof(CabeceraSnapshot) + secciones.size() * sizeof(EntradaSeccion));
+    for (const auto& s : secciones)
+    {
+        tabla.push_back({ s.tipo, s.tamanoRegistro, offset, s.cantidad });
+        offset = alinear8(offset + s.cantidad * s.tamanoRegistro);
+    }
+    cab.bytesTotales = offset;
+
+    string rutaTemporal = ruta + ".tmp";
+    ofstream out(rutaTemporal, ios::binary | ios::trunc);
+    if (!out)
+    {
+        consola() << "[ERROR] No se pudo crear el snapshot: " << rutaTemporal << endl;
+        return false;
+    }
+    // El crc se acumula al escribir y la cabecera se reescribe al final con su valor
+    const char ceros[8] = {};
+    auto escribir = [&out, &cab](const void* datos, uint64_t bytes)
+    {
+        out.write(static_cast<const char*>(datos), static_cast<streamsize>(bytes));
+        cab.crcDatos = crc32(static_cast<const char*>(datos), bytes, cab.crcDatos);
+    };
+    out.write(reinterpret_cast<const char*>(&cab), sizeof(cab));
+    escribir(tabla.data(), tabla.size() * sizeof(EntradaSeccion));
+    uint64_t escrito = sizeof(cab) + tabla.size() * sizeof(EntradaSeccion);
+    for (size_t i = 0; i < secciones.size(); ++i)
+    {
+        escribir(ceros, tabla[i].offset - escrito);
+        uint64_t bytes = secciones[i].cantidad * secciones[i].tamanoRegistro;
+        escribir(secciones[i].datos, bytes);
+        escrito = tabla[i].offset + bytes;
+    }
+    escribir(ceros, cab.bytesTotales - escrito);
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&cab), sizeof(cab));
+    out.close();
+    // El snapshot y la entrada del directorio deben ser durables antes de recortar el journal
+    if (!out || !sincronizarRuta(rutaTemporal) || rename(rutaTemporal.c_str(), ruta.c_str()) != 0 ||
+        !sincronizarRuta(directorioDe(ruta)))
+    {
+        consola() << "[ERROR] No se pudo escribir el snapshot en " << ruta << endl;
+        return false;
+    }
+    // Checkpoint: una caida antes de recortar solo deja registros con lsn <= journal.lsn,
+    // que la reproduccion descarta
+    journalMutaciones.truncarHasta(journal.lsn);
+
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - inicio).count();
+    consola() << "[SNAPSHOT] Guardado en " << ruta << " (" << cab.bytesTotales << " bytes, " << citas.size()
+              << " citas) en " << fixed << setprecision(2) << ms << " ms." << endl;
+    consola().unsetf(ios::floatfield);
+    return true;
+}
+
+/**
+ * Vista de solo lectura sobre un snapshot mapeado en memoria. Al abrir se
+ * valida la cabecera, el crc de todo el archivo (una pasada) y la tabla de
+ * secciones; los registros se leen directamente del mapeo.
+ */
+class SnapshotMapeado
+{
+private:
+    const char* base = nullptr;
+    size_t tamano = 0;
+#ifdef _WIN32
+    vector<char> copia; // sin mmap: se lee el archivo completo una vez
+#endif
+    const EntradaSeccion* tabla = nullptr;
+    uint32_t numSecciones = 0;
+    const char* texto = nullptr;
+    uint64_t bytesTexto = 0;
+
+    void cerrar()
+    {
+#ifndef _WIN32
+        if (base)
+            munmap(const_cast<char*>(base), tamano);
+#endif
+        base = nullptr;
+        tamano = 0;
+    }
+
+public:
+    string error;
+
+    SnapshotMapeado() {}
+    SnapshotMapeado(const SnapshotMapeado&) = delete;
+    SnapshotMapeado& operator=(const SnapshotMapeado&) = delete;
+
+    ~SnapshotMapeado()
+    {
+        cerrar();
+    }
+
+    bool abrir(const string& ruta)
+    {
+#ifdef _WIN32
+        ifstream in(ruta, ios::binary);
+        if (!in)
+        {
+            error = "no se pudo abrir el archivo";
+            return false;
+        }
+        copia.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+        base = copia.data();
+        tamano = copia.size();
+#else
+        int fd = open(ruta.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            error = "no se pudo abrir el archivo";
+            return false;
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(CabeceraSnapshot)))
+        {
+            close(fd);
+            error = "archivo demasiado pequeño";
+            return false;
+        }
+        void* p = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (p == MAP_FAILED)
+        {
+            error = "mmap fallo";
+            return false;
+        }
+        base = static_cast<const char*>(p);
+        tamano = static_cast<size_t>(info.st_size);
+#endif
+        if (tamano < sizeof(CabeceraSnapshot))
+        {
+            error = "archivo demasiado pequeño";
+            return false;
+        }
+        const CabeceraSnapshot* cab = reinterpret_cast<const CabeceraSnapshot*>(base);
+        if (memcmp(cab->magia, MAGIA_SNAPSHOT, sizeof(cab->magia)) != 0)
+            error = "no es un snapshot del sistema";
+        else if (cab->marcaOrdenBytes != MARCA_ORDEN_BYTES)
+            error = "orden de bytes incompatible";
+        else if (cab->version != VERSION_SNAPSHOT)
+            error = "version " + to_string(cab->version) + " no soportada";
+        else if (cab->bytesTotales != tamano ||
+                 sizeof(CabeceraSnapshot) + static_cast<uint64_t>(cab->numSecciones) * sizeof(EntradaSeccion) > tamano)
+            error = "archivo truncado";
+        else if (crc32(base + sizeof(CabeceraSnapshot), tamano - sizeof(CabeceraSnapshot)) != cab->crcDatos)
+            error = "crc incorrecto (archivo dañado)";
+        if (!error.empty())
+        {
+            cerrar();
+            return false;
+        }
+        numSecciones = cab->numSecciones;
+        tabla = reinterpret_cast<const EntradaSeccion*>(base + sizeof(CabeceraSnapshot));
+        for (uint32_t i = 0; i < numSecciones; ++i)
+        {
+            const EntradaSeccion& e = tabla[i];
+            if (e.tamanoRegistro == 0 || e.offset % 8 != 0 || e.offset > tamano ||
+                e.cantidad > (tamano - e.offset) / e.tamanoRegistro)
+            {
+                error = "seccion " + to_string(e.tipo) + " fuera de rango";
+                cerrar();
+                return false;
+            }
+        }
+        size_t n;
+        texto = seccion<char>(SECCION_TEXTO, n);
+        bytesTexto = n;
+        return true;
+    }
+
+    // Arreglo de registros de la seccion (nullptr si no existe o el tamaño no coincide)
+    template <typename T>
+    const T* seccion(uint32_t tipo, size_t& cantidad) const
+    {
+        cantidad = 0;
+        for (uint32_t i = 0; i < numSecciones; ++i)
+        {
+            if (tabla[i].tipo == tipo && tabla[i].tamanoRegistro == sizeof(T))
+            {
+                cantidad = static_cast<size_t>(tabla[i].cantidad);
+                return reinterpret_cast<const T*>(base + tabla[i].offset);
+            }
+        }
+        return nullptr;
+    }
+
+    string_view leerTexto(RefTexto ref) const
+    {
+        if (!texto || static_cast<uint64_t>(ref.offset) + ref.longitud > bytesTexto)
+            return string_view();
+        return string_view(texto + ref.offset, ref.longitud);
+    }
+};
+
+static Cita citaDeRegistro(const RegistroCita& r, const SnapshotMapeado& snap)
+{
+    Cita c;
+    c.idCita = r.idCita;
+    c.idPaciente = r.idPaciente;
+    c.idMedico = r.idMedico;
+    c.dniPaciente = string(snap.leerTexto(r.dni));
+    c.nombreMedico = string(snap.leerTexto(r.medico));
+    c.fecha = string(snap.leerTexto(r.fecha));
+    c.hora = string(snap.leerTexto(r.hora));
+    c.especialidad = string(snap.leerTexto(r.especialidad));
+    c.prioridad = r.prioridad;
+    c.cancelada = r.cancelada != 0;
+    c.claveOrden = r.claveOrden;
+    return c;
+}
+
+/**
+ * Restaura el estado completo desde un snapshot. Reemplaza a cargarDatos(),
+ * cargarGrafoAmbulancia() y al inventario inicial. Copia cada registro del
+ * mapeo a su contenedor y reconstruye los indices (ver el formato arriba).
+ */
+bool cargarSnapshot(const string& ruta)
+{
+    auto inicio = chrono::steady_clock::now();
+    SnapshotMapeado snap;
+    if (!snap.abrir(ruta))
+    {
+        consola() << "[ERROR] Snapshot " << ruta << " invalido: " << snap.error << "." << endl;
+        return false;
+    }
+
+    size_t n;
+    const MetaSnapshot* meta = snap.seccion<MetaSnapshot>(SECCION_META, n);
+    if (!meta || n != 1)
+    {
+        consola() << "[ERROR] Snapshot " << ruta << " sin metadatos." << endl;
+        return false;
+    }
+
+    // El mapa vial se valida antes de tocar el estado, con los mismos limites que cargarGrafoDesdeArchivo
+    size_t numAristas, numFlota;
+    const RegistroArista* aristas = snap.seccion<RegistroArista>(SECCION_ARISTAS, numAristas);
+    const RegistroAmbulancia* flota = snap.seccion<RegistroAmbulancia>(SECCION_AMBULANCIAS, numFlota);
+    const int nodos = meta->numNodosAmbulancia;
+    bool mapaValido = nodos > 0;
+    for (size_t i = 0; i < numAristas && mapaValido; ++i)
+        mapaValido = aristas[i].u >= 0 && aristas[i].u < nodos && aristas[i].v >= 0 && aristas[i].v < nodos;
+    for (size_t i = 0; i < numFlota && mapaValido; ++i)
+        mapaValido = flota[i].nodoActual >= 0 && flota[i].nodoActual < nodos;
+    if (!mapaValido)
+    {
+        consola() << "[ERROR] Snapshot " << ruta << " invalido: mapa vial con nodos fuera de rango." << endl;
+        return false;
+    }
+
+    tablaPacientes.limpiar();
+    const RegistroPaciente* pacientes = snap.seccion<RegistroPaciente>(SECCION_PACIENTES, n);
+    tablaPacientes.reservar(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        string dni(snap.leerTexto(pacientes[i].dni));
+        tablaPacientes.asignar({ pacientes[i].idPaciente, dni, string(snap.leerTexto(pacientes[i].nombre)) });
+    }
+    indiceNombres.reconstruir(tablaPacientes);
+
+    tablaMedicos.clear();
+    const RegistroMedico* medicos = snap.seccion<RegistroMedico>(SECCION_MEDICOS, n);
+    tablaMedicos.reserve(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        string nombre(snap.leerTexto(medicos[i].nombre));
+        tablaMedicos[nombre] = { medicos[i].idMedico, nombre, string(snap.leerTexto(medicos[i].especialidad)),
+                                 medicos[i].disponible != 0 };
+    }
+
+    const RegistroCita* citas = snap.seccion<RegistroCita>(SECCION_CITAS, n);
+    citasProgramadas.clear();
+    citasProgramadas.reserve(n);
+    for (size_t i = 0; i < n; ++i)
+        citasProgramadas.push_back(citaDeRegistro(citas[i], snap));
+
+    contadorIngestaCitas = meta->contadorIngestaCitas;
+    siguienteIdCita = meta->siguienteIdCita;
+    listaEspera.limpiar();
+    const RegistroCita* espera = snap.seccion<RegistroCita>(SECCION_ESPERA, n);
+    for (size_t i = 0; i < n; ++i)
+        listaEspera.agregar(citaDeRegistro(espera[i], snap));
+
+    numNodosAmbulancia = nodos;
+    vector<AristaAmbulancia> arcos;
+    arcos.reserve(numAristas);
+    for (size_t i = 0; i < numAristas; ++i)
+        arcos.push_back({ aristas[i].u, aristas[i].v, aristas[i].peso });
+    grafoVial.construir(numNodosAmbulancia, std::move(arcos));
+
+    ambulancias.clear();
+    for (size_t i = 0; i < numFlota; ++i)
+        ambulancias.push_back({ flota[i].idAmbulancia, flota[i].nodoActual, flota[i].disponible != 0 });
+
+    InventarioMedicamentos& inv = gestorRecursos.obtenerInventario();
+    inv.limpiar();
+    const RegistroStock* stock = snap.seccion<RegistroStock>(SECCION_INVENTARIO, n);
+    for (size_t i = 0; i < n; ++i)
+        inv.agregarTipoMedicamento(string(snap.leerTexto(stock[i].nombre)), stock[i].cantidad, stock[i].umbralMinimo);
+
+    // Secciones opcionales: los snapshots anteriores no las tienen y se parte de cero
+    const RegistroRecursos* recursos = snap.seccion<RegistroRecursos>(SECCION_RECURSOS, n);
+    vector<PacienteCritico> pendientes;
+    const RegistroCritico* criticos = snap.seccion<RegistroCritico>(SECCION_CRITICOS, n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        PacienteCritico pc;
+        pc.idPaciente = criticos[i].idPaciente;
+        pc.dni = string(snap.leerTexto(criticos[i].dni));
+        pc.nombre = string(snap.leerTexto(criticos[i].nombre));
+        pc.urgencia = static_cast<UrgenciaESI>(criticos[i].urgencia);
+        pc.necesitaUCI = (criticos[i].necesidades & 1u) != 0;
+        pc.necesitaVentilador = (criticos[i].necesidades & 2u) != 0;
+        pc.necesitaMedCritica = (criticos[i].necesidades & 4u) != 0;
+        pc.ordenLlegada = criticos[i].ordenLlegada;
+        pendientes.push_back(pc);
+    }
+    if (recursos)
+        gestorRecursos.restaurarEstado(recursos->camasOcupadas, recursos->ventiladoresOcupados,
+                                       recursos->contadorLlegada, pendientes);
+    else
+        gestorRecursos.restaurarEstado(0, 0, 0, pendientes);
+
+    const RegistroJournal* journal = snap.seccion<RegistroJournal>(SECCION_JOURNAL, n);
+    lsnBaseSnapshot = (journal && n == 1) ? journal->lsn : 0;
+
+    indiceCitas.reconstruir(citasProgramadas);
+    reconstruirCalendarioMedicos();
+
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - inicio).count();
+    consola() << "\n[SNAPSHOT] Estado restaurado desde " << ruta << ": " << tablaPacientes.size() << " pacientes, "
+              << tablaMedicos.size() << " medicos, " << citasProgramadas.size() << " citas, " << listaEspera.size()
+              << " en espera (" << fixed << setprecision(2) << ms << " ms)." << endl;
+    consola().unsetf(ios::floatfield);
+    return true;
+}
+
+// Estado inicial: el snapshot si existe y es valido; si no, los CSV indicados o los datos de ejemplo
+void cargarEstadoInicial(const string& rutaSnapshot, const ConfigImportacion& importacion = ConfigImportacion())
+{
+    if (!rutaSnapshot.empty() && ifstream(rutaSnapshot) && cargarSnapshot(rutaSnapshot))
+        return;
+    lsnBaseSnapshot = 0;
+    if (importacion.vacia() || !importarDatosCSV(importacion))
+        cargarDatos();
+    if (importacion.rutaGrafo.empty() || !cargarGrafoDesdeArchivo(importacion.rutaGrafo))
+        cargarGrafoAmbulancia();
+    configurarInventarioInicial();
+}
+
+void guardarSnapshotInteractivo(const string& rutaPorDefecto)
+{
+    string ruta = rutaPorDefecto;
+    if (ruta.empty())
+    {
+        consola() << "\n[SNAPSHOT] Ruta del archivo: ";
+        cin >> ruta;
+    }
+    guardarSnapshot(ruta);
+}
+
+// Vuelve a ejecutar una mutacion del journal con las mismas funciones que la originaron
+static bool aplicarMutacion(TipoMutacion tipo, const string& payload)
+{
+    LectorMutacion r(payload);
+    switch (tipo)
+    {
+    case MUT_CANCELAR_CITA:
+    {
+        int id = r.entero();
+        return r.ok && cancelarCitaPorId(id);
+    }
+    case MUT_DISPONIBILIDAD:
+    {
+        string nombre = r.texto();
+        bool disponible = r.entero() != 0;
+        return r.ok && actualizarDisponibilidadMedico(nombre, disponible);
+    }
+    case MUT_ASIGNAR_RECURSOS:
+        gestorRecursos.asignarRecursosGreedy();
+        return true;
+    case MUT_ALTA_PACIENTES:
+    {
+        int camas = r.entero();
+        int ventiladores = r.entero();
+        if (r.ok)
+            gestorRecursos.darAltaPacientes(camas, ventiladores);
+        return r.ok;
+    }
+    case MUT_CONSUMIR_MEDICAMENTO:
+    {
+        string nombre = r.texto();
+        int cantidad = r.entero();
+        return r.ok && gestorRecursos.consumirMedicamento(nombre, cantidad);
+    }
+    case MUT_REABASTECER_MEDICAMENTO:
+    {
+        string nombre = r.texto();
+        int cantidad = r.entero();
+        if (r.ok)
+            gestorRecursos.reabastecerMedicamento(nombre, cantidad);
+        return r.ok;
+    }
+    case MUT_PACIENTE_CRITICO:
+    {
+        int idPaciente = r.entero();
+        string dni = r.texto();
+        string nombre = r.texto();
+        int esi = r.entero();
+        int necesidades = r.entero();
+        if (r.ok)
+            gestorRecursos.registrarPacienteCritico(idPaciente, dni, nombre, esi, (necesidades & 1) != 0,
+                                                    (necesidades & 2) != 0, (necesidades & 4) != 0);
+        return r.ok;
+    }
+    case MUT_AGENDAR_CITA:
+    {
+        string dni = r.texto();
+        int idMedico = r.entero();
+        string fecha = r.texto();
+        string hora = r.texto();
+        int prioridad = r.entero();
+        return r.ok && agendarCita(dni, idMedico, fecha, hora, prioridad);
+    }
+    case MUT_AGREGAR_ESPERA:
+    {
+        string dni = r.texto();
+        string especialidad = r.texto();
+        int prioridad = r.entero();
+        return r.ok && agregarAListaEspera(dni, especialidad, prioridad);
+    }
+    case MUT_RETIRAR_ESPERA:
+    {
+        string dni = r.texto();
+        return r.ok && retirarDeListaEspera(dni);
+    }
+    case MUT_CANCELAR_SIN_REASIGNAR:
+    {
+        int id = r.entero();
+        return r.ok && cancelarCitaPorId(id, false);
+    }
+    case MUT_LLENAR_HUECOS:
+    {
+        uint32_t desde = static_cast<uint32_t>(r.entero());
+        return r.ok && llenarHuecosEnLote(desde).asignados > 0;
+    }
+    case MUT_LLENAR_HUECOS_CITAS:
+    {
+        int n = r.entero();
+        vector<int> ids;
+        for (int i = 0; i < n && r.ok; ++i)
+            ids.push_back(r.entero());
+        return r.ok && llenarHuecosDeCitas(ids).asignados > 0;
+    }
+    case MUT_REGISTRAR_PACIENTE:
+    {
+        string dni = r.texto();
+        string nombre = r.texto();
+        return r.ok && registrarPaciente(dni, nombre);
+    }
+    case MUT_PESO_ARISTA:
+    {
+        int u = r.entero();
+        int v = r.entero();
+        int peso = r.entero();
+        return r.ok && actualizarPesoArista(u, v, peso);
+    }
+    }
+    return false;
+}
+
+/**
+ * Reaplica las mutaciones con lsn > lsnDesde (las anteriores ya estan en el
+ * snapshot). Devuelve el ultimo lsn conocido, desde el que continua el journal.
+ */
+uint64_t reproducirJournal(const string& ruta, uint64_t lsnDesde)
+{
+    auto inicio = chrono::steady_clock::now();
+    long long leidos = 0, aplicadas = 0, fallidas = 0;
+    bool recortado = false;
+
+    ostream descarte(nullptr); // las operaciones reaplicadas no se muestran
+    uint64_t ultimo;
+    {
+        DesvioSalida desvio(descarte);
+        journalMutaciones.suspendido = true;
+        ultimo = JournalMutaciones::leer(
+            ruta,
+            [&](uint64_t lsn, TipoMutacion tipo, const string& payload)
+            {
+                if (lsn <= lsnDesde)
+                    return;
+                if (aplicarMutacion(tipo, payload))
+                    aplicadas++;
+                else
+                    fallidas++;
+            },
+            leidos, recortado);
+        journalMutaciones.suspendido = false;
+    }
+
+    if (leidos > 0 || recortado)
+    {
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - inicio).count();
+        consola() << "[JOURNAL] " << aplicadas << " mutacion(es) reaplicadas desde " << ruta << " ("
+                  << leidos - aplicadas - fallidas << " ya incluidas en el snapshot, " << fallidas << " sin efecto) en "
+                  << fixed << setprecision(2) << ms << " ms." << endl;
+        consola().unsetf(ios::floatfield);
+        if (recortado)
+            consola() << "[JOURNAL] Se descarto un registro incompleto al final del archivo (escritura interrumpida)."
+                      << endl;
+    }
+    return max(ultimo, lsnDesde);
+}
+
+/*
+ * Valor numerico de la linea de comandos. Acepta enteros y, para los volumenes,
+ * notacion cientifica sin decimales ("1e6"). Devuelve false (sin excepciones)
+ * si el texto no es un numero completo o no cabe en T.
+ */
+template <typename T>
+bool leerNumeroArgumento(const char* texto, T& valor)
+{
+    const char* fin = texto + strlen(texto);
+    auto r = from_chars(texto, fin, valor);
+    if (r.ec == errc() && r.ptr == fin)
+        return true;
+    char* finDoble = nullptr;
+    double v = strtod(texto, &finDoble);
+    if (finDoble == texto || *finDoble != '\0' || !isfinite(v) || v != floor(v) ||
+        v < static_cast<double>(numeric_limits<T>::lowest()) || v > static_cast<double>(numeric_limits<T>::max()))
+        return false;
+    valor = static_cast<T>(v);
+    return true;
+}
+
+// Lee el valor de la opcion argv[i] (avanzando i); informa el error si no es numerico
+template <typename T>
+bool leerValorOpcion(int argc, char* argv[], int& i, T& valor)
+{
+    if (i + 1 < argc && leerNumeroArgumento(argv[i + 1], valor))
+    {
+        ++i;
+        return true;
+    }
+    cerr << "[ERROR] Valor numerico invalido para " << argv[i] << ": " << (i + 1 < argc ? argv[i + 1] : "(falta)")
+         << endl;
+    return false;
+}
+
+// Opciones de carga y persistencia comunes al menu, al modo replay y a la importacion
+struct OpcionesPersistencia
+{
+    string rutaSnapshot;
+    string rutaJournal;
+    ConfigJournal journal;
+    ConfigImportacion importacion;
+    bool invalida = false; // alguna opcion con un valor invalido (ya informado): el llamador termina con error
+};
+
+/**
+ * Reconoce argv[i] (y su valor, avanzando i) si es una opcion de carga o persistencia:
+ *   --snapshot <ruta>  --journal <ruta>  --durabilidad <ninguna|grupo|inmediata>
+ *   --commit-ms <ms>   --commit-lote <n>  --esperar-confirmacion
+ *   --pacientes <csv>  --medicos <csv>    --citas <csv>  --hilos <n>
+ *   --grafo <mapa vial>
+ */
+bool leerOpcionPersistencia(int argc, char* argv[], int& i, OpcionesPersistencia& op)
+{
+    string opt = argv[i];
+    if (opt == "--esperar-confirmacion")
+    {
+        op.journal.esperarConfirmacion = true;
+        return true;
+    }
+    // Valores numericos: se rechazan los no numericos ("8x", "5s") y los que estan fuera de [minimo, maximo]
+    auto leerEntero = [&](auto& campo, long long minimo, long long maximo)
+    {
+        long long v = 0;
+        if (!leerValorOpcion(argc, argv, i, v))
+        {
+            i += i + 1 < argc;
+            op.invalida = true;
+        }
+        else if (v < minimo || v > maximo)
+        {
+            cerr << "[ERROR] " << argv[i - 1] << " debe estar entre " << minimo << " y " << maximo << ": " << argv[i]
+                 << endl;
+            op.invalida = true;
+        }
+        else
+            campo = static_cast<remove_reference_t<decltype(campo)>>(v);
+        return true;
+    };
+    if (opt == "--hilos")
+        return leerEntero(op.importacion.hilos, 1, 1024);
+    if (opt == "--commit-ms")
+        return leerEntero(op.journal.intervaloMs, 1, 60000);
+    if (opt == "--commit-lote")
+        return leerEntero(op.journal.loteMaximo, 1, 1000000);
+    if (i + 1 >= argc)
+        return false;
+    string valor = argv[i + 1];
+    if (opt == "--snapshot")
+        op.rutaSnapshot = valor;
+    else if (opt == "--journal")
+        op.rutaJournal = valor;
+    else if (opt == "--pacientes")
+        op.importacion.rutaPacientes = valor;
+    else if (opt == "--medicos")
+        op.importacion.rutaMedicos = valor;
+    else if (opt == "--citas")
+        op.importacion.rutaCitas = valor;
+    else if (opt == "--grafo")
+        op.importacion.rutaGrafo = valor;
+    else if (opt == "--durabilidad" && valor == "ninguna")
+        op.journal.modo = ModoDurabilidad::Ninguna;
+    else if (opt == "--durabilidad" && valor == "grupo")
+        op.journal.modo = ModoDurabilidad::Grupo;
+    else if (opt == "--durabilidad" && valor == "inmediata")
+        op.journal.modo = ModoDurabilidad::Inmediata;
+    else if (opt == "--durabilidad")
+    {
+        cerr << "[ERROR] --durabilidad espera ninguna, grupo o inmediata: " << valor << endl;
+        op.invalida = true;
+    }
+    else
+        return false;
+    ++i;
+    return true;
+}
+
+// Carga el estado base, reaplica el journal y lo deja abierto para las nuevas mutaciones
+void iniciarPersistencia(const OpcionesPersistencia& op)
+{
+    cargarEstadoInicial(op.rutaSnapshot, op.importacion);
+    if (op.rutaJournal.empty())
+        return;
+    uint64_t ultimo = reproducirJournal(op.rutaJournal, lsnBaseSnapshot);
+    if (!journalMutaciones.abrir(op.rutaJournal, op.journal, ultimo))
+        consola() << "[ERROR] No se pudo abrir el journal " << op.rutaJournal << "; se continua sin el." << endl;
+}
+
+// --- 7. MODO REPLAY NO INTERACTIVO (PRUEBAS DE CARGA) ---
+
+/*
+ * Ejecuta un flujo de comandos (uno por linea) contra las mismas estructuras
+ * que usa el menu interactivo y mide la latencia de cada operacion.
+ *
+ * Formato de comandos ('#' inicia un comentario):
+ *   buscar <dni>
+ *   buscar_nombre <texto>
+ *   registrar_paciente <dni> <nombre completo>
+ *   cancelar <idCita>
+ *   cancelar_lote <idCita> [idCita ...]   (sin reasignar una por una; luego llenado en lote)
+ *   llenar_huecos [YYYY-MM-DD HH:MM]
+ *   disponibilidad <0|1> <nombre del medico>
+ *   disponibles <especialidad>
+ *   listar
+ *   espera <dni> <prioridad> <especialidad>
+ *   retirar_espera <dni>
+ *   citas_medico <idMedico>
+ *   citas_fecha <YYYY-MM-DD>
+ *   citas_paciente <dni>
+ *   agenda_rango <YYYY-MM-DD> <HH:MM> <YYYY-MM-DD> <HH:MM> [limite N] [tras idCita]
+ *                [medico idMedico | especialidad nombre]
+ *   agendar <dni> <idMedico> <YYYY-MM-DD> <HH:MM> <prioridad>
+ *   hueco_medico <idMedico> <YYYY-MM-DD> [HH:MM]
+ *   hueco_especialidad <YYYY-MM-DD> <HH:MM> <especialidad>
+ *   procesar <0|1|2>                     (0: Quick Sort, 1: Merge Sort, 2: Radix Sort)
+ *   emergencia <nodo>
+ *   asignar_ambulancia <idEmergencia>
+ *   asignar_emergencias
+ *   trafico <u> <v> <peso> [idEmergencia]
+ *   trafico_lote <u> <v> <peso> [<u> <v> <peso> ...]
+ *   resumen_emergencias
+ *   liberar_ambulancias                  (las ocupadas vuelven a servicio en el nodo atendido)
+ *   tabla_tiempos <0|1>                  (tabla de tiempos entre todos los nodos del mapa)
+ *   jerarquia <ruta>                     (carga la jerarquia de rutas, o la prepara y la guarda ahi)
+ *   critico <dni> <esi> <uci s/n> <vent s/n> <med s/n> [nombre]
+ *   asignar_recursos
+ *   alta <camas> <ventiladores>
+ *   consumir <medicamento> <cantidad>
+ *   reabastecer <medicamento> <cantidad>
+ *   reporte_recursos
+ *   snapshot <ruta>
+ */
+
+struct EstadisticaComando
+{
+    vector<double> latenciasUs; // latencia de cada ejecucion en microsegundos
+    long long fallos = 0;       // comandos con argumentos invalidos u operacion rechazada
+};
+
+static bool leerSiNo(const string& s)
+{
+    return !s.empty() && (s[0] == 's' || s[0] == 'S' || s[0] == '1');
+}
+
+// Ejecuta un comando ya separado en (nombre, resto). Devuelve false si no se reconoce.
+static bool ejecutarComandoReplay(const string& comando, istringstream& args, bool& exito)
+{
+    exito = true;
+    if (comando == "buscar")
+    {
+        string dni;
+        exito = (args >> dni) && consultarPacientePorDNI(dni);
+    }
+    else if (comando == "buscar_nombre")
+    {
+        string consulta;
+        args >> ws;
+        getline(args, consulta);
+        exito = buscarPacientesPorNombre(consulta, 10);
+    }
+    else if (comando == "registrar_paciente")
+    {
+        string dni, nombre;
+        args >> dni >> ws;
+        getline(args, nombre);
+        exito = registrarPaciente(dni, nombre);
+    }
+    else if (comando == "cancelar")
+    {
+        int id;
+        exito = (args >> id) && cancelarCitaPorId(id);
+    }
+    else if (comando == "cancelar_lote")
+    {
+        vector<int> ids;
+        int id;
+        while (args >> id)
+            ids.push_back(id);
+        exito = cancelarCitasEnLote(ids);
+    }
+    else if (comando == "llenar_huecos")
+    {
+        string fecha, hora;
+        uint32_t desde = 0;
+        if (args >> fecha >> hora)
+            exito = instanteDe(fecha, hora, desde);
+        exito = exito && llenarHuecos(desde);
+    }
+    else if (comando == "disponibilidad")
+    {
+        int estado;
+        string nombre;
+        exito = static_cast<bool>(args >> estado);
+        args >> ws;
+        getline(args, nombre);
+        exito = exito && actualizarDisponibilidadMedico(nombre, estado == 1);
+    }
+    else if (comando == "disponibles")
+    {
+        string especialidad;
+        args >> ws;
+        getline(args, especialidad);
+        exito = consultarMedicosDisponibles(especialidad);
+    }
+    else if (comando == "listar")
+    {
+        mostrarCitasProgramadas();
+    }
+    else if (comando == "espera")
+    {
+        string dni, especialidad;
+        int prioridad;
+        exito = static_cast<bool>(args >> dni >> prioridad);
+        args >> ws;
+        getline(args, especialidad);
+        exito = exito && agregarAListaEspera(dni, especialidad, prioridad);
+    }
+    else if (comando == "citas_medico")
+    {
+        int idMedico;
+        exito = (args >> idMedico) && consultarCitasPorMedico(idMedico) > 0;
+    }
+    else if (comando == "citas_fecha")
+    {
+        string fecha;
+        exito = (args >> fecha) && consultarCitasPorFecha(fecha) > 0;
+    }
+    else if (comando == "citas_paciente")
+    {
+        string dni;
+        exito = (args >> dni) && consultarCitasPorPaciente(dni) > 0;
+    }
+    else if (comando == "agenda_rango")
+    {
+        ConsultaRango q, siguiente;
+        exito = leerConsultaRango(args, q) && consultarAgendaPorRango(q, siguiente) > 0;
+    }
+    else if (comando == "agendar")
+    {
+        string dni, fecha, hora;
+        int idMedico, prioridad;
+        exito = (args >> dni >> idMedico >> fecha >> hora >> prioridad) &&
+                agendarCita(dni, idMedico, fecha, hora, prioridad);
+    }
+    else if (comando == "hueco_medico")
+    {
+        int idMedico;
+        string fecha, hora;
+        exito = static_cast<bool>(args >> idMedico >> fecha);
+        args >> hora;
+        exito = exito && buscarHuecoMedico(idMedico, fecha, hora);
+    }
+    else if (comando == "hueco_especialidad")
+    {
+        string fecha, hora, especialidad;
+        exito = static_cast<bool>(args >> fecha >> hora);
+        args >> ws;
+        getline(args, especialidad);
+        exito = exito && buscarHuecoEspecialidad(especialidad, fecha, hora);
+    }
+    else if (comando == "retirar_espera")
+    {
+        string dni;
+        exito = (args >> dni) && retirarDeListaEspera(dni);
+    }
+    else if (comando == "procesar")
+    {
+        int tipo = 0;
+        args >> tipo;
+        if (tipo == 2)
+            iniciarProcesamientoRadix();
+        else
+            iniciarProcesamiento(tipo == 1);
+    }
+    else if (comando == "emergencia")
+    {
+        int nodo;
+        exito = (args >> nodo) && registrarEmergenciaEnNodo(nodo);
+    }
+    else if (comando == "asignar_ambulancia")
+    {
+        int id;
+        exito = static_cast<bool>(args >> id);
+        if (exito)
+            asignarAmbulanciaMasCercana(id);
+    }
+    else if (comando == "asignar_emergencias")
+    {
+        asignarEmergenciasSimultaneas();
+    }
+    else if (comando == "trafico")
+    {
+        int u, v, peso, idEmerg;
+        exito = (args >> u >> v >> peso) && actualizarPesoArista(u, v, peso);
+        if (exito && args >> idEmerg)
+            exito = recalcularRutaEmergencia(idEmerg);
+    }
+    else if (comando == "trafico_lote")
+    {
+        vector<CambioPesoVia> cambios;
+        CambioPesoVia c;
+        while (args >> c.u >> c.v >> c.peso)
+            cambios.push_back(c);
+        exito = !cambios.empty() && actualizarPesosEnLote(cambios) == static_cast<int>(cambios.size());
+    }
+    else if (comando == "resumen_emergencias")
+    {
+        mostrarResumenEmergencias();
+    }
+    else if (comando == "liberar_ambulancias")
+    {
+        liberarAmbulancias();
+    }
+    else if (comando == "tabla_tiempos")
+    {
+        int activar;
+        exito = (args >> activar) && activarTablaTiempos(activar != 0);
+    }
+    else if (comando == "jerarquia")
+    {
+        string ruta;
+        exito = (args >> ruta) && prepararJerarquiaRutas(ruta);
+    }
+    else if (comando == "critico")
+    {
+        string dni, uci, vent, med, nombre;
+        int esi;
+        exito = static_cast<bool>(args >> dni >> esi >> uci >> vent >> med);
+        if (exito)
+        {
+            args >> ws;
+            getline(args, nombre);
+            int idPaciente = -1;
+            if (const Paciente* p = tablaPacientes.buscar(dni))
+            {
+                idPaciente = p->idPaciente;
+                nombre = p->nombreCompleto;
+            }
+            gestorRecursos.registrarPacienteCritico(idPaciente, dni, nombre, esi,
+                                                    leerSiNo(uci), leerSiNo(vent), leerSiNo(med));
+        }
+    }
+    else if (comando == "asignar_recursos")
+    {
+        gestorRecursos.asignarRecursosGreedy();
+    }
+    else if (comando == "alta")
+    {
+        int camas, vent;
+        exito = static_cast<bool>(args >> camas >> vent);
+        if (exito)
+            gestorRecursos.darAltaPacientes(camas, vent);
+    }
+    else if (comando == "consumir")
+    {
+        string nombre;
+        int cantidad;
+        exito = (args >> nombre >> cantidad) && gestorRecursos.consumirMedicamento(nombre, cantidad);
+    }
+    else if (comando == "reabastecer")
+    {
+        string nombre;
+        int cantidad;
+        exito = static_cast<bool>(args >> nombre >> cantidad);
+        if (exito)
+            gestorRecursos.reabastecerMedicamento(nombre, cantidad);
+    }
+    else if (comando == "reporte_recursos")
+    {
+        gestorRecursos.reporteRecursos();
+    }
+    else if (comando == "snapshot")
+    {
+        string ruta;
+        exito = (args >> ruta) && guardarSnapshot(ruta);
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+// Percentil por rango mas cercano sobre un vector ya ordenado
+static double percentil(const vector<double>& ordenado, double p)
+{
+    if (ordenado.empty())
+        return 0.0;
+    size_t idx = static_cast<size_t>(p / 100.0 * (ordenado.size() - 1) + 0.5);
+    return ordenado[min(idx, ordenado.size() - 1)];
+}
+
+static void imprimirReporteReplay(map<string, EstadisticaComando>& stats, double segundosTotales,
+                                  long long lineasInvalidas, const string& titulo = "REPORTE DE REPLAY")
+{
+    long long totalOps = 0;
+    for (const auto& kv : stats)
+        totalOps += static_cast<long long>(kv.second.latenciasUs.size());
+
+    cout << "\n================== " << titulo << " ==================\n";
+    cout << "Operaciones: " << totalOps << " | Tiempo total: " << fixed << setprecision(3)
+         << segundosTotales << " s | Throughput: "
+         << (segundosTotales > 0 ? totalOps / segundosTotales : 0.0) << " ops/s\n";
+    if (lineasInvalidas > 0)
+        cout << "Lineas no reconocidas: " << lineasInvalidas << "\n";
+
+    cout << std::left << setw(22) << "Comando" << std::right
+         << setw(10) << "N" << setw(8) << "Fallos" << setw(14) << "ops/s"
+         << setw(11) << "p50(us)" << setw(11) << "p90(us)" << setw(11) << "p99(us)"
+         << setw(12) << "max(us)" << "\n";
+    for (auto& kv : stats)
+    {
+        vector<double>& lat = kv.second.latenciasUs;
+        sort(lat.begin(), lat.end());
+        double suma = 0;
+        for (double x : lat)
+            suma += x;
+        cout << std::left << setw(22) << kv.first << std::right << setprecision(2)
+             << setw(10) << lat.size() << setw(8) << kv.second.fallos
+             << setw(14) << (suma > 0 ? lat.size() / (suma / 1e6) : 0.0)
+             << setw(11) << percentil(lat, 50) << setw(11) << percentil(lat, 90)
+             << setw(11) << percentil(lat, 99) << setw(12) << (lat.empty() ? 0.0 : lat.back()) << "\n";
+    }
+    cout << "=======================================================\n";
+    cout.unsetf(ios::floatfield);
+    cout << std::left << setprecision(6);
+}
+
+/**
+ * Modo replay: lee comandos desde un archivo (o stdin con "-") y los ejecuta
+ * sin el menu. La salida de cada operacion se descarta salvo con verbose,
+ * para que la medicion refleje el costo de las estructuras y no el de la consola.
+ */
+int ejecutarReplay(istream& entrada, bool multiplesAreas, bool verbose, const OpcionesPersistencia& persistencia)
+{
+    streambuf* salidaOriginal = cout.rdbuf();
+    if (!verbose)
+        cout.rdbuf(nullptr); // descarta la salida de las operaciones
+
+    iniciarPersistencia(persistencia);
+    iniciarProcesamiento(multiplesAreas);
+
+    map<string, EstadisticaComando> stats;
+    long long lineasInvalidas = 0;
+    string linea;
+
+    auto inicioTotal = chrono::steady_clock::now();
+    while (getline(entrada, linea))
+    {
+        size_t comentario = linea.find('#');
+        if (comentario != string::npos)
+            linea.erase(comentario);
+
+        istringstream args(linea);
+        string comando;
+        if (!(args >> comando))
+            continue;
+
+        bool exito;
+        auto t0 = chrono::steady_clock::now();
+        bool reconocido = ejecutarComandoReplay(comando, args, exito);
+        auto t1 = chrono::steady_clock::now();
+
+        if (!reconocido)
+        {
+            lineasInvalidas++;
+            continue;
+        }
+        EstadisticaComando& st = stats[comando];
+        st.latenciasUs.push_back(chrono::duration<double, micro>(t1 - t0).count());
+        if (!exito)
+            st.fallos++;
+    }
+    journalMutaciones.cerrar(); // el cierre espera el ultimo lote: cuenta en el tiempo total
+    double segundos = chrono::duration<double>(chrono::steady_clock::now() - inicioTotal).count();
+
+    cout.rdbuf(salidaOriginal);
+    cout.clear();
+    imprimirReporteReplay(stats, segundos, lineasInvalidas);
+    if (!persistencia.rutaJournal.empty())
+        cout << "Journal: " << journalMutaciones.registros << " mutaciones, " << journalMutaciones.fsyncs
+             << " fsync, " << journalMutaciones.bytesEscritos << " bytes ("
+             << (journalMutaciones.fsyncs > 0 ? journalMutaciones.registros / journalMutaciones.fsyncs : 0)
+             << " mutaciones por fsync)\n";
+    return 0;
+}
+
+// --- 7B. SERVIDOR MULTICLIENTE (SOCKET UNIX O TCP) ---
+
+/*
+ * Varias terminales de admision trabajan a la vez sobre la misma agenda.
+ * Protocolo de lineas: cada pedido es una linea con los mismos comandos del
+ * replay (seccion 7) y cada respuesta es "OK <n>" o "ERR <n>" seguida de n
+ * lineas de datos. Ademas:
+ *   medicos                      idMedico,nombre,especialidad,disponible
+ *   disponibles <especialidad>   idMedico,nombre,citas activas (primero el menos cargado)
+ *   muestra <n>                  n pacientes repartidos en la tabla (para clientes de carga)
+ *   listar [desde] [cantidad]    la agenda en formato CSV, paginada
+ *   agenda_rango ...             citas activas de una ventana en CSV (pagina siguiente: "tras <idCita>")
+ *   salir                        cierra la conexion
+ * Las consultas (buscar, buscar_nombre, citas_*, listar, medicos, muestra)
+ * responden en CSV y corren en paralelo bajo un cerrojo compartido; el resto
+ * pasa por ejecutarComandoReplay con acceso exclusivo y devuelve lo que la
+ * operacion escribio en consola.
+ */
+
+/**
+ * Cerrojo lector-escritor repartido en franjas: cada hilo lector usa siempre
+ * la misma franja (su propia linea de cache), asi las consultas concurrentes
+ * no se disputan un unico contador de lectores. Un escritor toma todas las
+ * franjas en orden.
+ */
+class CerrojoRepartido
+{
+private:
+    static constexpr size_t FRANJAS = 16;
+    struct alignas(64) Franja
+    {
+        shared_mutex mtx;
+    };
+    Franja franjas[FRANJAS];
+
+    static size_t franjaDelHilo()
+    {
+        static atomic<size_t> siguiente(0);
+        thread_local size_t propia = siguiente.fetch_add(1) % FRANJAS;
+        return propia;
+    }
+
+public:
+    class Lectura
+    {
+        shared_mutex& mtx;
+
+    public:
+        explicit Lectura(CerrojoRepartido& c) : mtx(c.franjas[franjaDelHilo()].mtx) { mtx.lock_shared(); }
+        ~Lectura() { mtx.unlock_shared(); }
+        Lectura(const Lectura&) = delete;
+        Lectura& operator=(const Lectura&) = delete;
+    };
+
+    class Escritura
+    {
+        CerrojoRepartido& c;
+
+    public:
+        explicit Escritura(CerrojoRepartido& cerrojo) : c(cerrojo)
+        {
+            for (Franja& f : c.franjas)
+                f.mtx.lock();
+        }
+        ~Escritura()
+        {
+            for (size_t i = FRANJAS; i-- > 0;)
+                c.franjas[i].mtx.unlock();
+        }
+        Escritura(const Escritura&) = delete;
+        Escritura& operator=(const Escritura&) = delete;
+    };
+};
+
+CerrojoRepartido cerrojoEstado; // protege tablas, agenda e indices mientras corre el servidor
+
+struct DestinoServidor
+{
+    string rutaSocket;          // socket Unix; si esta vacio se usa TCP
+    string host = "127.0.0.1";
+    int puerto = 0;
+};
+
+// Opciones comunes a --servidor y --cliente-carga; false si la opcion no es de destino
+bool leerOpcionDestino(int argc, char* argv[], int& i, DestinoServidor& destino)
+{
+    string opt = argv[i];
+    if (i + 1 >= argc)
+        return false;
+    if (opt == "--socket")
+        destino.rutaSocket = argv[++i];
+    else if (opt == "--host")
+        destino.host = argv[++i];
+    else if (opt == "--puerto")
+    {
+        // Un puerto invalido queda en -1 y el llamador termina con error
+        if (!leerValorOpcion(argc, argv, i, destino.puerto))
+        {
+            ++i;
+            destino.puerto = -1;
+        }
+        else if (destino.puerto <= 0 || destino.puerto > 65535)
+        {
+            cerr << "[ERROR] Puerto fuera de rango: " << argv[i] << endl;
+            destino.puerto = -1;
+        }
+    }
+    else
+        return false;
+    return true;
+}
+
+// Las filas de las respuestas son CSV: los nombres con comas van entre comillas
+static void filaPaciente(ostream& out, const Paciente& p)
+{
+    out << p.idPaciente << ',' << p.dni << ',';
+    escribirCampoCSV(out, p.nombreCompleto);
+    out << '\n';
+}
+
+static void filasCitas(ostream& out, const vector<int>& ids, size_t& filas)
+{
+    for (int id : ids)
+    {
+        int pos = indiceCitas.buscarPosicion(id);
+        if (pos == -1)
+            continue;
+        escribirCitaCSV(out, citasProgramadas[pos]);
+        filas++;
+    }
+}
+
+/**
+ * Consultas de solo lectura. Devuelve false si el comando no es una consulta;
+ * si lo es, deja las filas en 'datos' y su cantidad en 'filas'.
+ */
+static bool responderConsulta(const string& comando, istringstream& args, ostringstream& datos, size_t& filas,
+                              bool& exito)
+{
+    static const set<string> consultas = { "buscar", "buscar_nombre", "citas_medico", "citas_fecha",
+                                           "citas_paciente", "agenda_rango", "listar", "medicos", "disponibles",
+                                           "muestra" };
+    if (!consultas.count(comando))
+        return false;
+
+    CerrojoRepartido::Lectura lectura(cerrojoEstado);
+    filas = 0;
+    exito = true;
+    if (comando == "buscar")
+    {
+        string dni;
+        const Paciente* p = (args >> dni) ? tablaPacientes.buscar(dni) : nullptr;
+        exito = (p != nullptr);
+        if (p)
+            filaPaciente(datos, *p);
+        else
+            datos << "Paciente con DNI " << dni << " no encontrado\n";
+        filas = 1;
+    }
+    else if (comando == "buscar_nombre")
+    {
+        string consulta;
+        args >> ws;
+        getline(args, consulta);
+        for (const ResultadoNombre& r : indiceNombres.buscar(consulta, 10, tablaPacientes))
+        {
+            datos << r.paciente->idPaciente << ',' << r.paciente->dni << ',';
+            escribirCampoCSV(datos, r.paciente->nombreCompleto);
+            datos << ',' << r.distancia << '\n';
+            filas++;
+        }
+    }
+    else if (comando == "citas_medico")
+    {
+        int idMedico;
+        exito = static_cast<bool>(args >> idMedico);
+        if (exito)
+            filasCitas(datos, indiceCitas.idsDeMedico(idMedico), filas);
+    }
+    else if (comando == "citas_fecha")
+    {
+        string fecha;
+        exito = static_cast<bool>(args >> fecha);
+        if (exito)
+            filasCitas(datos, indiceCitas.idsEnFecha(fecha), filas);
+    }
+    else if (comando == "citas_paciente")
+    {
+        string dni;
+        exito = static_cast<bool>(args >> dni);
+        if (exito)
+            filasCitas(datos, indiceCitas.idsDePaciente(dni), filas);
+    }
+    else if (comando == "agenda_rango")
+    {
+        ConsultaRango q;
+        exito = leerConsultaRango(args, q);
+        if (exito)
+        {
+            recorrerAgendaPorRango(q, [&](const Cita& c)
+            {
+                escribirCitaCSV(datos, c);
+                filas++;
+            });
+        }
+    }
+    else if (comando == "listar")
+    {
+        size_t desde = 0, cantidad = citasProgramadas.size();
+        args >> desde >> cantidad;
+        for (size_t i = desde; i < citasProgramadas.size() && filas < cantidad; ++i, ++filas)
+            escribirCitaCSV(datos, citasProgramadas[i]);
+    }
+    else if (comando == "medicos")
+    {
+        for (const auto& kv : tablaMedicos)
+        {
+            const Medico& m = kv.second;
+            datos << m.idMedico << ',';
+            escribirCampoCSV(datos, m.nombreCompleto);
+            datos << ',';
+            escribirCampoCSV(datos, m.especialidad);
+            datos << ',' << (m.disponible ? 1 : 0) << '\n';
+            filas++;
+        }
+    }
+    else if (comando == "disponibles")
+    {
+        // idMedico,nombre,citas activas; el primero es el menos cargado
+        string especialidad;
+        args >> ws;
+        getline(args, especialidad);
+        vector<int> ids = disponibilidadMedicos.disponibles(especialidad);
+        int menosCargado = disponibilidadMedicos.menosCargado(especialidad);
+        if (menosCargado != -1)
+            iter_swap(ids.begin(), find(ids.begin(), ids.end(), menosCargado));
+        for (int id : ids)
+        {
+            datos << id << ',';
+            escribirCampoCSV(datos, calendarioMedicos.nombreMedico(id));
+            datos << ',' << disponibilidadMedicos.carga(id) << '\n';
+        }
+        filas = ids.size();
+        exito = !ids.empty();
+    }
+    else if (comando == "muestra")
+    {
+        size_t n = 0;
+        args >> n;
+        size_t total = tablaPacientes.size();
+        n = min(n, total);
+        for (size_t i = 0; i < n; ++i, ++filas)
+            filaPaciente(datos, tablaPacientes.enPosicion(static_cast<uint32_t>(i * total / n)));
+    }
+    return true;
+}
+
+// Una linea de pedido -> respuesta completa ("OK/ERR <n>" + n lineas). Devuelve false con "salir".
+static bool atenderPedido(const string& pedido, string& respuesta)
+{
+    istringstream args(pedido);
+    string comando;
+    if (!(args >> comando))
+    {
+        respuesta = "ERR 1\nlinea vacia\n";
+        return true;
+    }
+    if (comando == "salir")
+    {
+        respuesta = "OK 0\n";
+        return false;
+    }
+
+    ostringstream datos;
+    size_t filas = 0;
+    bool exito = true;
+    if (!responderConsulta(comando, args, datos, filas, exito))
+    {
+        // La salida de la operacion va a la respuesta; el cout global no se toca
+        CerrojoRepartido::Escritura escritura(cerrojoEstado);
+        bool reconocido;
+        {
+            DesvioSalida desvio(datos);
+            reconocido = ejecutarComandoReplay(comando, args, exito);
+        }
+        if (!reconocido)
+        {
+            respuesta = "ERR 1\ncomando no reconocido: " + comando + "\n";
+            return true;
+        }
+        // Solo las lineas con texto; el menu deja lineas en blanco entre bloques
+        string salida = datos.str(), linea;
+        datos.str("");
+        istringstream lineas(salida);
+        while (getline(lineas, linea))
+        {
+            if (linea.find_first_not_of(' ') == string::npos)
+                continue;
+            datos << linea << '\n';
+            filas++;
+        }
+    }
+    respuesta = (exito ? "OK " : "ERR ") + to_string(filas) + "\n" + datos.str();
+    return true;
+}
+
+struct ConfigCargaCliente
+{
+    int conexiones = 8;
+    long long operaciones = 20000;  // por conexion
+    int porcentajeEscrituras = 10;
+};
+
+#ifndef _WIN32
+// Lectura por lineas y envio completo sobre un descriptor de socket
+class ConexionLineas
+{
+private:
+    int fd;
+    string pendiente;
+    size_t inicio = 0;
 
 public:
-    GestorRecursosHospitalarios(int camasUCI, int ventiladores)
-        : totalCamasUCI(camasUCI),
-        camasOcupadas(0),
-        totalVentiladores(ventiladores),
-        ventiladoresOcupados(0),
-        contadorLlegada(0) {}
+    explicit ConexionLineas(int descriptor) : fd(descriptor) {}
 
-    InventarioMedicamentos& obtenerInventario()
+    bool leerLinea(string& linea)
+    {
+        while (true)
+        {
+            size_t salto = pendiente.find('\n', inicio);
+            if (salto != string::npos)
+            {
+                linea.assign(pendiente, inicio, salto - inicio);
+                if (!linea.empty() && linea.back() == '\r')
+                    linea.pop_back();
+                inicio = salto + 1;
+                return true;
+            }
+            pendiente.erase(0, inicio);
+            inicio = 0;
+            char buffer[4096];
+            ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+            if (n <= 0)
+                return false;
+            pendiente.append(buffer, static_cast<size_t>(n));
+        }
+    }
+
+    bool enviar(const string& datos)
+    {
+        size_t enviado = 0;
+        while (enviado < datos.size())
+        {
+            ssize_t n = send(fd, datos.data() + enviado, datos.size() - enviado, MSG_NOSIGNAL);
+            if (n <= 0)
+                return false;
+            enviado += static_cast<size_t>(n);
+        }
+        return true;
+    }
+};
+
+static int abrirSocket(const DestinoServidor& destino, bool escuchar)
+{
+    int fd;
+    if (!destino.rutaSocket.empty())
+    {
+        sockaddr_un dir;
+        memset(&dir, 0, sizeof(dir));
+        dir.sun_family = AF_UNIX;
+        if (destino.rutaSocket.size() >= sizeof(dir.sun_path))
+            return -1;
+        strcpy(dir.sun_path, destino.rutaSocket.c_str());
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0)
+            return -1;
+        if (escuchar)
+            unlink(dir.sun_path); // socket viejo de una ejecucion anterior
+        int r = escuchar ? ::bind(fd, reinterpret_cast<sockaddr*>(&dir), sizeof(dir))
+                         : connect(fd, reinterpret_cast<sockaddr*>(&dir), sizeof(dir));
+        if (r != 0)
+        {
+            close(fd);
+            return -1;
+        }
+    }
+    else
+    {
+        sockaddr_in dir;
+        memset(&dir, 0, sizeof(dir));
+        dir.sin_family = AF_INET;
+        dir.sin_port = htons(static_cast<uint16_t>(destino.puerto));
+        if (inet_pton(AF_INET, destino.host.c_str(), &dir.sin_addr) != 1)
+            return -1;
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0)
+            return -1;
+        int uno = 1;
+        if (escuchar)
+            setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &uno, sizeof(uno));
+        else
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &uno, sizeof(uno)); // pedidos cortos de ida y vuelta
+        int r = escuchar ? ::bind(fd, reinterpret_cast<sockaddr*>(&dir), sizeof(dir))
+                         : connect(fd, reinterpret_cast<sockaddr*>(&dir), sizeof(dir));
+        if (r != 0)
+        {
+            close(fd);
+            return -1;
+        }
+    }
+    if (escuchar && listen(fd, 128) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static volatile sig_atomic_t detenerServidor = 0;
+
+static void manejarSenalServidor(int)
+{
+    detenerServidor = 1;
+}
+
+/**
+ * Modo servidor: un hilo por conexion; el bucle de aceptacion une los que ya
+ * terminaron, asi no se acumulan. Termina con SIGINT/SIGTERM, cierra las
+ * conexiones abiertas, vacia el journal y guarda el snapshot si se indico.
+ */
+int ejecutarServidor(const DestinoServidor& destino, const OpcionesPersistencia& persistencia)
+{
+    {
+        ostream descarte(nullptr); // la carga inicial no se muestra
+        DesvioSalida desvio(descarte);
+        iniciarPersistencia(persistencia);
+        iniciarProcesamiento(false);
+    }
+
+    int escucha = abrirSocket(destino, true);
+    if (escucha < 0)
+    {
+        cerr << "[ERROR] No se pudo escuchar en "
+             << (destino.rutaSocket.empty() ? destino.host + ":" + to_string(destino.puerto) : destino.rutaSocket)
+             << endl;
+        return 1;
+    }
+    signal(SIGINT, manejarSenalServidor);
+    signal(SIGTERM, manejarSenalServidor);
+    cerr << "[INFO] Servidor atendiendo en "
+         << (destino.rutaSocket.empty() ? destino.host + ":" + to_string(destino.puerto) : destino.rutaSocket)
+         << " (" << tablaPacientes.size() << " pacientes, " << citasProgramadas.size() << " citas)" << endl;
+
+    // Hilos de conexion; los que ya terminaron se unen en cada vuelta del bucle
+    struct HiloConexion
+    {
+        thread hilo;
+        atomic<bool> terminado{ false };
+    };
+    mutex mtxConexiones;
+    set<int> abiertas;
+    list<HiloConexion> hilos; // nodos estables: cada hilo guarda la direccion de su propio registro
+    auto recogerTerminados = [&hilos]()
+    {
+        for (auto it = hilos.begin(); it != hilos.end();)
+        {
+            if (it->terminado.load())
+            {
+                it->hilo.join();
+                it = hilos.erase(it);
+            }
+            else
+                ++it;
+        }
+    };
+    atomic<long long> pedidos(0);
+    while (!detenerServidor)
+    {
+        recogerTerminados();
+        pollfd p = { escucha, POLLIN, 0 };
+        if (poll(&p, 1, 200) <= 0) // despierta periodicamente para ver si llego una senal
+            continue;
+        int fd = accept(escucha, nullptr, nullptr);
+        if (fd < 0)
+            continue;
+        {
+            lock_guard<mutex> lk(mtxConexiones);
+            abiertas.insert(fd);
+        }
+        hilos.emplace_back();
+        HiloConexion& propio = hilos.back();
+        propio.hilo = thread([fd, &propio, &mtxConexiones, &abiertas, &pedidos]()
+        {
+            ConexionLineas conexion(fd);
+            string linea, respuesta;
+            while (conexion.leerLinea(linea))
+            {
+                bool seguir = atenderPedido(linea, respuesta);
+                pedidos++;
+                if (!conexion.enviar(respuesta) || !seguir)
+                    break;
+            }
+            {
+                lock_guard<mutex> lk(mtxConexiones);
+                abiertas.erase(fd);
+                close(fd);
+            }
+            propio.terminado = true;
+        });
+    }
+
+    close(escucha);
+    if (!destino.rutaSocket.empty())
+        unlink(destino.rutaSocket.c_str());
+    {
+        lock_guard<mutex> lk(mtxConexiones);
+        for (int fd : abiertas)
+            shutdown(fd, SHUT_RDWR); // desbloquea el recv de cada hilo
+    }
+    for (HiloConexion& h : hilos)
+        h.hilo.join();
+    journalMutaciones.cerrar();
+    cerr << "[INFO] Servidor detenido tras " << pedidos.load() << " pedidos." << endl;
+    if (!persistencia.rutaSnapshot.empty())
+        return guardarSnapshot(persistencia.rutaSnapshot) ? 0 : 1;
+    return 0;
+}
+
+// Envia un pedido y lee la respuesta completa; devuelve las lineas de datos
+static bool pedirAlServidor(ConexionLineas& conexion, const string& pedido, vector<string>& filas, bool& exito)
+{
+    string cabecera;
+    if (!conexion.enviar(pedido + "\n") || !conexion.leerLinea(cabecera))
+        return false;
+    exito = cabecera.compare(0, 3, "OK ") == 0;
+    size_t espacio = cabecera.find(' '), n = 0;
+    if (espacio == string::npos || !leerNumeroArgumento(cabecera.c_str() + espacio + 1, n))
+        return false; // cabecera ilegible: la conexion ya no esta sincronizada
+    filas.resize(n);
+    for (size_t i = 0; i < n; ++i)
+        if (!conexion.leerLinea(filas[i]))
+            return false;
+    return true;
+}
+
+/**
+ * Generador de carga: cada conexion repite una mezcla de consultas (DNI,
+ * nombre, citas del paciente) y escrituras (disponibilidad de medicos y
+ * agendamientos) sobre pacientes y medicos obtenidos del propio servidor.
+ * Informa el throughput total y la latencia de ida y vuelta por comando.
+ */
+int ejecutarClienteCarga(const DestinoServidor& destino, const ConfigCargaCliente& cfg)
+{
+    // Datos de trabajo: una muestra de pacientes y la lista de medicos
+    int fd = abrirSocket(destino, false);
+    if (fd < 0)
+    {
+        cerr << "[ERROR] No se pudo conectar al servidor." << endl;
+        return 1;
+    }
+    vector<string> pacientes, medicos;
+    {
+        ConexionLineas conexion(fd);
+        bool ok;
+        if (!pedirAlServidor(conexion, "muestra 10000", pacientes, ok) ||
+            !pedirAlServidor(conexion, "medicos", medicos, ok) || pacientes.empty() || medicos.empty())
+        {
+            cerr << "[ERROR] El servidor no devolvio pacientes o medicos para generar carga." << endl;
+            close(fd);
+            return 1;
+        }
+        conexion.enviar("salir\n");
+        close(fd);
+    }
+    // filas "id,dni,nombre" -> dni y primeras letras del nombre; "id,nombre,especialidad,disp" -> id y nombre
+    vector<pair<string, string>> dniYNombre;
+    string nombre;
+    for (const string& f : pacientes)
+    {
+        string_view campos[3];
+        if (separarCamposCSV(f, campos, 3) != 3)
+            continue;
+        asignarCampoCSV(nombre, campos[2]);
+        dniYNombre.emplace_back(string(campos[1]), nombre.substr(0, 4));
+    }
+    vector<pair<string, string>> idYNombreMedico;
+    for (const string& f : medicos)
+    {
+        string_view campos[4];
+        if (separarCamposCSV(f, campos, 4) < 2)
+            continue;
+        asignarCampoCSV(nombre, campos[1]);
+        idYNombreMedico.emplace_back(string(campos[0]), nombre);
+    }
+
+    vector<map<string, EstadisticaComando>> statsPorHilo(cfg.conexiones);
+    atomic<int> sinConexion(0);
+    auto inicio = chrono::steady_clock::now();
+    vector<thread> hilos;
+    for (int h = 0; h < cfg.conexiones; ++h)
+    {
+        hilos.emplace_back([&, h]()
+        {
+            int fdHilo = abrirSocket(destino, false);
+            if (fdHilo < 0)
+            {
+                sinConexion++;
+                return;
+            }
+            ConexionLineas conexion(fdHilo);
+            uint64_t estado = 88172645463325252ULL + static_cast<uint64_t>(h) * 0x9E3779B97F4A7C15ULL;
+            auto rng = [&estado]() // xorshift64, una semilla fija por conexion
+            {
+                estado ^= estado << 13;
+                estado ^= estado >> 7;
+                estado ^= estado << 17;
+                return estado;
+            };
+            vector<string> filas;
+            for (long long i = 0; i < cfg.operaciones; ++i)
+            {
+                const auto& pac = dniYNombre[rng() % dniYNombre.size()];
+                string comando, pedido;
+                if (static_cast<int>(rng() % 100) < cfg.porcentajeEscrituras)
+                {
+                    const auto& med = idYNombreMedico[rng() % idYNombreMedico.size()];
+                    if (rng() % 2 == 0)
+                    {
+                        comando = "disponibilidad";
+                        pedido = comando + " " + to_string(rng() % 2) + " " + med.second;
+                    }
+                    else
+                    {
+                        char hora[6];
+                        snprintf(hora, sizeof(hora), "%02u:%02u", 8 + static_cast<unsigned>(rng() % 10),
+                                 static_cast<unsigned>(rng() % 2) * 30);
+                        comando = "agendar";
+                        pedido = comando + " " + pac.first + " " + med.first + " 2025-12-" +
+                                 to_string(10 + rng() % 18) + " " + hora + " " + to_string(1 + rng() % 5);
+                    }
+                }
+                else
+                {
+                    static const char* lecturas[] = { "buscar", "buscar", "buscar_nombre", "citas_paciente" };
+                    comando = lecturas[rng() % 4];
+                    pedido = comando + " " + (comando == "buscar_nombre" ? pac.second : pac.first);
+                }
+                bool exito;
+                auto t0 = chrono::steady_clock::now();
+                if (!pedirAlServidor(conexion, pedido, filas, exito))
+                    break;
+                auto t1 = chrono::steady_clock::now();
+                EstadisticaComando& st = statsPorHilo[h][comando];
+                st.latenciasUs.push_back(chrono::duration<double, micro>(t1 - t0).count());
+                if (!exito)
+                    st.fallos++;
+            }
+            conexion.enviar("salir\n");
+            close(fdHilo);
+        });
+    }
+    for (thread& h : hilos)
+        h.join();
+    double segundos = chrono::duration<double>(chrono::steady_clock::now() - inicio).count();
+
+    map<string, EstadisticaComando> stats;
+    for (auto& porHilo : statsPorHilo)
+        for (auto& kv : porHilo)
+        {
+            EstadisticaComando& st = stats[kv.first];
+            st.latenciasUs.insert(st.latenciasUs.end(), kv.second.latenciasUs.begin(), kv.second.latenciasUs.end());
+            st.fallos += kv.second.fallos;
+        }
+    cout << "Conexiones: " << cfg.conexiones - sinConexion.load() << " | escrituras: " << cfg.porcentajeEscrituras << "%"
+         << (cfg.porcentajeEscrituras > 0 ? " (los fallos de agendar son choques de horario)" : "") << endl;
+    imprimirReporteReplay(stats, segundos, 0, "CARGA SOBRE EL SERVIDOR");
+    return sinConexion.load() == cfg.conexiones ? 1 : 0;
+}
+#else
+int ejecutarServidor(const DestinoServidor&, const OpcionesPersistencia&)
+{
+    cerr << "[ERROR] El modo servidor requiere sockets POSIX." << endl;
+    return 1;
+}
+
+int ejecutarClienteCarga(const DestinoServidor&, const ConfigCargaCliente&)
+{
+    cerr << "[ERROR] El cliente de carga requiere sockets POSIX." << endl;
+    return 1;
+}
+#endif
+
+// --- 7C. GENERADOR DETERMINISTA DE CARGA SINTETICA ---
+
+/*
+ * main --generar <directorio> escribe datos sinteticos en los formatos que el
+ * sistema ya sabe cargar:
+ *   pacientes.csv, medicos.csv, citas.csv      -> --importar o --pacientes/--medicos/--citas (seccion 4C)
+ *   grafo.csv                                  -> --grafo (cargarGrafoDesdeArchivo)
+ *   espera.txt, emergencias.txt, criticos.txt  -> --replay (seccion 7)
+ * Con la misma semilla y los mismos volumenes la salida es identica byte a byte.
+ * Cada archivo tiene su propio flujo aleatorio derivado de la semilla, asi que
+ * cambiar el volumen de un modulo no altera los datos de los demas.
+ */
+
+struct ConfigGenerador
+{
+    string directorio;
+    uint64_t semilla = 88172645463325252ULL;
+    size_t pacientes = 100000;
+    size_t medicos = 200;
+    size_t citas = 500000;
+    size_t espera = 20000;
+    size_t nodos = 1000;
+    size_t ambulancias = 20;
+    size_t emergencias = 5000;
+    size_t criticos = 2000;
+    string fechaInicio = "2025-12-01";
+    int dias = 90;
+    int mezclaESI[5] = { 3, 25, 45, 20, 7 }; // pesos relativos de ESI 1..5
+};
+
+// xorshift64 con un flujo independiente por archivo, mas las distribuciones que usa el generador
+class AzarSintetico
+{
+private:
+    uint64_t estado;
+
+public:
+    AzarSintetico(uint64_t semilla, uint64_t flujo)
+    {
+        estado = semilla ^ (flujo * 0x9E3779B97F4A7C15ULL);
+        if (estado == 0)
+            estado = 88172645463325252ULL;
+        for (int i = 0; i < 8; ++i)
+            siguiente();
+    }
+
+    uint64_t siguiente()
+    {
+        estado ^= estado << 13;
+        estado ^= estado >> 7;
+        estado ^= estado << 17;
+        return estado;
+    }
+
+    size_t uniforme(size_t n)
+    {
+        return static_cast<size_t>(siguiente() % n);
+    }
+
+    double unidad()
+    {
+        return static_cast<double>(siguiente() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    bool probabilidad(double p)
+    {
+        return unidad() < p;
+    }
+
+    // Indice en [0, n) cargado hacia el principio: n * u^potencia
+    size_t sesgado(size_t n, int potencia)
+    {
+        double u = unidad(), x = 1.0;
+        for (int i = 0; i < potencia; ++i)
+            x *= u;
+        return min(n - 1, static_cast<size_t>(x * static_cast<double>(n)));
+    }
+
+    // Indice elegido con probabilidad proporcional a pesos[i]
+    int ponderado(const int* pesos, int n)
+    {
+        int total = 0;
+        for (int i = 0; i < n; ++i)
+            total += pesos[i];
+        int r = static_cast<int>(uniforme(static_cast<size_t>(max(total, 1))));
+        for (int i = 0; i < n; ++i)
+        {
+            if (r < pesos[i])
+                return i;
+            r -= pesos[i];
+        }
+        return n - 1;
+    }
+};
+
+const char* const ESPECIALIDADES_SINTETICAS[] = { "Medicina General", "Pediatría", "Cardiología", "Traumatología",
+                                                  "Ginecología", "Dermatología", "Oftalmología", "Neurología",
+                                                  "Psiquiatría" };
+const int PESOS_ESPECIALIDAD[] = { 30, 15, 10, 10, 10, 8, 6, 6, 5 };
+const int NUM_ESPECIALIDADES_SINTETICAS = sizeof(PESOS_ESPECIALIDAD) / sizeof(PESOS_ESPECIALIDAD[0]);
+const int PESOS_PRIORIDAD_CITA[] = { 5, 15, 30, 30, 20 };   // prioridad 1 (alta) .. 5 (baja)
+const int PESOS_PRIORIDAD_ESPERA[] = { 10, 20, 30, 25, 15 };
+
+// El i-esimo paciente sintetico: ids y DNIs consecutivos, para referenciarlo sin guardarlo
+inline int idPacienteSintetico(size_t i)
+{
+    return 100000 + static_cast<int>(i);
+}
+
+inline string dniPacienteSintetico(size_t i)
+{
+    return to_string(40000000 + i);
+}
+
+static string nombreSintetico(AzarSintetico& azar)
+{
+    string nombre = NOMBRES_SINTETICOS[azar.uniforme(NUM_NOMBRES_SINTETICOS)];
+    if (azar.probabilidad(0.4))
+        nombre += string(" ") + NOMBRES_SINTETICOS[azar.uniforme(NUM_NOMBRES_SINTETICOS)];
+    nombre += string(" ") + APELLIDOS_SINTETICOS[azar.uniforme(NUM_APELLIDOS_SINTETICOS)];
+    nombre += string(" ") + APELLIDOS_SINTETICOS[azar.uniforme(NUM_APELLIDOS_SINTETICOS)];
+    return nombre;
+}
+
+static bool abrirSalidaGenerador(const ConfigGenerador& cfg, const string& nombre, ofstream& out)
+{
+    string ruta = cfg.directorio + "/" + nombre;
+    out.open(ruta, ios::trunc);
+    if (!out)
+        cerr << "[ERROR] No se pudo crear " << ruta << endl;
+    return static_cast<bool>(out);
+}
+
+/**
+ * Citas con prioridad sesgada a los niveles medios, fechas cargadas hacia los
+ * primeros dias del horizonte y horarios de mañana mas frecuentes. No hay dos
+ * citas del mismo medico en el mismo slot: una mascara de 64 bits por
+ * (medico, dia) marca la jornada y los choques se corren al siguiente slot libre.
+ */
+static bool generarCitasSinteticas(const ConfigGenerador& cfg, const vector<string>& nombresMedicos,
+                                   const vector<int>& especialidadMedico, ofstream& out)
+{
+    const int SLOTS_JORNADA = SLOT_FIN_JORNADA - SLOT_INICIO_JORNADA; // 48, cabe en la mascara
+    const int SLOTS_MANANA = (13 * 60) / MINUTOS_POR_SLOT - SLOT_INICIO_JORNADA;
+    const uint64_t JORNADA_LLENA = (1ULL << SLOTS_JORNADA) - 1;
+    const size_t M = nombresMedicos.size(), D = static_cast<size_t>(cfg.dias);
+    if (cfg.citas > M * D * SLOTS_JORNADA)
+    {
+        cerr << "[ERROR] " << cfg.citas << " citas no caben en " << M << " medicos x " << D
+             << " dias; aumente --dias o --medicos." << endl;
+        return false;
+    }
+    uint64_t primerDia = diasDesdeEpoca(cfg.fechaInicio);
+    vector<string> fechas, horas;
+    for (size_t d = 0; d < D; ++d)
+        fechas.push_back(formatearFecha(primerDia + d));
+    for (int s = 0; s < SLOTS_JORNADA; ++s)
+        horas.push_back(formatearHoraSlot(SLOT_INICIO_JORNADA + s));
+
+    AzarSintetico azar(cfg.semilla, 3);
+    vector<uint64_t> ocupados(M * D, 0);
+    for (size_t i = 0; i < cfg.citas; ++i)
+    {
+        size_t medico = azar.uniforme(M);
+        size_t dia = azar.sesgado(D, 2);
+        int inicio = azar.probabilidad(0.7) ? static_cast<int>(azar.uniforme(SLOTS_MANANA))
+                                            : SLOTS_MANANA + static_cast<int>(azar.uniforme(SLOTS_JORNADA - SLOTS_MANANA));
+        // Corrimiento: siguiente slot libre del dia, luego los dias siguientes, luego otro medico
+        while (ocupados[medico * D + dia] == JORNADA_LLENA)
+        {
+            if (++dia == D)
+            {
+                dia = 0;
+                medico = (medico + 1) % M;
+            }
+            inicio = 0;
+        }
+        uint64_t libres = ~ocupados[medico * D + dia] & JORNADA_LLENA;
+        uint64_t desdeInicio = libres & ~((1ULL << inicio) - 1);
+        int slot = contarCerosFinales(desdeInicio ? desdeInicio : libres);
+        ocupados[medico * D + dia] |= 1ULL << slot;
+
+        size_t paciente = azar.sesgado(cfg.pacientes, 2); // pacientes frecuentes al principio
+        int prioridad = 1 + azar.ponderado(PESOS_PRIORIDAD_CITA, 5);
+        out << (i + 1) << ',' << idPacienteSintetico(paciente) << ',' << (500 + medico) << ','
+            << dniPacienteSintetico(paciente) << ',' << nombresMedicos[medico] << ',' << fechas[dia] << ','
+            << horas[slot] << ',' << ESPECIALIDADES_SINTETICAS[especialidadMedico[medico]] << ',' << prioridad << ','
+            << (azar.probabilidad(0.03) ? 1 : 0) << '\n';
+    }
+    return true;
+}
+
+/**
+ * Mapa vial: cuadricula de calles de 2-9 minutos con avenidas rapidas (1-3
+ * minutos) cada 8 filas y columnas, mas atajos diagonales cortos. La
+ * cuadricula garantiza que el grafo sea conexo. El nodo 0 es el hospital.
+ */
+static void generarGrafoSintetico(const ConfigGenerador& cfg, vector<AristaAmbulancia>& vias)
+{
+    AzarSintetico azar(cfg.semilla, 5);
+    const size_t N = cfg.nodos;
+    size_t ancho = 1;
+    while (ancho * ancho < N)
+        ancho++;
+    auto peso = [&azar](bool avenida) { return avenida ? 1 + static_cast<int>(azar.uniforme(3)) : 2 + static_cast<int>(azar.uniforme(8)); };
+    for (size_t v = 0; v < N; ++v)
     {
-        return inventario;
+        size_t fila = v / ancho, col = v % ancho;
+        if (col + 1 < ancho && v + 1 < N)
+            vias.push_back({ static_cast<int>(v), static_cast<int>(v + 1), peso(fila % 8 == 0) });
+        if (v + ancho < N)
+            vias.push_back({ static_cast<int>(v), static_cast<int>(v + ancho), peso(col % 8 == 0) });
     }
-
-    // Registro interactivo de paciente crítico
-    void registrarPacienteCriticoInteractivo()
+    for (size_t k = 0; k < N / 20; ++k)
     {
-        string dni;
-        cout << "\n[RECURSOS] Ingrese DNI del paciente critico: ";
-        cin >> dni;
-
-        int idPaciente = -1;
-        string nombre;
+        size_t v = azar.uniforme(N);
+        size_t fila = v / ancho + 1 + azar.uniforme(3), col = v % ancho + 1 + azar.uniforme(3);
+        size_t w = fila * ancho + col;
+        if (col < ancho && w < N)
+            vias.push_back({ static_cast<int>(v), static_cast<int>(w), 3 + static_cast<int>(azar.uniforme(10)) });
+    }
+}
 
-        auto it = tablaPacientes.find(dni);
-        if (it != tablaPacientes.end())
+/**
+ * Flujo de emergencias: llegadas concentradas alrededor de zonas calientes (60%)
+ * o uniformes en la ciudad, en tandas de la mitad de la flota que se despachan
+ * con asignar_emergencias. Cada dos tandas las ambulancias vuelven a servicio, y
+ * cada 10 llegadas cambia el trafico de una via existente (pesos positivos).
+ */
+static void generarEmergenciasSinteticas(const ConfigGenerador& cfg, const vector<AristaAmbulancia>& vias,
+                                         ofstream& out)
+{
+    AzarSintetico azar(cfg.semilla, 6);
+    const size_t N = cfg.nodos;
+    vector<size_t> zonasCalientes;
+    for (size_t k = 0; k < max<size_t>(1, N / 100); ++k)
+        zonasCalientes.push_back(azar.uniforme(N));
+    const size_t TANDA = max<size_t>(1, cfg.ambulancias / 2);
+    out << "# " << cfg.emergencias << " emergencias sobre " << N << " nodos y " << cfg.ambulancias << " ambulancias\n";
+    for (size_t i = 0; i < cfg.emergencias; ++i)
+    {
+        size_t nodo = azar.uniforme(N);
+        if (azar.probabilidad(0.6))
+            nodo = min(N - 1, zonasCalientes[azar.uniforme(zonasCalientes.size())] + azar.uniforme(3));
+        out << "emergencia " << nodo << '\n';
+        if (!vias.empty() && i % 10 == 9)
         {
-            idPaciente = it->second.idPaciente;
-            nombre = it->second.nombreCompleto;
-            cout << "  > Paciente encontrado en tabla: " << nombre << " (ID " << idPaciente << ")\n";
+            const AristaAmbulancia& e = vias[azar.uniforme(vias.size())];
+            out << "trafico " << e.u << ' ' << e.v << ' ' << 1 + azar.uniforme(20) << '\n';
         }
-        else
+        if ((i + 1) % TANDA == 0 || i + 1 == cfg.emergencias)
         {
-            cout << "  > Paciente no registrado en tabla. Ingrese nombre completo: ";
-            cin.ignore();
-            getline(cin, nombre);
+            out << "asignar_emergencias\n";
+            if (((i + 1) / TANDA) % 2 == 0)
+                out << "liberar_ambulancias\n";
         }
+    }
+}
 
-        int nivelESI;
-        char cUCI, cVent, cMed;
-        cout << "  > Nivel de urgencia ESI (1-5): ";
-        cin >> nivelESI;
-        cout << "  > ¿Necesita cama UCI? (s/n): ";
-        cin >> cUCI;
-        cout << "  > ¿Necesita ventilador? (s/n): ";
-        cin >> cVent;
-        cout << "  > ¿Requiere medicacion critica inmediata? (s/n): ";
-        cin >> cMed;
+/**
+ * Llegadas de pacientes criticos con la mezcla ESI indicada. La necesidad de
+ * UCI, ventilador y medicacion critica depende del nivel; el 10% llega sin
+ * estar registrado. Cada 10 llegadas se asignan recursos, cada 25 hay altas y
+ * cada 50 se reabastece la medicacion.
+ */
+static void generarCriticosSinteticos(const ConfigGenerador& cfg, ofstream& out)
+{
+    static const double PROB_UCI[5] = { 0.9, 0.5, 0.1, 0.0, 0.0 };
+    static const double PROB_VENTILADOR[5] = { 0.6, 0.15, 0.02, 0.0, 0.0 };
+    static const double PROB_MEDICACION[5] = { 0.7, 0.3, 0.05, 0.01, 0.0 };
+    AzarSintetico azar(cfg.semilla, 7);
+    auto sn = [&azar](double p) { return azar.probabilidad(p) ? 's' : 'n'; };
+    for (size_t i = 0; i < cfg.criticos; ++i)
+    {
+        int esi = 1 + azar.ponderado(cfg.mezclaESI, 5);
+        bool registrado = cfg.pacientes > 0 && !azar.probabilidad(0.1);
+        string dni = registrado ? dniPacienteSintetico(azar.uniforme(cfg.pacientes)) : to_string(90000000 + i);
+        char uci = sn(PROB_UCI[esi - 1]), vent = sn(PROB_VENTILADOR[esi - 1]), med = sn(PROB_MEDICACION[esi - 1]);
+        out << "critico " << dni << ' ' << esi << ' ' << uci << ' ' << vent << ' ' << med;
+        if (!registrado)
+            out << ' ' << nombreSintetico(azar);
+        out << '\n';
+        if (i % 10 == 9)
+            out << "asignar_recursos\n";
+        if (i % 25 == 24)
+            out << "alta " << 1 + azar.uniforme(4) << ' ' << azar.uniforme(3) << '\n';
+        if (i % 50 == 49)
+            out << "reabastecer MedicamentoCriticoA 10\n";
+    }
+    out << "asignar_recursos\n";
+}
 
-        UrgenciaESI urg;
-        if (nivelESI <= 1)
-            urg = UrgenciaESI::ESI1;
-        else if (nivelESI == 2)
-            urg = UrgenciaESI::ESI2;
-        else if (nivelESI == 3)
-            urg = UrgenciaESI::ESI3;
-        else if (nivelESI == 4)
-            urg = UrgenciaESI::ESI4;
-        else
-            urg = UrgenciaESI::ESI5;
+int generarCargaSintetica(const ConfigGenerador& cfg)
+{
+    if (cfg.medicos == 0 || cfg.dias <= 0 || diasDesdeEpoca(cfg.fechaInicio) == MAX_DIA ||
+        (cfg.citas > 0 && cfg.pacientes == 0) || cfg.nodos == 0)
+    {
+        cerr << "[ERROR] Configuracion invalida: se necesitan medicos, nodos, dias > 0, una fecha YYYY-MM-DD"
+             << " y pacientes si hay citas." << endl;
+        return 1;
+    }
+    error_code ec;
+    filesystem::create_directories(cfg.directorio, ec);
+    auto inicio = chrono::steady_clock::now();
 
-        PacienteCritico p;
-        p.idPaciente = idPaciente;
-        p.dni = dni;
-        p.nombre = nombre;
-        p.urgencia = urg;
-        p.necesitaUCI = (cUCI == 's' || cUCI == 'S');
-        p.necesitaVentilador = (cVent == 's' || cVent == 'S');
-        p.necesitaMedCritica = (cMed == 's' || cMed == 'S');
-        p.ordenLlegada = contadorLlegada++;
+    ofstream out;
+    if (!abrirSalidaGenerador(cfg, "pacientes.csv", out))
+        return 1;
+    AzarSintetico azarPacientes(cfg.semilla, 1);
+    out << "idPaciente,dni,nombreCompleto\n";
+    for (size_t i = 0; i < cfg.pacientes; ++i)
+        out << idPacienteSintetico(i) << ',' << dniPacienteSintetico(i) << ',' << nombreSintetico(azarPacientes) << '\n';
+    out.close();
+
+    // Las primeras especialidades tienen al menos un medico; el resto se reparte por peso
+    AzarSintetico azarMedicos(cfg.semilla, 2);
+    vector<string> nombresMedicos;
+    vector<int> especialidadMedico;
+    if (!abrirSalidaGenerador(cfg, "medicos.csv", out))
+        return 1;
+    out << "idMedico,nombreCompleto,especialidad,disponible\n";
+    for (size_t m = 0; m < cfg.medicos; ++m)
+    {
+        int esp = m < static_cast<size_t>(NUM_ESPECIALIDADES_SINTETICAS)
+                      ? static_cast<int>(m)
+                      : azarMedicos.ponderado(PESOS_ESPECIALIDAD, NUM_ESPECIALIDADES_SINTETICAS);
+        string nombre = string(APELLIDOS_SINTETICOS[azarMedicos.uniforme(NUM_APELLIDOS_SINTETICOS)]) + " " +
+                        APELLIDOS_SINTETICOS[azarMedicos.uniforme(NUM_APELLIDOS_SINTETICOS)] + " " + to_string(500 + m);
+        out << (500 + m) << ',' << nombre << ',' << ESPECIALIDADES_SINTETICAS[esp] << ','
+            << (azarMedicos.probabilidad(0.95) ? 1 : 0) << '\n';
+        nombresMedicos.push_back(nombre);
+        especialidadMedico.push_back(esp);
+    }
+    out.close();
 
-        colaEspera.insertar(p);
+    if (!abrirSalidaGenerador(cfg, "citas.csv", out) || !generarCitasSinteticas(cfg, nombresMedicos, especialidadMedico, out))
+        return 1;
+    out.close();
 
-        cout << "[INFO] Paciente critico " << p.nombre
-            << " agregado a la cola de asignacion de recursos.\n";
+    if (!abrirSalidaGenerador(cfg, "espera.txt", out))
+        return 1;
+    AzarSintetico azarEspera(cfg.semilla, 4);
+    for (size_t i = 0; i < cfg.espera && cfg.pacientes > 0; ++i)
+        out << "espera " << dniPacienteSintetico(azarEspera.sesgado(cfg.pacientes, 2)) << ' '
+            << 1 + azarEspera.ponderado(PESOS_PRIORIDAD_ESPERA, 5) << ' '
+            << ESPECIALIDADES_SINTETICAS[azarEspera.ponderado(PESOS_ESPECIALIDAD, NUM_ESPECIALIDADES_SINTETICAS)] << '\n';
+    out.close();
+
+    vector<AristaAmbulancia> vias;
+    generarGrafoSintetico(cfg, vias);
+    if (!abrirSalidaGenerador(cfg, "grafo.csv", out))
+        return 1;
+    AzarSintetico azarFlota(cfg.semilla, 8);
+    out << "nodos," << cfg.nodos << '\n';
+    for (const AristaAmbulancia& e : vias)
+        out << "via," << e.u << ',' << e.v << ',' << e.peso << '\n';
+    for (size_t a = 0; a < cfg.ambulancias; ++a)
+        out << "ambulancia," << (a + 1) << ',' << (a == 0 ? 0 : azarFlota.uniforme(cfg.nodos)) << '\n';
+    out.close();
+
+    if (!abrirSalidaGenerador(cfg, "emergencias.txt", out))
+        return 1;
+    generarEmergenciasSinteticas(cfg, vias, out);
+    out.close();
+
+    if (!abrirSalidaGenerador(cfg, "criticos.txt", out))
+        return 1;
+    generarCriticosSinteticos(cfg, out);
+    out.close();
+
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - inicio).count();
+    const string& d = cfg.directorio;
+    cout << "[GENERADOR] " << cfg.pacientes << " pacientes, " << cfg.medicos << " medicos, " << cfg.citas << " citas, "
+         << cfg.espera << " en espera, " << cfg.nodos << " nodos / " << vias.size() << " vias, " << cfg.ambulancias
+         << " ambulancias, " << cfg.emergencias << " emergencias y " << cfg.criticos << " criticos en " << fixed
+         << setprecision(1) << ms << " ms (semilla " << cfg.semilla << ")." << endl;
+    cout.unsetf(ios::floatfield);
+    cout << "  ./main --importar --pacientes " << d << "/pacientes.csv --medicos " << d << "/medicos.csv --citas " << d
+         << "/citas.csv --grafo " << d << "/grafo.csv --snapshot " << d << "/estado.snap\n";
+    cout << "  ./main --replay " << d << "/emergencias.txt --snapshot " << d << "/estado.snap   (igual con espera.txt y criticos.txt)"
+         << endl;
+    return 0;
+}
+
+/**
+ * Motores de rutas sobre un mapa sintetico (main --comparar-rutas [nodos] [consultas]):
+ * Dijkstra, Bellman-Ford SPFA y el Bellman-Ford clasico por pasadas sobre la
+ * lista de aristas. Verifica que las distancias coincidan y que Dijkstra y SPFA
+ * dejen el mismo arbol de predecesores (misma salida de reconstruirRuta); mide
+ * ademas la jerarquia de contraccion (distancias iguales a Dijkstra antes y
+ * despues de cambios de trafico), el despacho y la tabla de tiempos, cuya
+ * reparacion tras cada cambio de trafico debe dar las mismas distancias que
+ * reconstruirla.
+ */
+int compararMotoresRutas(size_t nodos, size_t consultas)
+{
+    ConfigGenerador cfg;
+    cfg.nodos = max<size_t>(nodos, 2);
+    vector<AristaAmbulancia> vias;
+    generarGrafoSintetico(cfg, vias);
+    numNodosAmbulancia = static_cast<int>(cfg.nodos);
+    vector<AristaAmbulancia> arcos;
+    for (const AristaAmbulancia& e : vias)
+    {
+        arcos.push_back(e);
+        arcos.push_back({ e.v, e.u, e.peso });
     }
+    grafoVial.construir(numNodosAmbulancia, arcos);
+    size_t arcosMapa = grafoVial.numArcos(); // la seccion de la tabla reemplaza el mapa por uno mas chico
 
-    // Asignación Greedy: siempre al paciente más urgente mientras haya recursos
-    void asignarRecursosGreedy()
+    // Referencia: V-1 pasadas sobre la lista plana de aristas (con salida temprana)
+    auto bellmanFordClasico = [&arcos](int origen, vector<int>& dist)
     {
-        if (colaEspera.estaVacio())
+        dist.assign(numNodosAmbulancia, INF_TIEMPO);
+        dist[origen] = 0;
+        for (int i = 0; i < numNodosAmbulancia - 1; ++i)
         {
-            cout << "\n[RECURSOS] No hay pacientes criticos en espera.\n";
-            return;
+            bool cambio = false;
+            for (const auto& e : arcos)
+                if (dist[e.u] != INF_TIEMPO && dist[e.u] + e.peso < dist[e.v])
+                {
+                    dist[e.v] = dist[e.u] + e.peso;
+                    cambio = true;
+                }
+            if (!cambio)
+                break;
         }
+    };
 
-        cout << "\n[RECURSOS] Ejecutando asignacion de recursos (Greedy + Skew Heap)...\n";
-
-        while (!colaEspera.estaVacio())
+    AzarSintetico azar(cfg.semilla, 9);
+    const size_t CONSULTAS_CLASICO = min<size_t>(consultas, 3);
+    double msDijkstra = 0, msSpfa = 0, msClasico = 0;
+    size_t diferencias = 0;
+    vector<int> distD, padreD, distS, padreS, distC;
+    for (size_t q = 0; q < consultas; ++q)
+    {
+        int origen = static_cast<int>(azar.uniforme(cfg.nodos));
+        auto t0 = chrono::steady_clock::now();
+        dijkstra(origen, distD, padreD);
+        auto t1 = chrono::steady_clock::now();
+        bellmanFord(origen, distS, padreS);
+        auto t2 = chrono::steady_clock::now();
+        msDijkstra += chrono::duration<double, milli>(t1 - t0).count();
+        msSpfa += chrono::duration<double, milli>(t2 - t1).count();
+        diferencias += distD != distS || padreD != padreS;
+        if (q < CONSULTAS_CLASICO)
         {
-            PacienteCritico top = colaEspera.obtenerMaxPrioridad();
-
-            bool puedeUCI = (!top.necesitaUCI) || (camasOcupadas < totalCamasUCI);
-            bool puedeVent = (!top.necesitaVentilador) || (ventiladoresOcupados < totalVentiladores);
-
-            if (!puedeUCI || !puedeVent)
-            {
-                cout << "[INFO] Recursos insuficientes para asignar al siguiente paciente de mayor prioridad.\n";
-                break;
-            }
-
-            cout << "[ASIGNACION] Paciente " << top.nombre << " (DNI: " << top.dni << ")\n";
-            cout << "    - Urgencia ESI: " << static_cast<int>(top.urgencia) << "\n";
+            t0 = chrono::steady_clock::now();
+            bellmanFordClasico(origen, distC);
+            msClasico += chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+            diferencias += distC != distD;
+        }
+    }
 
-            if (top.necesitaUCI)
-            {
-                camasOcupadas++;
-                cout << "    - Cama UCI asignada. (" << camasOcupadas
-                    << "/" << totalCamasUCI << " ocupadas)\n";
-            }
+    // Cambios de trafico sobre vias existentes: dos pesos del CSR por cambio
+    const size_t CAMBIOS = 100000;
+    auto t0 = chrono::steady_clock::now();
+    size_t cambiados = 0;
+    for (size_t k = 0; k < CAMBIOS; ++k)
+    {
+        const AristaAmbulancia& e = vias[azar.uniforme(vias.size())];
+        cambiados += grafoVial.cambiarPeso(e.u, e.v, 1 + static_cast<int>(azar.uniforme(20)));
+    }
+    double nsCambio = chrono::duration<double, nano>(chrono::steady_clock::now() - t0).count() / CAMBIOS;
+    diferencias += cambiados != CAMBIOS;
 
-            if (top.necesitaVentilador)
-            {
-                ventiladoresOcupados++;
-                cout << "    - Ventilador asignado. (" << ventiladoresOcupados
-                    << "/" << totalVentiladores << " ocupados)\n";
-            }
+    // Una ruta es valida si va de o a d por vias existentes y suma el tiempo informado
+    auto rutaValida = [](const vector<int>& ruta, int o, int d, int tiempo)
+    {
+        int suma = 0;
+        for (size_t i = 0; i + 1 < ruta.size(); ++i)
+        {
+            int a = grafoVial.arco(ruta[i], ruta[i + 1]);
+            suma += a < 0 ? INF_TIEMPO : grafoVial.pesoDe(a);
+        }
+        return !ruta.empty() && ruta.front() == o && ruta.back() == d && suma == tiempo;
+    };
 
-            if (top.necesitaMedCritica)
+    // Jerarquia de contraccion: preparar y guardar, cargar (personaliza), consultas contra Dijkstra y trafico
+    string rutaJerarquia = (filesystem::temp_directory_path() / "comparar-rutas.jer").string();
+    t0 = chrono::steady_clock::now();
+    bool jerarquiaLista = jerarquiaRutas.preparar() && jerarquiaRutas.guardar(rutaJerarquia);
+    double msPrepararJerarquia = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+    t0 = chrono::steady_clock::now();
+    jerarquiaLista = jerarquiaLista && jerarquiaRutas.cargar(rutaJerarquia);
+    double msCargarJerarquia = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+    error_code ec;
+    filesystem::remove(rutaJerarquia, ec);
+    diferencias += !jerarquiaLista;
+    auto verificarJerarquia = [&]()
+    {
+        vector<int> ruta;
+        for (size_t q = 0; q < consultas && jerarquiaLista; ++q)
+        {
+            int origen = static_cast<int>(azar.uniforme(cfg.nodos)), destino = static_cast<int>(azar.uniforme(cfg.nodos));
+            dijkstra(origen, distD, padreD);
+            int tiempo = jerarquiaRutas.consultar(origen, destino, ruta);
+            diferencias += tiempo != distD[destino] || !rutaValida(ruta, origen, destino, tiempo);
+        }
+    };
+    const size_t CONSULTAS_JERARQUIA = 1000, CAMBIOS_JERARQUIA = 200;
+    double usConsultaJerarquia = 0, usCambioJerarquia = 0;
+    verificarJerarquia();
+    for (size_t q = 0; q < CONSULTAS_JERARQUIA && jerarquiaLista; ++q)
+    {
+        vector<int> ruta;
+        int origen = static_cast<int>(azar.uniforme(cfg.nodos)), destino = static_cast<int>(azar.uniforme(cfg.nodos));
+        t0 = chrono::steady_clock::now();
+        jerarquiaRutas.consultar(origen, destino, ruta);
+        usConsultaJerarquia += chrono::duration<double, micro>(chrono::steady_clock::now() - t0).count();
+    }
+    for (size_t k = 0; k < CAMBIOS_JERARQUIA && jerarquiaLista; ++k)
+    {
+        const AristaAmbulancia& e = vias[azar.uniforme(vias.size())];
+        grafoVial.cambiarPeso(e.u, e.v, 1 + static_cast<int>(azar.uniforme(20)));
+        t0 = chrono::steady_clock::now();
+        jerarquiaRutas.actualizarPeso(e.u, e.v);
+        usCambioJerarquia += chrono::duration<double, micro>(chrono::steady_clock::now() - t0).count();
+    }
+    verificarJerarquia();
+    diferencias += jerarquiaLista && !jerarquiaRutas.vigente();
+    size_t atajosJerarquia = jerarquiaRutas.numAtajos();
+    jerarquiaRutas = JerarquiaContraccion();
+
+    // Despacho: una sola busqueda contra una busqueda por ambulancia, con flotas crecientes
+    const size_t DESPACHOS = 50;
+    const size_t flotas[] = { 10, 100, 1000 };
+    vector<double> usUnaBusqueda, usPorAmbulancia;
+    for (size_t tamFlota : flotas)
+    {
+        ambulancias.clear();
+        for (size_t a = 0; a < tamFlota; ++a)
+            ambulancias.push_back({ static_cast<int>(a + 1), static_cast<int>(azar.uniforme(cfg.nodos)), true });
+        double usUna = 0, usUno = 0;
+        size_t despachosUno = 0;
+        for (size_t k = 0; k < DESPACHOS; ++k)
+        {
+            int destino = static_cast<int>(azar.uniforme(cfg.nodos));
+            int tiempo;
+            vector<int> ruta;
+            t0 = chrono::steady_clock::now();
+            int elegida = despachoAmbulancias.masCercana(destino, tiempo, ruta);
+            usUna += chrono::duration<double, micro>(chrono::steady_clock::now() - t0).count();
+            if (tamFlota * cfg.nodos > 2000000 && k >= 2)
+                continue; // la busqueda por ambulancia se muestrea poco en flotas grandes
+            t0 = chrono::steady_clock::now();
+            int mejor = INF_TIEMPO, mejorIdx = -1;
+            vector<int> rutaMejor;
+            for (size_t i = 0; i < ambulancias.size(); ++i)
             {
-                string med = "MedicamentoCriticoA";
-                bool ok = inventario.consumir(med, 1);
-                if (!ok)
+                dijkstra(ambulancias[i].nodoActual, distD, padreD);
+                if (distD[destino] < mejor)
                 {
-                    cout << "    [ALERTA] No se pudo dispensar medicacion critica para este paciente.\n";
+                    mejor = distD[destino];
+                    mejorIdx = static_cast<int>(i);
+                    rutaMejor = reconstruirRuta(ambulancias[i].nodoActual, destino, padreD);
                 }
             }
-
-            cout << "---------------------------------------------\n";
-
-            colaEspera.eliminarMaxPrioridad();
+            usUno += chrono::duration<double, micro>(chrono::steady_clock::now() - t0).count();
+            despachosUno++;
+            // Misma ambulancia (la primera de la flota entre empatadas) y la misma ruta que calcularRutas
+            diferencias += mejor != tiempo || mejorIdx != elegida || rutaMejor != ruta;
         }
+        usUnaBusqueda.push_back(usUna / DESPACHOS);
+        usPorAmbulancia.push_back(usUno / despachosUno);
     }
 
-
-    // Liberar recursos cuando pacientes salen de UCI/ventilador
-    void darAltaPacientesInteractivo()
-    {
-        int liberarCamas, liberarVent;
-        cout << "\n[ALTA PACIENTES] ¿Cuantas camas UCI se liberan?: ";
-        cin >> liberarCamas;
-        cout << "[ALTA PACIENTES] ¿Cuantos ventiladores se liberan?: ";
-        cin >> liberarVent;
-
-        camasOcupadas -= liberarCamas;
-        ventiladoresOcupados -= liberarVent;
-
-        if (camasOcupadas < 0)
-            camasOcupadas = 0;
-        if (ventiladoresOcupados < 0)
-            ventiladoresOcupados = 0;
-
-        cout << "[INFO] Recursos actualizados tras las altas.\n";
-    }
-
-    void reporteRecursos() const
+    // Tabla de todos los pares sobre un mapa mas chico: reparar tras cambios de trafico contra reconstruirla
+    ConfigGenerador cfgTabla = cfg;
+    cfgTabla.nodos = min<size_t>(cfg.nodos, 2000);
+    vias.clear();
+    generarGrafoSintetico(cfgTabla, vias);
+    numNodosAmbulancia = static_cast<int>(cfgTabla.nodos);
+    arcos.clear();
+    for (const AristaAmbulancia& e : vias)
     {
-        cout << "\n========== ESTADO DE RECURSOS HOSPITALARIOS ==========\n";
-        cout << "Camas UCI: " << camasOcupadas << " / " << totalCamasUCI << "\n";
-        cout << "Ventiladores: " << ventiladoresOcupados << " / " << totalVentiladores << "\n";
-        cout << "======================================================\n";
-        inventario.reporte();
+        arcos.push_back(e);
+        arcos.push_back({ e.v, e.u, e.peso });
     }
-
-    void reabastecerMedicamentoInteractivo()
+    grafoVial.construir(numNodosAmbulancia, arcos);
+    t0 = chrono::steady_clock::now();
+    tablaTiempos.construir();
+    double msTabla = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+
+    const size_t LECTURAS = 1000000;
+    long long sumaTiempos = 0;
+    t0 = chrono::steady_clock::now();
+    for (size_t k = 0; k < LECTURAS; ++k)
+        sumaTiempos += tablaTiempos.tiempo(static_cast<int>(azar.uniforme(cfgTabla.nodos)),
+                                           static_cast<int>(azar.uniforme(cfgTabla.nodos)));
+    double nsLectura = chrono::duration<double, nano>(chrono::steady_clock::now() - t0).count() / LECTURAS;
+    diferencias += sumaTiempos <= 0;
+
+    const size_t CAMBIOS_TABLA = 8;
+    double msReparar = 0, msReconstruir = 0;
+    size_t filasReparadas = 0, paresReparados = 0;
+    TablaTiemposRutas referencia;
+    for (size_t k = 0; k < CAMBIOS_TABLA; ++k)
     {
-        string nombre;
-        int cantidad;
-        cout << "\n[REABASTECER] Nombre del medicamento critico: ";
-        cin >> nombre;
-        cout << "  > Cantidad a agregar: ";
-        cin >> cantidad;
-        inventario.reabastecer(nombre, cantidad);
+        const AristaAmbulancia& e = vias[azar.uniforme(vias.size())];
+        int peso = grafoVial.pesoDe(grafoVial.arco(e.u, e.v));
+        int nuevo = k % 2 == 0 ? max(1, peso / 3) : peso * 4; // alterna atajos y embotellamientos
+        t0 = chrono::steady_clock::now();
+        tablaTiempos.cambiarPeso(e.u, e.v, nuevo);
+        msReparar += chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+        filasReparadas += tablaTiempos.ultimasFilasReparadas();
+        paresReparados += tablaTiempos.ultimosParesReparados();
+
+        t0 = chrono::steady_clock::now();
+        referencia.construir();
+        msReconstruir += chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+        for (int o = 0; o < numNodosAmbulancia; ++o)
+            for (int d = 0; d < numNodosAmbulancia; ++d)
+                diferencias += tablaTiempos.tiempo(o, d) != referencia.tiempo(o, d);
+        for (size_t q = 0; q < 1000; ++q)
+        {
+            // La ruta puede ser otra de igual tiempo: se verifica que recorra vias reales y sume el tiempo de la tabla
+            int o = static_cast<int>(azar.uniforme(cfgTabla.nodos)), d = static_cast<int>(azar.uniforme(cfgTabla.nodos));
+            diferencias += !rutaValida(tablaTiempos.ruta(o, d), o, d, tablaTiempos.tiempo(o, d));
+        }
     }
-};
-
-// Gestor global de recursos (ejemplo: 10 camas UCI y 6 ventiladores)
-GestorRecursosHospitalarios gestorRecursos(10, 6);
+    diferencias += !tablaTiempos.vigente();
+    tablaTiempos.descartar();
+
+    cout << "\n================= MOTORES DE RUTAS =================\n";
+    cout << "Nodos: " << cfg.nodos << " | aristas dirigidas: " << arcosMapa << " | consultas: " << consultas
+         << "\n" << fixed << setprecision(3);
+    cout << "Dijkstra (heap binario):      " << msDijkstra / consultas << " ms/consulta\n";
+    cout << "Bellman-Ford SPFA:            " << msSpfa / consultas << " ms/consulta\n";
+    if (CONSULTAS_CLASICO > 0)
+        cout << "Bellman-Ford clasico:         " << msClasico / CONSULTAS_CLASICO << " ms/consulta (" << CONSULTAS_CLASICO
+             << " consultas)\n";
+    cout << "Cambio de peso de una via: " << nsCambio << " ns\n";
+    cout << "Jerarquia (" << atajosJerarquia << " aristas): preparar y guardar " << msPrepararJerarquia
+         << " ms, cargar y personalizar " << msCargarJerarquia << " ms\n";
+    cout << "Jerarquia: consulta " << usConsultaJerarquia / CONSULTAS_JERARQUIA << " us, cambio de trafico "
+         << usCambioJerarquia / CAMBIOS_JERARQUIA << " us\n";
+    for (size_t i = 0; i < usUnaBusqueda.size(); ++i)
+        cout << "Despacho con " << setw(4) << flotas[i] << " ambulancias: " << usUnaBusqueda[i]
+             << " us una busqueda, " << usPorAmbulancia[i] << " us una por ambulancia\n";
+    cout << "Tabla de tiempos (" << cfgTabla.nodos << " nodos, " << max(1u, thread::hardware_concurrency())
+         << " hilos): construir " << msTabla << " ms, lectura " << nsLectura << " ns\n";
+    cout << "Cambio de trafico con tabla: reparar " << msReparar / CAMBIOS_TABLA << " ms ("
+         << filasReparadas / CAMBIOS_TABLA << " filas recalculadas, " << paresReparados / CAMBIOS_TABLA
+         << " pares corregidos), reconstruir " << msReconstruir / CAMBIOS_TABLA << " ms\n";
+    cout << "Resultados distintos: " << diferencias << "\n";
+    cout << "====================================================\n";
+    cout.unsetf(ios::floatfield);
+    return diferencias == 0 ? 0 : 1;
+}
 
 // --- 5. FUNCIÓN MAIN INTERACTIVA ---
 
@@ -1179,33 +11052,313 @@ void mostrarMenu()
     cout << "8. Dar de Alta Pacientes (Liberar Recursos)" << endl;
     cout << "9. Ver Reporte de Recursos e Inventario" << endl;
     cout << "10. Reabastecer Medicamento Critico" << endl;
+    cout << "11. Agregar Paciente a Lista de Espera" << endl;
+    cout << "12. Retirar Paciente de Lista de Espera" << endl;
+    cout << "13. Consultar Citas por Medico, Fecha o Paciente (Indices)" << endl;
+    cout << "14. Buscar Horario Libre (Medico o Especialidad)" << endl;
+    cout << "15. Agendar Nueva Cita" << endl;
+    cout << "16. Guardar Snapshot Binario del Estado" << endl;
+    cout << "17. Buscar Paciente por Nombre (Autocompletado)" << endl;
+    cout << "18. Registrar Paciente Nuevo" << endl;
+    cout << "19. Medicos Disponibles por Especialidad (Bitset)" << endl;
+    cout << "20. Agenda por Rango de Fecha y Hora (Paginada)" << endl;
+    cout << "21. Llenar Horarios Liberados desde Lista de Espera (Lote)" << endl;
     cout << "0. Salir" << endl;
     cout << "Ingrese su opcion: ";
 }
 
-int main()
+int main(int argc, char* argv[])
 {
-    cargarDatos(); // (Inicio -> Cargar datos)
+    // Modo no interactivo: main --replay <archivo|-> [--multiples-areas] [--verbose] [opciones de persistencia]
+    if (argc >= 3 && string(argv[1]) == "--replay")
+    {
+        bool multiplesAreas = false, verbose = false;
+        OpcionesPersistencia persistencia;
+        for (int i = 3; i < argc; ++i)
+        {
+            string opt = argv[i];
+            if (opt == "--multiples-areas")
+                multiplesAreas = true;
+            else if (opt == "--verbose")
+                verbose = true;
+            else
+                leerOpcionPersistencia(argc, argv, i, persistencia);
+        }
+        if (persistencia.invalida)
+            return 1;
+        string ruta = argv[2];
+        if (ruta == "-")
+            return ejecutarReplay(cin, multiplesAreas, verbose, persistencia);
+        ifstream archivo(ruta);
+        if (!archivo)
+        {
+            cerr << "[ERROR] No se pudo abrir el archivo de comandos: " << ruta << endl;
+            return 1;
+        }
+        return ejecutarReplay(archivo, multiplesAreas, verbose, persistencia);
+    }
+
+    // Servidor: main --servidor (--socket <ruta> | --puerto N [--host IP]) [opciones de persistencia]
+    if (argc >= 2 && string(argv[1]) == "--servidor")
+    {
+        DestinoServidor destino;
+        OpcionesPersistencia persistencia;
+        for (int i = 2; i < argc; ++i)
+        {
+            if (!leerOpcionDestino(argc, argv, i, destino) && !leerOpcionPersistencia(argc, argv, i, persistencia))
+                cout << "[INFO] Opcion ignorada: " << argv[i] << endl;
+        }
+        if (destino.puerto < 0 || persistencia.invalida)
+            return 1;
+        if (destino.rutaSocket.empty() && destino.puerto == 0)
+        {
+            cerr << "[ERROR] Indique --socket <ruta> o --puerto N." << endl;
+            return 1;
+        }
+        return ejecutarServidor(destino, persistencia);
+    }
+
+    // Generador de carga: main --cliente-carga (--socket <ruta> | --puerto N [--host IP])
+    //                          [--conexiones N] [--operaciones N] [--escrituras porcentaje]
+    if (argc >= 2 && string(argv[1]) == "--cliente-carga")
+    {
+        DestinoServidor destino;
+        ConfigCargaCliente cfg;
+        for (int i = 2; i < argc; ++i)
+        {
+            string opt = argv[i];
+            if (leerOpcionDestino(argc, argv, i, destino))
+                continue;
+            bool valido = true;
+            if (opt == "--conexiones")
+                valido = leerValorOpcion(argc, argv, i, cfg.conexiones);
+            else if (opt == "--operaciones")
+                valido = leerValorOpcion(argc, argv, i, cfg.operaciones);
+            else if (opt == "--escrituras")
+                valido = leerValorOpcion(argc, argv, i, cfg.porcentajeEscrituras);
+            else
+                cout << "[INFO] Opcion ignorada: " << argv[i] << endl;
+            if (!valido)
+                return 1;
+        }
+        cfg.conexiones = max(1, cfg.conexiones);
+        if (destino.puerto < 0)
+            return 1;
+        if (destino.rutaSocket.empty() && destino.puerto == 0)
+        {
+            cerr << "[ERROR] Indique --socket <ruta> o --puerto N." << endl;
+            return 1;
+        }
+        return ejecutarClienteCarga(destino, cfg);
+    }
+
+    // Datos sinteticos: main --generar <directorio> [--semilla S] [--pacientes N] [--medicos N] [--citas N]
+    //                   [--espera N] [--nodos N] [--ambulancias N] [--emergencias N] [--criticos N]
+    //                   [--desde YYYY-MM-DD] [--dias N] [--mezcla-esi p1,p2,p3,p4,p5]
+    if (argc >= 3 && string(argv[1]) == "--generar")
+    {
+        ConfigGenerador cfg;
+        cfg.directorio = argv[2];
+        map<string, size_t*> volumenes = { { "--pacientes", &cfg.pacientes }, { "--medicos", &cfg.medicos },
+                                           { "--citas", &cfg.citas },         { "--espera", &cfg.espera },
+                                           { "--nodos", &cfg.nodos },         { "--ambulancias", &cfg.ambulancias },
+                                           { "--emergencias", &cfg.emergencias }, { "--criticos", &cfg.criticos } };
+        for (int i = 3; i < argc; ++i)
+        {
+            string opt = argv[i];
+            auto it = volumenes.find(opt);
+            if (it != volumenes.end() || opt == "--semilla" || opt == "--dias")
+            {
+                bool valido = it != volumenes.end() ? leerValorOpcion(argc, argv, i, *it->second)
+                              : opt == "--semilla"   ? leerValorOpcion(argc, argv, i, cfg.semilla)
+                                                     : leerValorOpcion(argc, argv, i, cfg.dias);
+                if (!valido)
+                    return 1;
+            }
+            else if (i + 1 < argc && opt == "--desde")
+                cfg.fechaInicio = argv[++i];
+            else if (i + 1 < argc && opt == "--mezcla-esi")
+            {
+                string_view campos[5];
+                string valor = argv[++i];
+                if (separarCamposCSV(valor, campos, 5) != 5)
+                    cerr << "[INFO] --mezcla-esi espera 5 pesos separados por comas; se usa la mezcla por defecto." << endl;
+                else
+                    for (int k = 0; k < 5; ++k)
+                        leerEnteroCSV(campos[k], cfg.mezclaESI[k]);
+            }
+            else
+                cerr << "[INFO] Opcion ignorada: " << argv[i] << endl;
+        }
+        return generarCargaSintetica(cfg);
+    }
 
-    // Carga el grafo base de rutas para ambulancias
-    cargarGrafoAmbulancia();
+    // Carga masiva: main --importar [--pacientes p.csv] [--medicos m.csv] [--citas c.csv] [--hilos N]
+    //                               [--grafo mapa.csv] [--snapshot salida.snap]
+    if (argc >= 2 && string(argv[1]) == "--importar")
+    {
+        OpcionesPersistencia opciones;
+        for (int i = 2; i < argc; ++i)
+        {
+            if (!leerOpcionPersistencia(argc, argv, i, opciones))
+                cout << "[INFO] Opcion ignorada: " << argv[i] << endl;
+        }
+        if (opciones.invalida)
+            return 1;
+        const ConfigImportacion& imp = opciones.importacion;
+        if (imp.vacia() && imp.rutaGrafo.empty())
+        {
+            cerr << "[ERROR] Indique al menos uno de --pacientes, --medicos, --citas o --grafo." << endl;
+            return 1;
+        }
+        if (!imp.vacia() && !importarDatosCSV(imp))
+            return 1;
+        if (!imp.rutaGrafo.empty() && !cargarGrafoDesdeArchivo(imp.rutaGrafo))
+            return 1;
+        if (!opciones.rutaSnapshot.empty())
+        {
+            if (imp.rutaGrafo.empty())
+                cargarGrafoAmbulancia();
+            configurarInventarioInicial();
+            return guardarSnapshot(opciones.rutaSnapshot) ? 0 : 1;
+        }
+        return 0;
+    }
+
+    // Preproceso de rutas: main --preparar-jerarquia <mapa.csv> <salida>. Contrae el mapa y guarda la
+    // jerarquia; despues 'jerarquia <salida>' en replay (u opcion 8 de ambulancias) solo la carga
+    if (argc >= 4 && string(argv[1]) == "--preparar-jerarquia")
+    {
+        if (!cargarGrafoDesdeArchivo(argv[2]))
+            return 1;
+        auto inicio = chrono::steady_clock::now();
+        if (!jerarquiaRutas.preparar() || !jerarquiaRutas.guardar(argv[3]))
+            return 1;
+        cout << "[INFO] Jerarquia guardada en " << argv[3] << ": " << jerarquiaRutas.numAtajos() << " aristas, "
+             << chrono::duration<double, milli>(chrono::steady_clock::now() - inicio).count() << " ms." << endl;
+        return 0;
+    }
+
+    // Indice de pacientes: main --comparar-pacientes [n ...] (por defecto 1.000.000)
+    if (argc >= 2 && string(argv[1]) == "--comparar-pacientes")
+    {
+        vector<size_t> tamanos;
+        for (int i = 2; i < argc; ++i)
+        {
+            size_t n;
+            if (!leerNumeroArgumento(argv[i], n))
+            {
+                cerr << "[ERROR] Uso: main --comparar-pacientes [n ...]" << endl;
+                return 1;
+            }
+            tamanos.push_back(n);
+        }
+        if (tamanos.empty())
+            tamanos.push_back(1000000);
+        return compararIndicePacientes(tamanos);
+    }
+
+    // Autocompletado: main --comparar-nombres [n] (por defecto 1.000.000)
+    if (argc >= 2 && string(argv[1]) == "--comparar-nombres")
+    {
+        size_t n = 1000000;
+        if (argc >= 3 && !leerNumeroArgumento(argv[2], n))
+        {
+            cerr << "[ERROR] Uso: main --comparar-nombres [n]" << endl;
+            return 1;
+        }
+        return compararIndiceNombres(n);
+    }
+
+    // Ordenamientos: main --comparar-ordenamiento [n ...] [--repeticiones R] [--formato csv|jsonl] [--salida ruta]
+    //                (por defecto 1.000, 10.000, 100.000 y 1.000.000 con 3 repeticiones)
+    if (argc >= 2 && string(argv[1]) == "--comparar-ordenamiento")
+    {
+        vector<size_t> tamanos;
+        int repeticiones = 3;
+        bool json = false;
+        string rutaSalida;
+        for (int i = 2; i < argc; ++i)
+        {
+            string opt = argv[i];
+            size_t n;
+            if (opt == "--repeticiones")
+            {
+                if (!leerValorOpcion(argc, argv, i, repeticiones))
+                    return 1;
+                repeticiones = max(1, repeticiones);
+            }
+            else if (i + 1 < argc && opt == "--formato")
+                json = string(argv[++i]) == "jsonl";
+            else if (i + 1 < argc && opt == "--salida")
+                rutaSalida = argv[++i];
+            else if (leerNumeroArgumento(argv[i], n))
+                tamanos.push_back(n);
+            else
+                cerr << "[INFO] Opcion ignorada: " << argv[i] << endl;
+        }
+        if (tamanos.empty())
+            tamanos = { 1000, 10000, 100000, 1000000 };
+        return compararOrdenamientos(tamanos, repeticiones, json, rutaSalida);
+    }
+
+    // Motores de rutas: main --comparar-rutas [nodos] [consultas] (por defecto 100.000 y 20)
+    if (argc >= 2 && string(argv[1]) == "--comparar-rutas")
+    {
+        size_t nodos = 100000, consultas = 20;
+        if ((argc >= 3 && !leerNumeroArgumento(argv[2], nodos)) || (argc >= 4 && !leerNumeroArgumento(argv[3], consultas)))
+        {
+            cerr << "[ERROR] Uso: main --comparar-rutas [nodos] [consultas]" << endl;
+            return 1;
+        }
+        return compararMotoresRutas(nodos, consultas);
+    }
+
+    // Comparacion de memoria: main --comparar-memoria [filas] (por defecto 1.000.000)
+    if (argc >= 2 && string(argv[1]) == "--comparar-memoria")
+    {
+        size_t filas = 1000000;
+        if (argc >= 3 && !leerNumeroArgumento(argv[2], filas))
+        {
+            cerr << "[ERROR] Uso: main --comparar-memoria [filas]" << endl;
+            return 1;
+        }
+        return compararMemoriaAgendas(filas);
+    }
+
+    // Consolidacion nocturna: main --consolidar <salida.csv> <area1.csv> [area2.csv ...]
+    if (argc >= 4 && string(argv[1]) == "--consolidar")
+        return consolidarArchivosAgendas(argv[2], vector<string>(argv + 3, argv + argc));
+
+    // main [--snapshot <ruta>] [--journal <ruta>] ...: arranca desde el snapshot (si existe),
+    // reaplica el journal y guarda el snapshot al salir
+    OpcionesPersistencia persistencia;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (!leerOpcionPersistencia(argc, argv, i, persistencia))
+            cout << "[INFO] Opcion ignorada: " << argv[i] << endl;
+    }
+    if (persistencia.invalida)
+        return 1;
+    const string& rutaSnapshot = persistencia.rutaSnapshot;
+
+    // (Inicio -> Cargar datos) y grafo base de rutas para ambulancias
+    iniciarPersistencia(persistencia);
 
     // Configuracion inicial de procesamiento de citas
     int tipo_procesamiento;
     cout << "\n[CONFIGURACION INICIAL]" << endl;
-    cout << "Las citas provienen de multiples areas? (1: Si [Merge Sort], 0: No [Quick Sort]): ";
+    cout << "Las citas provienen de multiples areas? (1: Si [Merge Sort], 0: No [Quick Sort], 2: Volumen masivo [Radix Sort]): ";
 
     if (!(cin >> tipo_procesamiento))
     {
         cout << "\n[ERROR] Entrada invalida. Terminando programa." << endl;
         return 1;
     }
-    iniciarProcesamiento(tipo_procesamiento == 1);
-
-    // Configuracion inicial de inventario de medicamentos criticos
-    InventarioMedicamentos& inv = gestorRecursos.obtenerInventario();
-    inv.agregarTipoMedicamento("MedicamentoCriticoA", 5, 2);
-    inv.agregarTipoMedicamento("MedicamentoCriticoB", 10, 3);
+    if (tipo_procesamiento == 2)
+        iniciarProcesamientoRadix();
+    else
+        iniciarProcesamiento(tipo_procesamiento == 1);
 
     int opcion;
     do
@@ -1229,17 +11382,7 @@ int main()
             modificarDisponibilidadMedico();
             break;
         case 4:
-            cout << "\n--- LISTA DE CITAS PROGRAMADAS ---" << endl;
-            for (const auto& cita : citasProgramadas)
-            {
-                string estado = cita.cancelada ? "CANCELADA" : "ACTIVA";
-                cout << std::left << setw(5) << "ID:" << setw(5) << cita.idCita
-                    << setw(15) << "Medico:" << setw(20) << cita.nombreMedico
-                    << setw(12) << "Fecha:" << setw(12) << cita.fecha
-                    << setw(10) << "Hora:" << setw(6) << cita.hora
-                    << setw(15) << "Prioridad:" << setw(3) << cita.prioridad
-                    << setw(10) << "Estado:" << estado << endl;
-            }
+            mostrarCitasProgramadas();
             break;
         case 5:
             optimizarRutaAmbulancia();
@@ -1259,7 +11402,43 @@ int main()
         case 10:
             gestorRecursos.reabastecerMedicamentoInteractivo();
             break;
+        case 11:
+            agregarAListaEsperaInteractivo();
+            break;
+        case 12:
+            retirarDeListaEsperaInteractivo();
+            break;
+        case 13:
+            consultarCitasInteractivo();
+            break;
+        case 14:
+            buscarHuecoInteractivo();
+            break;
+        case 15:
+            agendarCitaInteractivo();
+            break;
+        case 16:
+            guardarSnapshotInteractivo(rutaSnapshot);
+            break;
+        case 17:
+            buscarPacientePorNombreInteractivo();
+            break;
+        case 18:
+            registrarPacienteInteractivo();
+            break;
+        case 19:
+            consultarMedicosDisponiblesInteractivo();
+            break;
+        case 20:
+            consultarAgendaPorRangoInteractivo();
+            break;
+        case 21:
+            llenarHuecosInteractivo();
+            break;
         case 0:
+            if (!rutaSnapshot.empty())
+                guardarSnapshot(rutaSnapshot);
+            journalMutaciones.cerrar();
             cout << "\nSaliendo del Modulo de Gestion de Citas y Recursos." << endl;
             break;
         default: